@@ -2,7 +2,15 @@
 
 #include <SFML/Graphics.hpp>
 
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "FrameTimings.hpp"
 #include "InfiniteGrid.hpp"
+#include "InputLog.hpp"
+#include "Tracer.hpp"
 #include "Wireworld.hpp"
 
 /**
@@ -15,8 +23,9 @@ public:
 	/**
 	 * @brief Init the app.
 	 * 
+	 * @param engine The name of the simulation engine to start with.
 	 */
-	Application();
+	Application(const std::string& engine = Wireworld::DEFAULT_ENGINE);
 
 	/**
 	 * @brief Main app loop, equivalent to main().
@@ -25,6 +34,61 @@ public:
 	 */
 	int run();
 
+	/**
+	 * @brief Record all input, with frame timestamps, while running.
+	 * 
+	 * @param path The input log to write.
+	 * @return true If the log could be created.
+	 */
+	bool recordInput(const std::string& path);
+
+	/**
+	 * @brief Feed a recorded input log back instead of reading the window,
+	 * and report how long every frame took once it's done.
+	 * 
+	 * @param path The input log to replay.
+	 * @param timings Where to save per-frame timings as CSV. Empty to only print a summary.
+	 * @return true If the log could be opened.
+	 */
+	bool replayInput(const std::string& path, const std::string& timings = "");
+
+	/**
+	 * @brief Load a pattern file in the background, see Wireworld::load().
+	 * 
+	 */
+	void load(const std::string& path);
+
+	/**
+	 * @brief Page cold parts of the world out to a file, see Simulation::setPaging().
+	 * 
+	 */
+	bool setPaging(const std::string& path, std::size_t maxResidentBytes);
+
+	/**
+	 * @brief Cache what engines compile from the layout in a directory, see Simulation::setCache().
+	 * 
+	 */
+	bool setCache(const std::string& directory, std::uintmax_t maxBytes);
+
+	/**
+	 * @brief Journal every edit to a directory, and recover the world from it, see Wireworld::setAutosave().
+	 * 
+	 */
+	bool setAutosave(const std::string& directory);
+
+	/**
+	 * @brief Cap how often the window is redrawn.
+	 * 
+	 * @param fps The max frames per second, 0 for no cap.
+	 */
+	void setFrameLimit(unsigned int fps);
+
+	/**
+	 * @brief The default max frames per second.
+	 * 
+	 */
+	static const unsigned int DEFAULT_FRAME_LIMIT = 60;
+
 private:
 	/**
 	 * @brief The app window.
@@ -37,4 +101,54 @@ private:
 	 * 
 	 */
 	Wireworld mSimulation;
-};
\ No newline at end of file
+
+	/**
+	 * @brief Input being recorded to, or replayed from.
+	 * 
+	 */
+	InputLog mInputLog;
+
+	/**
+	 * @brief Whether input is recorded, replayed, or neither.
+	 * 
+	 */
+	bool mRecording, mReplaying;
+
+	/**
+	 * @brief How long each replayed frame took.
+	 * 
+	 */
+	FrameTimings mTimings;
+
+	/**
+	 * @brief Where to save mTimings after a replay.
+	 * 
+	 */
+	std::string mTimingsPath;
+
+	/**
+	 * @brief The least time between two redraws, zero for no cap.
+	 * 
+	 */
+	sf::Time mFrameInterval;
+
+	/**
+	 * @brief The longest the app sleeps before checking for input again, while not idle.
+	 * 
+	 */
+	static const sf::Time MAX_SLEEP;
+
+	/**
+	 * @brief Block until there's input, a step due, or a frame to draw.
+	 * 
+	 * @param events Filled with the event that ended the wait, if any.
+	 * @param sinceDrawn The time since the last redraw.
+	 */
+	void waitForWork(std::vector<sf::Event>& events, sf::Time sinceDrawn);
+
+	/**
+	 * @brief Dispatch one window event to the simulation.
+	 * 
+	 */
+	void handleEvent(const sf::Event& event);
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief Simulates many instances of the same circuit at once, one instance per bit.
+ * 
+ * @remarks Every instance shares the wire layout, and only differs in where its heads & tails are.
+ * Each cell's heads & tails across all instances are stored as bit masks of WORDS 64-bit words,
+ * and neighbors are counted with bitwise adders, so one pass over the active cells steps every
+ * instance. Use BatchEngine64 or BatchEngine256.
+ * 
+ * @tparam WORDS The amount of 64-bit words per mask, 64 instances each.
+ */
+template <std::size_t WORDS>
+class BatchEngine
+{
+public:
+	/**
+	 * @brief The amount of instances simulated at once.
+	 * 
+	 */
+	static const std::size_t LANES = WORDS * 64;
+
+	/**
+	 * @brief One bit per instance.
+	 * 
+	 */
+	typedef std::array<std::uint64_t, WORDS> Mask;
+
+	/**
+	 * @brief Compile the circuit's layout.
+	 * 
+	 * @param cells The circuit. Every instance starts out with these cells' types.
+	 */
+	BatchEngine(const std::vector<Cell>& cells);
+
+	/**
+	 * @brief Set a cell's type in one instance, e.g. to feed it a different input.
+	 * 
+	 * @param instance The instance, from 0 to LANES - 1.
+	 * @param pos The cell. Must be part of the circuit's layout.
+	 * @param type WIRE, HEAD or TAIL.
+	 * @return false If there's no cell at pos in the layout.
+	 */
+	bool setCell(std::size_t instance, WorldPos pos, Cell::Type type);
+
+	/**
+	 * @brief Get a cell's type in one instance.
+	 * 
+	 * @return Cell::Type NONE if there's no cell at pos in the layout.
+	 */
+	Cell::Type getCell(std::size_t instance, WorldPos pos);
+
+	/**
+	 * @return std::vector<Cell> All of one instance's cells.
+	 */
+	std::vector<Cell> getCells(std::size_t instance);
+
+	/**
+	 * @brief Record a cell's type in every instance after every step.
+	 * 
+	 * @param pos The cell. Must be part of the circuit's layout.
+	 * @return int The probe's index, -1 if there's no cell at pos.
+	 */
+	int addProbe(WorldPos pos);
+
+	/**
+	 * @brief Get a probe's recorded types in one instance.
+	 * 
+	 * @param probe The probe's index, see addProbe().
+	 * @param instance The instance.
+	 * @return std::vector<Cell::Type> The type after every step since the probe was added.
+	 */
+	std::vector<Cell::Type> getTrace(std::size_t probe, std::size_t instance);
+
+	/**
+	 * @brief Advance every instance one generation.
+	 * 
+	 */
+	void step();
+
+	/**
+	 * @return unsigned long long The amount of generations stepped so far.
+	 */
+	unsigned long long getGeneration();
+
+private:
+	/**
+	 * @brief Maps positions to cell indices.
+	 * 
+	 */
+	std::unordered_map<WorldPos, std::uint32_t, Cell::PositionHash> mIndex;
+
+	/**
+	 * @brief The position of each cell, by index.
+	 * 
+	 */
+	std::vector<WorldPos> mPositions;
+
+	/**
+	 * @brief The neighbors of cell i are mNeighbors[mOffsets[i]] to mNeighbors[mOffsets[i + 1]].
+	 * 
+	 */
+	std::vector<std::uint32_t> mOffsets, mNeighbors;
+
+	/**
+	 * @brief The instances where each cell is a head or a tail. Wire everywhere else.
+	 * 
+	 */
+	std::vector<Mask> mHeads, mTails;
+
+	/**
+	 * @brief The cells that are a head or a tail in at least one instance.
+	 * 
+	 */
+	std::vector<std::uint32_t> mActiveHeads, mActiveTails;
+
+	/**
+	 * @brief Whether a cell is in mActiveHeads/mActiveTails. Only rebuilt when edited.
+	 * 
+	 */
+	bool mActiveValid;
+
+	/**
+	 * @brief Bit-sliced head neighbor counts: bit 0, bit 1, and 4 or more.
+	 * 
+	 */
+	std::vector<Mask> mOnes, mTwos, mMore;
+
+	/**
+	 * @brief Scratch space for the wires next to heads.
+	 * 
+	 */
+	std::vector<std::uint8_t> mTouchedFlag;
+	std::vector<std::uint32_t> mTouched, mNewHeads;
+
+	/**
+	 * @brief Probed cells, and the heads & tails there after every step.
+	 * 
+	 */
+	std::vector<std::uint32_t> mProbes;
+	std::vector<std::vector<std::pair<Mask, Mask>>> mTraces;
+
+	/**
+	 * @brief The amount of generations stepped so far.
+	 * 
+	 */
+	unsigned long long mGeneration;
+
+	/**
+	 * @brief Rebuild the active lists after edits.
+	 * 
+	 */
+	void updateActive();
+
+	/**
+	 * @return True If any bit of the mask is set.
+	 */
+	static bool any(const Mask& m);
+
+	/**
+	 * @brief The type of one instance, from its head & tail bits.
+	 * 
+	 */
+	static Cell::Type typeOf(const Mask& heads, const Mask& tails, std::size_t instance);
+};
+
+/**
+ * @brief Batch engines for 64 & 256 instances.
+ * 
+ */
+typedef BatchEngine<1> BatchEngine64;
+typedef BatchEngine<4> BatchEngine256;
@@ -2,8 +2,71 @@
 
 #include <SFML/System.hpp>
 
+#include <functional>
 #include <vector>
 
+/**
+ * @brief A position in the world, in cells. Coordinates are 64-bit, so a world can grow far past where 32-bit ones wrap.
+ * 
+ */
+typedef sf::Vector2<sf::Int64> WorldPos;
+
+/**
+ * @brief Divide, rounding towards negative infinity rather than zero,
+ * so the chunks, tiles & blocks left of & above the origin don't share index 0.
+ * 
+ * @param a The dividend.
+ * @param b The divisor, which must be positive.
+ */
+inline sf::Int64 floorDiv(sf::Int64 a, sf::Int64 b)
+{
+	//Written so it can't overflow, even for the most negative a.
+	return a >= 0 ? a / b : (a + 1) / b - 1;
+}
+
+/**
+ * @brief Find the square of a grid a position is in, as with floorDiv().
+ * 
+ * @param pos The position.
+ * @param size The side of the grid's squares.
+ */
+inline WorldPos floorDiv(WorldPos pos, sf::Int64 size)
+{
+	return WorldPos(floorDiv(pos.x, size), floorDiv(pos.y, size));
+}
+
+/**
+ * @brief A rectangle of the world, in cells. Laid out like sf::Rect, without needing the graphics module.
+ * 
+ */
+struct WorldRect
+{
+	sf::Int64 left = 0, top = 0, width = 0, height = 0;
+
+	WorldRect() = default;
+
+	WorldRect(sf::Int64 left, sf::Int64 top, sf::Int64 width, sf::Int64 height)
+		: left(left),
+		  top(top),
+		  width(width),
+		  height(height)
+	{
+	}
+
+	/**
+	 * @return True If the position is inside the rectangle, counting the left & top edges only.
+	 */
+	bool contains(sf::Int64 x, sf::Int64 y) const
+	{
+		return x >= left && x < left + width && y >= top && y < top + height;
+	}
+
+	bool contains(WorldPos pos) const
+	{
+		return contains(pos.x, pos.y);
+	}
+};
+
 /**
  * @brief A simple cell data structure, including behaviors.
  * 
@@ -28,28 +91,28 @@ public:
 	 * 
 	 * @param type The initial cell type.
 	 */
-	Cell(Type type, sf::Vector2i pos = {0, 0});
+	Cell(Type type, WorldPos pos = {0, 0});
 
 	/**
 	 * @brief Set the cell's position.
 	 * 
 	 * @param newPos The new pos.
 	 */
-	void setPosition(sf::Vector2i newPos);
+	void setPosition(WorldPos newPos);
 
 	/**
 	 * @brief Get the cell's position.
 	 * 
-	 * @return sf::Vector2i The cell's current position.
+	 * @return WorldPos The cell's current position.
 	 */
-	sf::Vector2i getPosition();
+	WorldPos getPosition() const;
 
 	/**
 	 * @brief Get the Type of the cell.
 	 * 
 	 * @return Type The cell's current type.
 	 */
-	Type getType();
+	Type getType() const;
 
 	/**
 	 * @brief Defines the behavior of the cells. Steps the cell forward based on the types of it's neighbors.
@@ -58,6 +121,15 @@ public:
 	 */
 	void step(std::vector<Cell*> neighbors);
 
+	/**
+	 * @brief Hashes cell positions, for use as a key in unordered containers.
+	 * 
+	 */
+	struct PositionHash
+	{
+		std::size_t operator()(const WorldPos& pos) const;
+	};
+
 private:
 	/**
 	 * @brief The cell's internal type.
@@ -69,5 +141,5 @@ private:
 	 * @brief The cell's position.
 	 * 
 	 */
-	sf::Vector2i mPos;
+	WorldPos mPos;
 };
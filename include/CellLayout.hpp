@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief Orders cells along a space-filling curve, so cells that are close in the world end up close in memory.
+ *
+ * @remarks Engines keep their state in arrays indexed like the cells, so with the cells in curve order,
+ * a signal moving along a wire mostly walks memory in order, instead of jumping to wherever each cell
+ * happened to be placed. Positions are taken from the corner of the cells' bounds; for worlds wider
+ * than 2^32 cells the lowest bits are dropped so keys fit in 64 bits, and cells sharing a key keep row order.
+ */
+class CellLayout
+{
+public:
+	/**
+	 * @brief The orders cells can be kept in.
+	 *
+	 */
+	enum Curve
+	{
+		INSERTION, //The order the cells were added in, never reordered.
+		MORTON,
+		HILBERT
+	};
+
+	/**
+	 * @return std::vector<std::size_t> The indices of the cells, in the curve's order.
+	 */
+	static std::vector<std::size_t> getOrder(const std::vector<Cell>& cells, Curve curve);
+
+	/**
+	 * @return std::uint64_t Where a position is along the Z-order curve: its coordinates' bits, interleaved.
+	 */
+	static std::uint64_t getMortonKey(std::uint32_t x, std::uint32_t y);
+
+	/**
+	 * @return std::uint64_t Where a position is along the Hilbert curve filling a square 2^bits cells a side.
+	 * Unlike the Z-order curve, it never jumps, so consecutive keys are always neighboring cells.
+	 */
+	static std::uint64_t getHilbertKey(std::uint32_t x, std::uint32_t y, int bits);
+
+	/**
+	 * @return std::string The curve's name, as taken by fromName().
+	 */
+	static std::string getName(Curve curve);
+
+	/**
+	 * @return true If the name is a curve's, which is then written to `curve`.
+	 */
+	static bool fromName(const std::string& name, Curve& curve);
+
+	/**
+	 * @return std::vector<Curve> Every curve, the insertion order first.
+	 */
+	static std::vector<Curve> getCurves();
+};
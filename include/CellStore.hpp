@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Cell.hpp"
+#include "ChunkPager.hpp"
+
+/**
+ * @brief A vector of cells stored in fixed-size chunks, shared copy-on-write.
+ * 
+ * @remarks Copying a CellStore is O(1): the copy shares every chunk, and a chunk is
+ * only duplicated the first time either side modifies it. Copies can be read on
+ * another thread while the original keeps being edited.
+ *
+ * With paging on, cold chunks (ones without heads or tails) are written to a ChunkPager
+ * once too many chunks are in memory, least recently used first, and read back the next
+ * time they're accessed. A reference from operator[] stays valid until another chunk
+ * has been accessed.
+ */
+class CellStore
+{
+public:
+	/**
+	 * @brief The amount of cells per chunk.
+	 * 
+	 */
+	static const std::size_t CHUNK_SIZE = 1024;
+
+	/**
+	 * @brief Construct an empty store.
+	 * 
+	 */
+	CellStore();
+
+	/**
+	 * @brief Construct a store holding the given cells, in order.
+	 * 
+	 */
+	CellStore(const std::vector<Cell>& cells);
+
+	/**
+	 * @brief Share another store's chunks.
+	 * 
+	 */
+	CellStore(const CellStore& other);
+	CellStore& operator=(const CellStore& other);
+
+	/**
+	 * @return std::size_t The amount of cells.
+	 */
+	std::size_t size() const;
+
+	/**
+	 * @return True If there are no cells.
+	 */
+	bool empty() const;
+
+	/**
+	 * @brief Read the cell at an index.
+	 * 
+	 */
+	const Cell& operator[](std::size_t i) const;
+
+	/**
+	 * @brief Overwrite the cell at an index.
+	 * 
+	 * @remarks Copies the cell's chunk first, if it's shared.
+	 */
+	void set(std::size_t i, const Cell& c);
+
+	/**
+	 * @brief Append a cell.
+	 * 
+	 */
+	void push_back(const Cell& c);
+
+	/**
+	 * @brief Remove the cell at an index, moving the last cell into its place.
+	 * 
+	 */
+	void erase(std::size_t i);
+
+	/**
+	 * @brief Remove all cells.
+	 * 
+	 */
+	void clear();
+
+	/**
+	 * @return std::vector<Cell> A flat copy of all cells.
+	 */
+	std::vector<Cell> toVector() const;
+
+	/**
+	 * @return std::size_t The amount of chunks this store had to copy because they were shared.
+	 */
+	std::size_t getCopiedChunks() const;
+
+	/**
+	 * @return True If another store, e.g. a snapshot being saved, still shares any of the chunks.
+	 */
+	bool isShared() const;
+
+	/**
+	 * @brief Start paging cold chunks out to a file, or stop & read them all back.
+	 * 
+	 * @param pager The file to page to, nullptr to stop paging.
+	 * @param maxResident The most chunks kept in memory. Chunks with heads or tails are never
+	 * paged out, so there can be more of those.
+	 */
+	void setPaging(std::shared_ptr<ChunkPager> pager, std::size_t maxResident);
+
+	/**
+	 * @return std::shared_ptr<ChunkPager> The file being paged to, if paging is on.
+	 */
+	std::shared_ptr<ChunkPager> getPager() const;
+
+	/**
+	 * @return std::size_t The amount of chunks, and how many of them are in memory.
+	 */
+	std::size_t getChunks() const;
+	std::size_t getResidentChunks() const;
+
+private:
+	/**
+	 * @brief Up to CHUNK_SIZE cells.
+	 * 
+	 */
+	typedef std::vector<Cell> Chunk;
+
+	/**
+	 * @brief A chunk, and where it's paged to.
+	 * 
+	 */
+	struct Entry
+	{
+		/**
+		 * @brief The cells, nullptr while paged out.
+		 * 
+		 */
+		std::shared_ptr<const Chunk> chunk;
+
+		/**
+		 * @brief A copy of the cells on disk, if they haven't changed since they were paged out.
+		 * 
+		 */
+		std::shared_ptr<const ChunkPager::Page> page;
+
+		/**
+		 * @brief The amount of heads & tails in the chunk.
+		 * 
+		 */
+		std::uint32_t active = 0;
+
+		/**
+		 * @brief When the chunk was last accessed, see mTick.
+		 * 
+		 */
+		std::uint64_t used = 0;
+	};
+
+	/**
+	 * @brief All chunks, in order.
+	 * 
+	 */
+	typedef std::vector<Entry> Table;
+
+	/**
+	 * @brief The chunk table, itself shared between copies until one of them changes it.
+	 * 
+	 * @remarks Mutable because reading a paged out chunk puts it back in the table.
+	 */
+	mutable std::shared_ptr<Table> mTable;
+
+	/**
+	 * @brief If this store made the chunk table, rather than getting it from a copy.
+	 * Only then is the table updated in place while paging, since the store it was copied
+	 * from may still be reading it on another thread.
+	 * 
+	 */
+	mutable bool mOwnsTable;
+
+	/**
+	 * @brief The amount of cells.
+	 * 
+	 */
+	std::size_t mSize;
+
+	/**
+	 * @brief See getCopiedChunks().
+	 * 
+	 */
+	mutable std::size_t mCopiedChunks;
+
+	/**
+	 * @brief The file cold chunks are paged to, nullptr if paging is off.
+	 * 
+	 */
+	std::shared_ptr<ChunkPager> mPager;
+
+	/**
+	 * @brief The most chunks kept in memory, and how many are.
+	 * 
+	 */
+	std::size_t mMaxResident;
+	mutable std::size_t mResident;
+
+	/**
+	 * @brief Counts up every time a different chunk is accessed, to find the least recently used ones.
+	 * 
+	 */
+	mutable std::uint64_t mTick;
+	mutable std::size_t mLastChunk;
+
+	/**
+	 * @brief The last chunk read from the file while the table was shared, and the page it came from.
+	 * 
+	 */
+	mutable Chunk mScratch;
+	mutable std::shared_ptr<const ChunkPager::Page> mScratchPage;
+
+	/**
+	 * @brief Make sure no other store shares the chunk table.
+	 * 
+	 */
+	Table& editTable() const;
+
+	/**
+	 * @brief Get a chunk for reading, paging it in if needed.
+	 * 
+	 */
+	const Chunk& readChunk(std::size_t chunk) const;
+
+	/**
+	 * @brief Page out least recently used cold chunks, until few enough are in memory.
+	 * 
+	 */
+	void trim() const;
+
+	/**
+	 * @brief Read a paged out chunk from the file.
+	 * 
+	 */
+	void readPage(const ChunkPager::Page& page, Chunk& cells) const;
+
+	/**
+	 * @return True If the cell is a head or a tail, which keeps its chunk in memory.
+	 */
+	static bool isActive(const Cell& c);
+
+	/**
+	 * @brief Make sure no other store shares a chunk, and get it for writing.
+	 * 
+	 * @param chunk The chunk's index in the table.
+	 */
+	Chunk& editChunk(std::size_t chunk);
+};
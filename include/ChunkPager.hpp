@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief A disk file holding chunks of cells evicted from memory.
+ *
+ * @remarks The file is split into fixed-size pages. A page is freed when the last handle
+ * to it is dropped, and reused by the next write. Safe to use from several threads.
+ */
+class ChunkPager : public std::enable_shared_from_this<ChunkPager>
+{
+public:
+	/**
+	 * @brief A chunk written to the file. Frees its page when destroyed.
+	 *
+	 */
+	class Page
+	{
+	public:
+		Page(std::shared_ptr<ChunkPager> pager, std::size_t index, std::size_t count);
+		~Page();
+
+		/**
+		 * @return std::size_t The amount of cells on the page.
+		 */
+		std::size_t getCount() const;
+
+	private:
+		friend class ChunkPager;
+
+		std::shared_ptr<ChunkPager> mPager;
+		std::size_t mIndex;
+		std::size_t mCount;
+	};
+
+	/**
+	 * @brief Create a pager. Always use this, since pages keep the pager alive.
+	 *
+	 * @param path The file to page to. It's truncated, and only valid while the pager lives.
+	 * @param pageCells The most cells a page holds.
+	 * @return std::shared_ptr<ChunkPager> The pager, or nullptr if the file couldn't be opened.
+	 */
+	static std::shared_ptr<ChunkPager> create(const std::string& path, std::size_t pageCells);
+
+	/**
+	 * @brief Write cells to a free page.
+	 *
+	 * @return std::shared_ptr<const Page> The page, or nullptr if it couldn't be written.
+	 */
+	std::shared_ptr<const Page> write(const std::vector<Cell>& cells);
+
+	/**
+	 * @brief Read a page back.
+	 *
+	 * @param cells Filled with the page's cells.
+	 * @return true If the page could be read.
+	 */
+	bool read(const Page& page, std::vector<Cell>& cells);
+
+	/**
+	 * @return std::string The file being paged to.
+	 */
+	std::string getPath();
+
+	/**
+	 * @return std::size_t The amount of pages in use.
+	 */
+	std::size_t getPages();
+
+	/**
+	 * @return std::size_t The amount of pages written & read so far.
+	 */
+	std::size_t getWrites();
+	std::size_t getReads();
+
+private:
+	ChunkPager(const std::string& path, std::size_t pageCells);
+
+	/**
+	 * @brief Return a page to the free list.
+	 *
+	 */
+	void release(std::size_t index);
+
+	/**
+	 * @brief The size of a cell on disk: its type, then its position.
+	 *
+	 */
+	static const std::size_t CELL_BYTES = 17;
+
+	std::string mPath;
+	std::fstream mFile;
+	std::size_t mPageCells;
+
+	/**
+	 * @brief The amount of pages the file has room for, and those of them that are free.
+	 *
+	 */
+	std::size_t mPageCount;
+	std::vector<std::size_t> mFreePages;
+
+	std::size_t mWrites, mReads;
+
+	/**
+	 * @brief The file & free list are shared by every store paging to it.
+	 *
+	 */
+	std::mutex mMutex;
+
+	/**
+	 * @brief Scratch space for a page's bytes.
+	 *
+	 */
+	std::vector<char> mBuffer;
+};
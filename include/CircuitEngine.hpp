@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "CircuitRecognizer.hpp"
+#include "SimulationEngine.hpp"
+#include "WireComponents.hpp"
+
+/**
+ * @brief An engine that recognizes the parts of a circuit, and steps each part as a whole:
+ * wires & clock loops as shift registers, 64 cells per operation, and gates by table lookup.
+ * Whatever isn't recognized is stepped cell by cell, like the compiled engine.
+ *
+ * @remarks Every cell still goes through the same states as with the other engines, so parts
+ * only change how the next generation is worked out, not what's drawn. The state of every cell is
+ * kept here, as bits for parts, and only written to the cells & the change list once per advance(),
+ * so stepping many generations between frames costs a word per 64 wire cells, not a write per cell.
+ */
+class CircuitEngine : public SimulationEngine
+{
+public:
+	/**
+	 * @brief The format of what's kept in the compile cache. Bump it when that, or the shapes, change.
+	 *
+	 */
+	static const std::uint32_t CACHE_VERSION = 1;
+
+	CircuitEngine();
+
+	virtual std::string getName() const;
+
+	virtual void invalidate();
+
+	virtual void step(CellStore& cells, std::vector<Cell>& changed);
+
+	virtual void advance(CellStore& cells, std::size_t generations, std::vector<Cell>& changed);
+
+	virtual std::size_t getPrunedCells() const;
+
+	virtual std::size_t getNativeCells() const;
+
+	/**
+	 * @return const CircuitRecognizer& The parts found in the world, as of the last step.
+	 */
+	const CircuitRecognizer& getRecognizer() const;
+
+private:
+	/**
+	 * @brief A recognized part, and its state.
+	 *
+	 */
+	struct Unit
+	{
+		/**
+		 * @brief The part's cells, see CircuitRecognizer::Part.
+		 *
+		 */
+		std::vector<std::uint32_t> cells;
+
+		/**
+		 * @brief Every cell outside the part that touches it, with the slot in `cells` it touches.
+		 *
+		 */
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+
+		/**
+		 * @brief Wires keep a bit per cell for heads & tails, gates 2 bits per cell with its type.
+		 *
+		 */
+		bool wire, cycle;
+		std::vector<std::uint64_t> heads, tails, nextHeads;
+		std::uint32_t shape;
+		std::uint64_t state, next;
+
+		/**
+		 * @brief The state as last written to the cells, in the same layout.
+		 *
+		 */
+		std::vector<std::uint64_t> shownHeads, shownTails;
+		std::uint64_t shownState;
+
+		/**
+		 * @brief The cells other parts read, which wake them when they become heads:
+		 * a bit per cell for wires, the high bit of each cell's 2 for gates.
+		 *
+		 */
+		std::vector<std::uint64_t> watched;
+		std::uint64_t watchedState;
+
+		/**
+		 * @brief If the part is to be stepped next generation, and if it changed since it was last written.
+		 *
+		 */
+		bool queued, dirty;
+	};
+
+	/**
+	 * @brief Recognize the parts, and build the neighbor lists of the cells outside them.
+	 *
+	 */
+	void compile(const CellStore& cells);
+
+	/**
+	 * @brief Step one generation, without touching the cells.
+	 *
+	 */
+	void tick();
+
+	/**
+	 * @brief Write the cells that changed since the last time.
+	 *
+	 */
+	void flush(CellStore& cells, std::vector<Cell>& changed);
+
+	/**
+	 * @brief Work out a part's next state from the current types of the cells.
+	 *
+	 */
+	void evaluate(Unit& unit);
+
+	/**
+	 * @return true If a cell is currently a head, whether it's in a part or not.
+	 */
+	bool isHead(std::uint32_t cell) const;
+
+	/**
+	 * @brief Change the type of a cell outside of the parts.
+	 *
+	 */
+	void setLoose(std::uint32_t cell, Cell::Type type);
+
+	/**
+	 * @brief Look up the next state of a gate, working it out the first time.
+	 *
+	 * @param inputs 2 bits per cell, with the amount of heads next to it outside the gate.
+	 */
+	std::uint64_t lookup(std::uint32_t shape, std::uint64_t state, std::uint64_t inputs);
+
+	/**
+	 * @brief Have a part stepped next generation.
+	 *
+	 */
+	void wake(std::uint32_t unit);
+
+	/**
+	 * @brief Mark the part's watchers to be stepped, if a cell became a head.
+	 *
+	 */
+	void wakeWatchers(std::uint32_t cell);
+
+	/**
+	 * @brief Whether the compiled state matches the cells.
+	 *
+	 */
+	bool mCompiled;
+
+	WireComponents mComponents;
+	CircuitRecognizer mRecognizer;
+
+	/**
+	 * @brief The type of each cell, by index, and the unit it's in, or NO_UNIT, and where in the unit.
+	 * Types of cells in units are only up to date as of the last flush().
+	 *
+	 */
+	std::vector<std::uint8_t> mTypes;
+	std::vector<std::uint32_t> mUnitOf, mSlotOf;
+
+	/**
+	 * @brief The position of each cell, so writing a cell doesn't have to read it first.
+	 *
+	 */
+	std::vector<WorldPos> mPositions;
+	static constexpr std::uint32_t NO_UNIT = ~0u;
+
+	std::vector<Unit> mUnits;
+
+	/**
+	 * @brief The units stepped this generation, and the next.
+	 *
+	 */
+	std::vector<std::uint32_t> mActive, mNextActive;
+
+	/**
+	 * @brief The units that read cell i are mWatchers[mWatchOffsets[i]] to mWatchers[mWatchOffsets[i + 1]].
+	 *
+	 */
+	std::vector<std::uint32_t> mWatchOffsets, mWatchers;
+
+	/**
+	 * @brief Next states of gates, per shape, by state & inputs. Kept across layouts,
+	 * since shapes don't change.
+	 *
+	 */
+	std::vector<std::unordered_map<std::uint64_t, std::uint32_t>> mTables;
+
+	/**
+	 * @brief The cells outside of units, stepped like CompiledEngine does.
+	 *
+	 */
+	std::vector<std::uint32_t> mOffsets, mNeighbors;
+	std::vector<std::uint32_t> mHeads, mTails;
+	std::vector<std::uint8_t> mCounts;
+	std::vector<std::uint32_t> mTouched, mNewHeads;
+
+	/**
+	 * @brief The cells outside units, and the units, that changed since the last flush().
+	 *
+	 */
+	std::vector<std::uint32_t> mDirtyCells, mDirtyUnits;
+	std::vector<bool> mCellDirty;
+
+	std::size_t mNativeCells;
+};
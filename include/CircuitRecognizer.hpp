@@ -0,0 +1,213 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+#include "CellStore.hpp"
+#include "CompileCache.hpp"
+#include "WireComponents.hpp"
+
+/**
+ * @brief Finds the standard parts Wireworld circuits are built from in the layout of a world:
+ * diodes, OR, XOR & AND-NOT gates at every rotation & mirror image, and plain wires & clock loops.
+ *
+ * @remarks Only the layout is matched, not the signals, so parts are found whatever state they're in.
+ * A wire here is a run of cells that each touch exactly two others, which steps like a shift register.
+ */
+class CircuitRecognizer
+{
+public:
+	/**
+	 * @brief The kinds of part.
+	 *
+	 */
+	enum Kind
+	{
+		WIRE,
+		CLOCK,
+		DIODE,
+		OR,
+		XOR,
+		AND_NOT,
+		KINDS
+	};
+
+	/**
+	 * @brief A gate's layout, in one orientation.
+	 *
+	 */
+	struct Shape
+	{
+		Kind kind;
+
+		/**
+		 * @brief The cells of the gate, and the positions around them that must be empty,
+		 * relative to the first cell.
+		 */
+		std::vector<WorldPos> cells, empty;
+
+		/**
+		 * @brief For every cell, the other cells of the gate it touches.
+		 *
+		 */
+		std::vector<std::vector<std::uint8_t>> neighbors;
+
+		/**
+		 * @brief The neighbors the first cell must & mustn't have, as in getMask().
+		 *
+		 */
+		std::uint8_t required, forbidden;
+	};
+
+	/**
+	 * @brief A recognized part.
+	 *
+	 */
+	struct Part
+	{
+		Kind kind;
+
+		/**
+		 * @brief The cells of the part. Wires are in order along the wire,
+		 * and gates in the order of their shape's cells.
+		 */
+		std::vector<std::uint32_t> cells;
+
+		/**
+		 * @brief For gates, the index of the shape in getShapes().
+		 *
+		 */
+		std::uint32_t shape;
+
+		/**
+		 * @brief For wires, if the last cell touches the first.
+		 *
+		 */
+		bool cycle;
+	};
+
+	/**
+	 * @brief The most cells a gate can have.
+	 *
+	 */
+	static const std::size_t MAX_GATE_CELLS = 16;
+
+	/**
+	 * @brief Wires shorter than this aren't worth treating as parts.
+	 *
+	 */
+	static const std::size_t MIN_WIRE_CELLS = 4;
+
+	/**
+	 * @brief How far apart the ends of a wire can be, for it to count as a clock loop.
+	 *
+	 */
+	static const int CLOCK_GAP = 4;
+
+	/**
+	 * @brief Find the parts of a world. Must be called again after the world is edited.
+	 *
+	 * @param index The index of every cell by position.
+	 */
+	void analyze(const CellStore& cells, const WireComponents::Index& index);
+
+	/**
+	 * @brief Write the parts found.
+	 *
+	 */
+	void save(CompileCache::Writer& out) const;
+
+	/**
+	 * @brief Restore the parts saved for the same layout, instead of analyzing it.
+	 *
+	 * @param cells The amount of cells in the layout.
+	 * @return true If they were read.
+	 */
+	bool load(CompileCache::Reader& in, std::size_t cells);
+
+	/**
+	 * @return const std::vector<Part>& The parts found, gates first.
+	 */
+	const std::vector<Part>& getParts() const;
+
+	/**
+	 * @return std::size_t The amount of parts of a kind.
+	 */
+	std::size_t getCount(Kind kind) const;
+
+	/**
+	 * @return const std::vector<Shape>& Every gate, in every distinct orientation.
+	 */
+	static const std::vector<Shape>& getShapes();
+
+	/**
+	 * @return const char* The name of a kind of part, for display.
+	 */
+	static const char* getName(Kind kind);
+
+private:
+	/**
+	 * @brief Build a gate's shapes from a drawing of it, with '#' for cells, '.' for positions
+	 * that must be empty, and spaces for positions that don't matter.
+	 */
+	static void addShapes(std::vector<Shape>& shapes, Kind kind, const std::vector<std::string>& drawing);
+
+	/**
+	 * @brief Try to place a shape with its first cell on a cell, claiming its cells if it fits.
+	 *
+	 */
+	bool matchShape(const CellStore& cells, const WireComponents::Index& index, std::uint32_t first, std::uint32_t shape);
+
+	/**
+	 * @brief Follow a wire from a cell, claiming its cells.
+	 *
+	 */
+	void traceWire(const CellStore& cells, const WireComponents::Index& index, std::uint32_t first);
+
+	/**
+	 * @return std::array<std::uint32_t, 8> The indices of a cell's neighbors, in the first `count` entries.
+	 */
+	static std::array<std::uint32_t, 8> getNeighbors(const CellStore& cells, const WireComponents::Index& index,
+													 std::uint32_t i, std::size_t& count);
+
+	/**
+	 * @return std::uint8_t A bit for each of the 8 positions around a cell, in NEIGHBORS order.
+	 */
+	static std::uint8_t getMask(const std::vector<WorldPos>& positions, WorldPos center);
+
+	/**
+	 * @brief The positions around a cell, in the order of the bits of a mask.
+	 *
+	 */
+	static const WorldPos NEIGHBORS[8];
+
+	/**
+	 * @brief See getParts().
+	 *
+	 */
+	std::vector<Part> mParts;
+
+	/**
+	 * @brief For every cell, if it's already part of a part.
+	 *
+	 */
+	std::vector<bool> mClaimed;
+
+	/**
+	 * @brief For every cell, which of its neighbors are there, to rule out most shapes without looking them up.
+	 *
+	 */
+	std::vector<std::uint8_t> mMasks;
+
+	/**
+	 * @brief See getCount().
+	 *
+	 */
+	std::size_t mCounts[KINDS];
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "CellStore.hpp"
+
+/**
+ * @brief Keeps what engines compile from a layout in files, keyed by a hash of the layout,
+ * so loading the same world again can skip compiling it.
+ *
+ * @remarks Entries carry the cache format & the engine's own version, and are dropped when either changed.
+ * Once the directory grows past its limit, the least recently used entries are deleted.
+ */
+class CompileCache
+{
+public:
+	/**
+	 * @brief Builds an entry out of plain values & vectors of them.
+	 *
+	 */
+	class Writer
+	{
+	public:
+		template <typename T>
+		void write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be cached");
+			mData.append((const char*)&value, sizeof(T));
+		}
+
+		template <typename T>
+		void write(const std::vector<T>& values)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be cached");
+			write<std::uint64_t>(values.size());
+			mData.append((const char*)values.data(), values.size() * sizeof(T));
+		}
+
+		const std::string& getData() const
+		{
+			return mData;
+		}
+
+	private:
+		std::string mData;
+	};
+
+	/**
+	 * @brief Reads an entry back, in the order it was written.
+	 *
+	 */
+	class Reader
+	{
+	public:
+		Reader(std::string data = "")
+			: mData(std::move(data)),
+			  mPos(0)
+		{
+		}
+
+		/**
+		 * @return true If there was enough left to read.
+		 */
+		template <typename T>
+		bool read(T& value)
+		{
+			if (mData.size() - mPos < sizeof(T))
+			{
+				return false;
+			}
+			std::memcpy(&value, mData.data() + mPos, sizeof(T));
+			mPos += sizeof(T);
+			return true;
+		}
+
+		template <typename T>
+		bool read(std::vector<T>& values)
+		{
+			std::uint64_t size;
+			if (!read(size) || (mData.size() - mPos) / sizeof(T) < size)
+			{
+				return false;
+			}
+			values.resize(size);
+			std::memcpy(values.data(), mData.data() + mPos, size * sizeof(T));
+			mPos += size * sizeof(T);
+			return true;
+		}
+
+		/**
+		 * @return true Once everything was read.
+		 */
+		bool isDone() const
+		{
+			return mPos == mData.size();
+		}
+
+	private:
+		std::string mData;
+		std::size_t mPos;
+	};
+
+	/**
+	 * @brief The layout of the files. Bumping it drops every entry.
+	 *
+	 */
+	static const std::uint32_t FORMAT_VERSION = 2;
+
+	/**
+	 * @brief Open a cache, creating the directory if needed.
+	 *
+	 * @param maxBytes The most the entries may take up together.
+	 * @return std::shared_ptr<CompileCache> The cache, or nullptr if the directory couldn't be created.
+	 */
+	static std::shared_ptr<CompileCache> create(const std::string& directory, std::uintmax_t maxBytes);
+
+	/**
+	 * @return std::uint64_t A hash of the positions of the cells, in order. Signals don't count.
+	 */
+	static std::uint64_t hashLayout(const CellStore& cells);
+
+	/**
+	 * @brief Find an engine's entry for a layout.
+	 *
+	 * @param engine The engine's name.
+	 * @param version The engine's current format, entries written with another one are dropped.
+	 * @return true If there was a valid entry, which is now in `entry`.
+	 */
+	bool load(const std::string& engine, std::uint32_t version, std::uint64_t key, Reader& entry);
+
+	/**
+	 * @brief Write an engine's entry for a layout, making room for it.
+	 *
+	 * @return true If it was written.
+	 */
+	bool store(const std::string& engine, std::uint32_t version, std::uint64_t key, const Writer& entry);
+
+	/**
+	 * @return std::size_t How many loads found an entry, and how many didn't.
+	 */
+	std::size_t getHits() const;
+	std::size_t getMisses() const;
+
+	/**
+	 * @return std::uintmax_t The size of the entries, as of the last store.
+	 */
+	std::uintmax_t getBytes() const;
+
+	std::string getDirectory() const;
+
+private:
+	CompileCache(const std::string& directory, std::uintmax_t maxBytes);
+
+	/**
+	 * @brief The fixed start of every file.
+	 *
+	 */
+	struct Header
+	{
+		char magic[4];
+		std::uint32_t format, version;
+		std::uint64_t key, size, checksum;
+	};
+
+	/**
+	 * @return std::filesystem::path The file of an engine's entry for a layout.
+	 */
+	std::filesystem::path getPath(const std::string& engine, std::uint64_t key) const;
+
+	/**
+	 * @brief Delete the least recently used entries, until they fit the limit.
+	 *
+	 */
+	void evict();
+
+	/**
+	 * @return std::uint64_t FNV-1a of some bytes.
+	 */
+	static std::uint64_t hash(const char* data, std::size_t size, std::uint64_t seed = 14695981039346656037ull);
+
+	std::filesystem::path mDirectory;
+	std::uintmax_t mMaxBytes;
+	std::uintmax_t mBytes;
+	std::size_t mHits, mMisses;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "SimulationEngine.hpp"
+#include "WireComponents.hpp"
+
+/**
+ * @brief A fast engine, that compiles the world into a neighbor list once per layout,
+ * and then only touches heads, tails and the wires next to heads each generation.
+ * A step costs O(heads + tails) rather than O(cells).
+ * Groups of wire that can never carry a signal are left out of the neighbor list entirely.
+ * 
+ */
+class CompiledEngine : public SimulationEngine
+{
+public:
+	/**
+	 * @brief The format of what's kept in the compile cache. Bump it when that changes.
+	 *
+	 */
+	static const std::uint32_t CACHE_VERSION = 1;
+
+	CompiledEngine();
+
+	virtual std::string getName() const;
+
+	virtual void invalidate();
+
+	virtual void step(CellStore& cells, std::vector<Cell>& changed);
+
+	virtual std::size_t getPrunedCells() const;
+
+private:
+	/**
+	 * @brief Build the neighbor lists & active sets from the cells,
+	 * taking the components from the cache when the layout was compiled before.
+	 * 
+	 */
+	void compile(const CellStore& cells);
+
+	/**
+	 * @brief Whether the compiled state matches the cells.
+	 * 
+	 */
+	bool mCompiled;
+
+	/**
+	 * @brief The connected groups of cells, to skip the dead ones.
+	 * 
+	 */
+	WireComponents mComponents;
+
+	/**
+	 * @brief The type of each cell, by index.
+	 * 
+	 */
+	std::vector<std::uint8_t> mTypes;
+
+	/**
+	 * @brief The neighbors of cell i are mNeighbors[mOffsets[i]] to mNeighbors[mOffsets[i + 1]].
+	 * 
+	 */
+	std::vector<std::uint32_t> mOffsets, mNeighbors;
+
+	/**
+	 * @brief The indices of all heads & tails.
+	 * 
+	 */
+	std::vector<std::uint32_t> mHeads, mTails;
+
+	/**
+	 * @brief Scratch space for counting head neighbors of wires.
+	 * 
+	 */
+	std::vector<std::uint8_t> mCounts;
+	std::vector<std::uint32_t> mTouched, mNewHeads;
+};
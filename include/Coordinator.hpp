@@ -0,0 +1,146 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <SFML/System.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief Splits a world into vertical strips, hands each strip to a Worker process,
+ * and keeps all workers in lockstep, one generation at a time.
+ * 
+ * @remarks Workers trade their edge columns with each other directly, the coordinator
+ * only acts as the barrier between generations.
+ */
+class Coordinator
+{
+public:
+	/**
+	 * @brief Every packet between the coordinator & workers starts with one of these.
+	 * 
+	 */
+	enum Message : sf::Uint8
+	{
+		HELLO,    //Worker -> coordinator, with the port the worker listens on for its left neighbor.
+		ASSIGN,   //Coordinator -> worker, with the worker's strip, cells & neighbors.
+		READY,    //Worker -> coordinator, once it's connected to it's neighbors.
+		GO,       //Coordinator -> worker, step one generation.
+		HALO,     //Worker -> worker, the heads on the shared edge.
+		DONE,     //Worker -> coordinator, the generation was stepped.
+		GATHER,   //Coordinator -> worker, send back all cells.
+		CELLS,    //Worker -> coordinator, all of the worker's cells.
+		QUIT      //Coordinator -> worker, shut down.
+	};
+
+	/**
+	 * @brief Construct a new coordinator.
+	 * 
+	 * @param port The port workers connect to.
+	 * @param workers The amount of workers to wait for.
+	 */
+	Coordinator(unsigned short port, unsigned int workers);
+
+	/**
+	 * @brief Start the given amount of worker processes on this machine,
+	 * connecting back to the coordinator over loopback.
+	 * 
+	 * @param exe The path to the Wireworld executable.
+	 * @return true If all processes were started.
+	 */
+	bool spawnLocalWorkers(const std::string& exe);
+
+	/**
+	 * @brief Distribute the cells over all workers, and simulate them.
+	 * 
+	 * @param cells The world to simulate. Replaced by the world after `generations` steps.
+	 * @param generations The amount of generations to simulate.
+	 * @return true If the simulation completed.
+	 * @return false If a worker failed or disconnected.
+	 */
+	bool run(std::vector<Cell>& cells, unsigned int generations);
+
+private:
+	/**
+	 * @brief A connected worker.
+	 * 
+	 */
+	struct Peer
+	{
+		sf::TcpSocket socket;
+		unsigned short listenPort;
+	};
+
+	/**
+	 * @brief Wait for all workers to connect and say hello.
+	 * 
+	 * @return true If all workers connected.
+	 */
+	bool acceptWorkers();
+
+	/**
+	 * @brief Pick the strip bounds for each worker, so the cells are split evenly.
+	 * 
+	 * @param cells The world to split.
+	 * @return std::vector<sf::Int64> The left column of each strip, followed by INT64_MAX.
+	 */
+	std::vector<sf::Int64> splitColumns(std::vector<Cell> cells);
+
+	/**
+	 * @brief Send a packet to every worker.
+	 * 
+	 * @return true If it reached all of them.
+	 */
+	bool broadcast(sf::Packet& packet);
+
+	/**
+	 * @brief Receive one packet of the given type from every worker.
+	 * 
+	 * @param type The expected message type.
+	 * @param replies Filled with the reply of each worker, by index.
+	 * @return true If all workers replied with the expected message.
+	 */
+	bool gather(Message type, std::vector<sf::Packet>& replies);
+
+	/**
+	 * @brief Stop all workers & reap any spawned processes.
+	 * 
+	 */
+	void shutdown();
+
+	/**
+	 * @brief The socket workers connect to.
+	 * 
+	 */
+	sf::TcpListener mListener;
+
+	/**
+	 * @brief The port of mListener.
+	 * 
+	 */
+	unsigned short mPort;
+
+	/**
+	 * @brief All connected workers, in strip order from left to right.
+	 * 
+	 */
+	std::vector<std::unique_ptr<Peer>> mPeers;
+
+	/**
+	 * @brief The amount of workers to wait for.
+	 * 
+	 */
+	unsigned int mWorkerCount;
+
+	/**
+	 * @brief The process IDs of workers started by spawnLocalWorkers().
+	 * 
+	 */
+	std::vector<int> mChildren;
+};
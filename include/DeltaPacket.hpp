@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief A packet of the remote viewer protocol, with a compact encoding for lists of cells.
+ * 
+ * @remarks Cells are sorted by row, merged into horizontal runs of one type,
+ * and each run is stored as variable-length offsets from the previous one.
+ * A typical generation's changes take 3-4 bytes per run, rather than 9 bytes per cell.
+ */
+class DeltaPacket : public sf::Packet
+{
+public:
+	/**
+	 * @brief Every packet starts with one of these.
+	 * 
+	 */
+	enum Message : sf::Uint8
+	{
+		SUBSCRIBE,   //Viewer -> server, the region the viewer wants to see.
+		KEYFRAME,    //Server -> viewer, every cell in the subscribed region.
+		DELTA        //Server -> viewer, the cells in the region that changed in one generation.
+	};
+
+	/**
+	 * @brief Append a list of cells.
+	 * 
+	 * @param cells The cells. Cells of type NONE mark removed cells.
+	 */
+	void writeCells(std::vector<Cell> cells);
+
+	/**
+	 * @brief Read a list of cells written by writeCells().
+	 * 
+	 * @param cells Filled with the cells read.
+	 * @return true If the list was read successfully.
+	 */
+	bool readCells(std::vector<Cell>& cells);
+
+private:
+	/**
+	 * @brief Append an unsigned integer, 7 bits per byte.
+	 * 
+	 */
+	void writeVarint(sf::Uint64 value);
+
+	/**
+	 * @brief Read an unsigned integer written by writeVarint().
+	 * 
+	 */
+	bool readVarint(sf::Uint64& value);
+
+	/**
+	 * @brief Append a signed integer, zig-zag encoded so small negatives stay small.
+	 * 
+	 */
+	void writeSigned(sf::Int64 value);
+
+	/**
+	 * @brief Read a signed integer written by writeSigned().
+	 * 
+	 */
+	bool readSigned(sf::Int64& value);
+};
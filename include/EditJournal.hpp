@@ -0,0 +1,266 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+#include "CellStore.hpp"
+#include "SnapshotSaver.hpp"
+
+/**
+ * @brief Autosaves a world by appending every edit to a journal file, so the I/O follows the edit rate,
+ * not the size of the world. Now & then the journal is compacted into a snapshot of the whole world.
+ *
+ * @remarks The directory holds `snapshot-N.wi`, the world when journal N was started, and `journal-N.bin`,
+ * the edits since. Compacting starts journal N + 1 and saves snapshot N + 1 in the background, and only
+ * once that's safely written are the older files deleted, so there's always a snapshot & journals to recover from.
+ * Edits reach the file every frame, and the disk every SYNC_INTERVAL.
+ * Layout edits are recovered exactly, signals as of the last snapshot.
+ */
+class EditJournal
+{
+public:
+	/**
+	 * @brief The kinds of edit.
+	 *
+	 */
+	enum Op : std::uint8_t
+	{
+		SET = 1,
+		CLEAR,
+		RESET
+	};
+
+	/**
+	 * @brief An edit, as read back from a journal.
+	 *
+	 */
+	struct Edit
+	{
+		Op op;
+		Cell::Type type;
+		WorldPos pos;
+	};
+
+	/**
+	 * @brief How often the journal is flushed to disk, at most.
+	 *
+	 */
+	static const sf::Time SYNC_INTERVAL;
+
+	/**
+	 * @brief How long edits stay in the journal, at most, before it's compacted.
+	 *
+	 */
+	static const sf::Time COMPACT_INTERVAL;
+
+	/**
+	 * @brief How many edits the journal holds, at most, before it's compacted.
+	 *
+	 */
+	static const std::size_t COMPACT_EDITS = 1 << 16;
+
+	/**
+	 * @brief The size of an edit in a journal file.
+	 *
+	 */
+	static const std::size_t RECORD_SIZE = 20;
+
+	/**
+	 * @brief The size of an edit in journals from before positions were 64-bit, which can still be recovered.
+	 *
+	 */
+	static const std::size_t OLD_RECORD_SIZE = 12;
+
+	/**
+	 * @brief Open a journal directory, creating it if needed, and read back what's in it.
+	 *
+	 * @return std::unique_ptr<EditJournal> The journal, or nullptr if the directory or a new journal file couldn't be created.
+	 */
+	static std::unique_ptr<EditJournal> open(const std::string& directory);
+
+	/**
+	 * @brief Write & flush what's left, and finish compacting.
+	 *
+	 */
+	~EditJournal();
+
+	/**
+	 * @return std::string The snapshot to load to recover the world, empty to start from an empty world.
+	 */
+	std::string getSnapshot() const;
+
+	/**
+	 * @return const std::vector<Edit>& The edits to apply over the snapshot, in order. Never has a RESET.
+	 */
+	const std::vector<Edit>& getRecovered() const;
+
+	/**
+	 * @brief Record a cell being added or changed.
+	 *
+	 */
+	void set(const Cell& cell);
+
+	/**
+	 * @brief Record a cell being removed.
+	 *
+	 */
+	void clear(WorldPos pos);
+
+	/**
+	 * @brief Record the whole world being removed, or replaced. Compact after that as soon as possible.
+	 *
+	 */
+	void reset();
+
+	/**
+	 * @brief Write the edits recorded since the last call, and flush them to disk if it's been SYNC_INTERVAL.
+	 * Call every frame.
+	 *
+	 */
+	void flush();
+
+	/**
+	 * @brief Write & flush everything to disk now.
+	 *
+	 */
+	void sync();
+
+	/**
+	 * @return true If it's time to compact, and no compaction is running.
+	 */
+	bool needsCompaction();
+
+	/**
+	 * @brief Start a new journal, and save the world as its snapshot in the background.
+	 *
+	 * @param cells The whole world, as of the last recorded edit.
+	 */
+	void compact(const CellStore& cells);
+
+	/**
+	 * @return true While a snapshot is being saved.
+	 */
+	bool isCompacting();
+
+	/**
+	 * @return true If everything recorded is on disk, and nothing's being saved.
+	 */
+	bool isSettled();
+
+	/**
+	 * @return std::size_t The number of the current journal.
+	 */
+	std::size_t getEpoch() const;
+
+	/**
+	 * @return std::size_t The amount of edits in the current journal.
+	 */
+	std::size_t getEdits() const;
+
+	std::string getDirectory() const;
+
+private:
+	EditJournal(const std::string& directory);
+
+	/**
+	 * @brief Find the newest snapshot, read the journals from then on, and start the next journal.
+	 *
+	 * @return true If the next journal could be created.
+	 */
+	bool recover();
+
+	/**
+	 * @brief Read the edits in a journal file, up to the first damaged one.
+	 *
+	 */
+	void readJournal(const std::filesystem::path& path, std::size_t epoch);
+
+	/**
+	 * @brief Close the current journal, and create journal `epoch`.
+	 *
+	 */
+	bool startJournal(std::size_t epoch);
+
+	/**
+	 * @brief Move a finished snapshot into place, and delete what it replaces.
+	 *
+	 */
+	void finishCompaction();
+
+	void append(Op op, Cell::Type type, WorldPos pos);
+
+	/**
+	 * @return std::uint16_t The check stored with an edit, from its other bytes.
+	 */
+	static std::uint16_t check(const unsigned char* record, std::size_t size);
+
+	/**
+	 * @return std::filesystem::path `<directory>/<kind>-<epoch><extension>`.
+	 */
+	std::filesystem::path getPath(const char* kind, std::size_t epoch, const char* extension) const;
+
+	/**
+	 * @return true If a file is named `<kind>-<epoch><extension>`, with the epoch in `epoch`.
+	 */
+	static bool parseName(const std::filesystem::path& path, const char* kind, const char* extension, std::size_t& epoch);
+
+	/**
+	 * @brief Flush a file that was written by someone else to disk.
+	 *
+	 */
+	static void syncFile(const std::filesystem::path& path);
+
+	std::filesystem::path mDirectory;
+
+	/**
+	 * @brief The current journal file, -1 if it couldn't be opened.
+	 *
+	 */
+	int mFile;
+
+	/**
+	 * @brief See getEpoch() & getEdits().
+	 *
+	 */
+	std::size_t mEpoch, mEdits;
+
+	/**
+	 * @brief Edits recorded but not written yet.
+	 *
+	 */
+	std::string mBuffer;
+
+	/**
+	 * @brief If edits were written but not flushed to disk yet.
+	 *
+	 */
+	bool mDirty;
+
+	/**
+	 * @brief If there was a RESET, or a recovery, which the next compaction should fold away.
+	 *
+	 */
+	bool mStale;
+
+	sf::Clock mSinceSync, mSinceCompact;
+
+	/**
+	 * @brief The snapshot being saved, and the epoch it's for.
+	 *
+	 */
+	std::unique_ptr<SnapshotSaver> mSaver;
+	std::size_t mSavingEpoch;
+
+	/**
+	 * @brief See getSnapshot() & getRecovered().
+	 *
+	 */
+	std::string mSnapshot;
+	std::vector<Edit> mRecovered;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "FrameWriter.hpp"
+
+/**
+ * @brief Records a simulation as a numbered PNG sequence.
+ * Frames are rendered to an offscreen texture, so no window is needed,
+ * and encoded by a FrameWriter so capturing doesn't stall the simulation.
+ * 
+ */
+class FrameRecorder
+{
+public:
+	/**
+	 * @brief Construct a new recorder.
+	 * 
+	 * @param size The size of each frame, in pixels.
+	 * @param directory The directory to write frames to. Created if it doesn't exist.
+	 * @param every Only capture every Nth generation.
+	 * @param threads The amount of encoding threads.
+	 * @param queue The max amount of frames waiting to be encoded.
+	 */
+	FrameRecorder(sf::Vector2u size,
+				  const std::string& directory,
+				  unsigned int every   = 1,
+				  unsigned int threads = 2,
+				  std::size_t queue	= 8);
+
+	/**
+	 * @brief Capture a generation, if it's one of the recorded ones.
+	 * 
+	 * @param scene What to draw, i.e. a Wireworld or InfiniteGrid.
+	 * @param generation The generation number, used for picking & naming frames.
+	 * @return true If a frame was captured.
+	 */
+	bool capture(const sf::Drawable& scene, unsigned long long generation);
+
+	/**
+	 * @brief Wait for all captured frames to be written.
+	 * 
+	 */
+	void finish();
+
+	/**
+	 * @return std::size_t The amount of frames captured so far.
+	 */
+	std::size_t getCaptured();
+
+	/**
+	 * @return std::size_t The amount of frames written to disk so far.
+	 */
+	std::size_t getWritten();
+
+private:
+	/**
+	 * @brief The offscreen render target.
+	 * 
+	 */
+	sf::RenderTexture mTexture;
+
+	/**
+	 * @brief Encodes the captured frames.
+	 * 
+	 */
+	FrameWriter mWriter;
+
+	/**
+	 * @brief Where frames are written.
+	 * 
+	 */
+	std::string mDirectory;
+
+	/**
+	 * @brief Capture every Nth generation.
+	 * 
+	 */
+	unsigned int mEvery;
+
+	/**
+	 * @brief The amount of frames captured.
+	 * 
+	 */
+	std::size_t mCaptured;
+};
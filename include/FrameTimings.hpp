@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Collects how long each frame took, and summarizes them.
+ * 
+ */
+class FrameTimings
+{
+public:
+	/**
+	 * @brief Log the time a frame took.
+	 * 
+	 */
+	void add(sf::Time time);
+
+	/**
+	 * @brief Print the frame count, mean, percentiles & the slowest frames.
+	 * 
+	 * @param out The stream to print to.
+	 * @param worst The amount of slowest frames to list.
+	 */
+	void report(std::ostream& out, std::size_t worst = 5);
+
+	/**
+	 * @brief Write every frame's time as CSV, to compare between builds.
+	 * 
+	 * @param path The file to write to.
+	 * @return true If the file was written.
+	 */
+	bool save(const std::string& path);
+
+private:
+	/**
+	 * @brief Every frame's time, in order.
+	 * 
+	 */
+	std::vector<sf::Time> mTimes;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Tracer.hpp"
+
+/**
+ * @brief Encodes & writes images to disk on a pool of background threads.
+ * The queue of pending images is bounded, so a producer faster than the disk
+ * is slowed down instead of running out of memory.
+ * 
+ */
+class FrameWriter
+{
+public:
+	/**
+	 * @brief Start the writer threads.
+	 * 
+	 * @param threads The amount of encoding threads.
+	 * @param capacity The max amount of images waiting to be written.
+	 */
+	FrameWriter(unsigned int threads = 2, std::size_t capacity = 8);
+
+	/**
+	 * @brief Write all pending images, and stop the threads.
+	 * 
+	 */
+	~FrameWriter();
+
+	/**
+	 * @brief Queue an image to be written.
+	 * 
+	 * @param image The image to write.
+	 * @param path The file to write it to. The format is picked from the extension.
+	 * 
+	 * @remarks Blocks while the queue is full.
+	 */
+	void push(sf::Image image, const std::string& path);
+
+	/**
+	 * @brief Wait until all queued images have been written.
+	 * 
+	 */
+	void finish();
+
+	/**
+	 * @return std::size_t The amount of images written so far.
+	 */
+	std::size_t getWritten();
+
+	/**
+	 * @return std::size_t The amount of images that failed to write.
+	 */
+	std::size_t getFailed();
+
+private:
+	/**
+	 * @brief A queued image.
+	 * 
+	 */
+	struct Job
+	{
+		sf::Image image;
+		std::string path;
+	};
+
+	/**
+	 * @brief The loop of each writer thread.
+	 * 
+	 */
+	void work();
+
+	/**
+	 * @brief The pending images.
+	 * 
+	 */
+	std::deque<Job> mQueue;
+
+	/**
+	 * @brief The max size of mQueue.
+	 * 
+	 */
+	std::size_t mCapacity;
+
+	/**
+	 * @brief Guards mQueue, mBusy & mStopping.
+	 * 
+	 */
+	std::mutex mMutex;
+
+	/**
+	 * @brief Signalled when a job is queued, and when a job is done.
+	 * 
+	 */
+	std::condition_variable mQueued, mDone;
+
+	/**
+	 * @brief The amount of jobs currently being written.
+	 * 
+	 */
+	std::size_t mBusy;
+
+	/**
+	 * @brief Set to stop the threads once the queue is empty.
+	 * 
+	 */
+	bool mStopping;
+
+	/**
+	 * @brief The writer threads.
+	 * 
+	 */
+	std::vector<std::thread> mThreads;
+
+	/**
+	 * @brief Counters of finished jobs.
+	 * 
+	 */
+	std::atomic<std::size_t> mWritten, mFailed;
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+#include "LodPyramid.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+
+/**
+ * @brief The cells drawn by InfiniteGrid, cached as vertices in square tiles of the world.
+ * Several grids can share one cache, so each view of the world only costs its own draw calls.
+ *
+ * @remarks Every cell keeps a fixed 4-vertex slot in its tile, so changing cells only rewrites
+ * & re-uploads their slots. Vertices are in cells from their tile's corner, so they stay exact as floats
+ * however far the tile is from 0,0; each tile is moved next to the view when it's drawn.
+ */
+class GridCache
+{
+public:
+	/**
+	 * @brief A cell to draw.
+	 *
+	 */
+	struct Cell
+	{
+		WorldPos pos;
+		sf::Color col;
+	};
+
+	/**
+	 * @brief The width & height of a tile, in cells.
+	 *
+	 */
+	static const int TILE_SIZE = 64;
+
+	/**
+	 * @brief Batches of fewer cells than this are built on the calling thread alone.
+	 *
+	 */
+	static const std::size_t PARALLEL_CELLS = 4096;
+
+	GridCache();
+
+	/**
+	 * @brief Either add the cell, or recolor the cell that's already there.
+	 *
+	 */
+	void setCell(const Cell& c);
+
+	/**
+	 * @brief Set many cells at once, uploading each changed tile once.
+	 *
+	 */
+	void setCells(const std::vector<Cell>& cells);
+
+	/**
+	 * @brief Remove the cell at a position, if there is one.
+	 *
+	 */
+	void clearCell(WorldPos pos);
+
+	/**
+	 * @brief Remove all cells.
+	 *
+	 */
+	void clear();
+
+	/**
+	 * @return True If there's a cell at the position.
+	 */
+	bool isCell(WorldPos pos) const;
+
+	/**
+	 * @return Cell The cell at the position, or a white cell at 0,0 if there's none.
+	 */
+	Cell getCell(WorldPos pos) const;
+
+	/**
+	 * @brief Draw the tiles that overlap part of the world.
+	 *
+	 * @param states Must transform cell coordinates, relative to the origin, to the target's.
+	 * @param visible The part of the world to draw, in cells.
+	 * @param origin The cell drawn at 0,0 of the states' transform, usually the view's corner.
+	 */
+	void draw(sf::RenderTarget& target, sf::RenderStates states, WorldRect visible, WorldPos origin) const;
+
+	/**
+	 * @return const LodPyramid& The cells summarized in blocks, to draw zoomed out views from.
+	 */
+	const LodPyramid& getPyramid() const;
+
+	/**
+	 * @return unsigned long long Counts up whenever the cells change, so views know to rebuild
+	 * what they derive from the pyramid.
+	 */
+	unsigned long long getRevision() const;
+
+	/**
+	 * @return ThreadPool& The threads vertices are built on, which grids can use for theirs too.
+	 */
+	ThreadPool& getPool();
+
+private:
+	/**
+	 * @brief A TILE_SIZE square of the world.
+	 *
+	 */
+	struct Tile
+	{
+		/**
+		 * @brief 4 vertices per slot, and the cell in each slot.
+		 *
+		 */
+		sf::VertexArray vertices;
+		std::vector<Cell> cells;
+
+		/**
+		 * @brief The vertices on the GPU, when vertex buffers are available.
+		 *
+		 */
+		sf::VertexBuffer buffer;
+
+		/**
+		 * @brief Emptied slots to reuse, and slots changed since the last upload.
+		 *
+		 */
+		std::vector<std::size_t> freeSlots, dirtySlots;
+	};
+
+	/**
+	 * @brief A cell of a batch, with the slot it was given.
+	 *
+	 */
+	struct Placed
+	{
+		Tile* tile;
+		WorldPos key;
+		std::size_t slot;
+	};
+
+	/**
+	 * @brief Find or make a cell's slot, and store the cell in it, without writing its vertices.
+	 *
+	 * @param from Set to the palette index of the cell's old color, LodPyramid::NO_COLOR if it's new.
+	 * @return Tile& The cell's tile.
+	 */
+	Tile& reserveSlot(const Cell& c, std::size_t& slot, int& from);
+
+	/**
+	 * @brief Write a slot's vertices from its cell, and mark it for upload.
+	 * Only touches the tile, so different tiles can be written by different threads at once.
+	 *
+	 * @param empty Write a zero-sized, transparent quad instead of the cell.
+	 */
+	void writeVertices(Tile& tile, std::size_t slot, bool empty = false);
+
+	/**
+	 * @brief Upload the changed slots of every changed tile.
+	 *
+	 */
+	void flush();
+
+	/**
+	 * @return WorldPos The tile a cell is in.
+	 */
+	static WorldPos getTile(WorldPos pos);
+
+	std::unordered_map<WorldPos, Tile, ::Cell::PositionHash> mTiles;
+
+	/**
+	 * @brief The slot of every cell, in its tile.
+	 *
+	 */
+	std::unordered_map<WorldPos, std::size_t, ::Cell::PositionHash> mSlots;
+
+	/**
+	 * @brief The tiles with slots to upload.
+	 *
+	 */
+	std::vector<WorldPos> mDirtyTiles;
+
+	/**
+	 * @brief Scratch space for setCells(), the slots & pyramid changes of the batch.
+	 *
+	 */
+	std::vector<Placed> mPlaced;
+	std::vector<LodPyramid::Change> mChanges;
+
+	/**
+	 * @brief See getPool().
+	 *
+	 */
+	std::unique_ptr<ThreadPool> mPool;
+
+	/**
+	 * @brief See getPyramid().
+	 *
+	 */
+	LodPyramid mPyramid;
+
+	/**
+	 * @brief If vertex buffers are available, otherwise the vertex arrays are drawn directly.
+	 *
+	 */
+	bool mUseBuffer;
+
+	/**
+	 * @brief See getRevision().
+	 *
+	 */
+	unsigned long long mRevision;
+};
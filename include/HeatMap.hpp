@@ -0,0 +1,164 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief Counts how often each cell was a head over the last few generations, to find a world's hotspots.
+ *
+ * @remarks Counts are kept in square chunks of the world, which only exist while a cell in them was a head
+ * during the window, so quiet parts of the world take no memory. Every generation only touches the cells
+ * that just became heads, and the ones that did so a window ago, which are kept to be counted back out.
+ */
+class HeatMap
+{
+public:
+	/**
+	 * @brief The length of a chunk's side, in cells.
+	 *
+	 */
+	static const int CHUNK_SIZE = 64;
+
+	/**
+	 * @brief The amount of generations counted when none is picked.
+	 *
+	 */
+	static const std::size_t DEFAULT_WINDOW = 256;
+
+	/**
+	 * @brief The counts of one chunk, row by row.
+	 *
+	 */
+	struct Chunk
+	{
+		std::uint16_t counts[CHUNK_SIZE * CHUNK_SIZE];
+
+		/**
+		 * @brief The sum of the counts.
+		 *
+		 */
+		std::uint32_t total;
+
+		/**
+		 * @brief Changes whenever a count does, and is never reused, so drawn copies know to update.
+		 *
+		 */
+		std::uint64_t version;
+	};
+
+	typedef std::unordered_map<WorldPos, std::unique_ptr<Chunk>, Cell::PositionHash> Chunks;
+
+	/**
+	 * @param window The amount of generations to count over, at most 65535.
+	 */
+	HeatMap(std::size_t window = DEFAULT_WINDOW);
+
+	/**
+	 * @brief Count a new generation, dropping the one that left the window.
+	 *
+	 * @param changed The cells the step changed, with their new type.
+	 */
+	void record(const std::vector<Cell>& changed);
+
+	/**
+	 * @brief Forget all counts.
+	 *
+	 */
+	void clear();
+
+	/**
+	 * @return std::size_t The amount of generations counted over.
+	 */
+	std::size_t getWindow() const;
+
+	/**
+	 * @return std::size_t The amount of generations counted so far, at most the window.
+	 */
+	std::size_t getLength() const;
+
+	/**
+	 * @return unsigned int How many of the counted generations the cell at a position was a head in.
+	 */
+	unsigned int getCount(WorldPos pos) const;
+
+	/**
+	 * @return float A count relative to the most a cell can have, a head every third generation.
+	 */
+	float getHeat(unsigned int count) const;
+
+	/**
+	 * @return const Chunks& Every chunk with a head in the window, by chunk coordinates.
+	 */
+	const Chunks& getChunks() const;
+
+	/**
+	 * @brief The busiest chunks, which are the ones worth splitting between threads or workers.
+	 *
+	 * @param share The part of all activity to cover, from 0 to 1.
+	 * @return std::vector<WorldPos> The fewest chunks covering it, busiest first.
+	 */
+	std::vector<WorldPos> getHotChunks(float share) const;
+
+	/**
+	 * @return std::size_t The amount of chunks getHotChunks() would return, only recounted after the counts changed.
+	 */
+	std::size_t getHotChunkCount(float share) const;
+
+	/**
+	 * @return std::size_t Roughly how much memory the counts & history take.
+	 */
+	std::size_t getMemory() const;
+
+	/**
+	 * @return WorldPos The coordinates of the chunk holding a position.
+	 */
+	static WorldPos getChunkOf(WorldPos pos);
+
+	/**
+	 * @return std::size_t Where a position is in its chunk's counts.
+	 */
+	static std::size_t getOffsetOf(WorldPos pos);
+
+private:
+	/**
+	 * @brief Add to or take from the count of a cell.
+	 *
+	 */
+	void count(WorldPos pos, int delta);
+
+	Chunks mChunks;
+
+	/**
+	 * @brief The cells that became heads, for each generation in the window, as a ring.
+	 *
+	 */
+	std::vector<std::vector<WorldPos>> mHistory;
+	std::size_t mNext, mLength;
+
+	/**
+	 * @brief The last version handed to a chunk.
+	 *
+	 */
+	std::uint64_t mVersion;
+
+	/**
+	 * @brief The last result of getHotChunkCount(), and the share & version it was counted for.
+	 *
+	 */
+	mutable std::size_t mHotCount;
+	mutable float mHotShare;
+	mutable std::uint64_t mHotVersion;
+
+	/**
+	 * @brief The chunk counted in last, and its coordinates.
+	 *
+	 */
+	Chunk* mLast;
+	WorldPos mLastKey;
+};
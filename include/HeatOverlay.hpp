@@ -0,0 +1,68 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "HeatMap.hpp"
+#include "Tracer.hpp"
+
+/**
+ * @brief Draws a HeatMap over the cells as a color ramp, from blue for rare heads to red for a head every third generation.
+ * Like GridCache, one overlay can be shared by several grids.
+ *
+ * @remarks Each chunk of counts is a small texture, one texel per cell, drawn as a single quad.
+ * A texture is only refilled when its chunk changed, and only once it's on screen.
+ */
+class HeatOverlay
+{
+public:
+	/**
+	 * @param heat The counts to draw, which must outlive the overlay.
+	 */
+	HeatOverlay(const HeatMap& heat);
+
+	/**
+	 * @brief Draw the chunks that overlap part of the world.
+	 *
+	 * @param states Must transform cell coordinates, relative to the origin, to the target's.
+	 * @param visible The part of the world to draw, in cells.
+	 * @param origin The cell drawn at 0,0 of the states' transform, as for GridCache::draw().
+	 */
+	void draw(sf::RenderTarget& target, sf::RenderStates states, WorldRect visible, WorldPos origin);
+
+	/**
+	 * @return sf::Color The ramp's color for a heat from 0 to 1.
+	 */
+	static sf::Color getColor(float heat);
+
+private:
+	/**
+	 * @brief A chunk's texture, and the version of the chunk it was filled from.
+	 *
+	 */
+	struct Entry
+	{
+		sf::Texture texture;
+		std::uint64_t version = 0;
+	};
+
+	/**
+	 * @brief Refill a texture from its chunk's counts.
+	 *
+	 */
+	void fill(Entry& entry, const HeatMap::Chunk& chunk);
+
+	const HeatMap& mHeat;
+
+	std::unordered_map<WorldPos, std::unique_ptr<Entry>, Cell::PositionHash> mEntries;
+
+	/**
+	 * @brief The pixels of the texture being filled, reused between fills.
+	 *
+	 */
+	std::vector<sf::Uint8> mPixels;
+};
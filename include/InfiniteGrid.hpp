@@ -4,10 +4,18 @@
 
 #include <algorithm>
 #include <cmath>
+#include <memory>
+#include <vector>
+
+#include "GridCache.hpp"
+#include "HeatOverlay.hpp"
+#include "LodPyramid.hpp"
+#include "Tracer.hpp"
 
 /**
  * @brief Renders an infinite grid of colored cells to the window.
  * Contains method for resizing the grid, and setting the top-left position of the grid to any point in space.
+ * The cells live in a GridCache, which several grids can share to show different parts of one world.
  * 
  */
 class InfiniteGrid : public sf::Drawable
@@ -17,18 +25,39 @@ public:
 	 * @brief The cell's data structure.
 	 * 
 	 */
-	struct Cell
-	{
-		sf::Vector2i pos;
-		sf::Color col;
-	};
+	typedef GridCache::Cell Cell;
 
 	/**
 	 * @brief Initializes the grid.
 	 * 
 	 * @param window_size The size of the window to render to.
+	 * @param cache The cells to draw, shared with other grids. nullptr to start with a cache of its own.
+	 */
+	InfiniteGrid(sf::Vector2u window_size, std::shared_ptr<GridCache> cache = nullptr);
+
+	/**
+	 * @return std::shared_ptr<GridCache> The cells drawn, to share with another grid.
 	 */
-	InfiniteGrid(sf::Vector2u window_size);
+	std::shared_ptr<GridCache> getCache();
+
+	/**
+	 * @brief Draw an overlay over the cells, like a heat map.
+	 * 
+	 * @param overlay The overlay, which may be shared with other grids. nullptr for none.
+	 */
+	void setOverlay(std::shared_ptr<HeatOverlay> overlay);
+
+	/**
+	 * @return std::shared_ptr<HeatOverlay> The overlay drawn over the cells, if any.
+	 */
+	std::shared_ptr<HeatOverlay> getOverlay();
+
+	/**
+	 * @brief Catch up with changes made to the cache through another grid.
+	 * Only the zoomed out blocks & the minimap need it; cells are drawn straight from the cache.
+	 * 
+	 */
+	void refresh();
 
 	/**
 	 * @brief Update the size of the window upon resizing.
@@ -41,33 +70,88 @@ public:
 	 * @brief Set the size of the rendered cell.
 	 * 
 	 * @param newSize The new cell size.
+	 * 
+	 * @remarks Sizes below 1 are drawn from the LOD pyramid, one block of cells per pixel.
 	 */
-	void setCellSize(int newSize);
+	void setCellSize(float newSize);
 
 	/**
 	 * @brief Get the size of each cell.
 	 * 
-	 * @return int The length of a side of a cell.
+	 * @return float The length of a side of a cell, in pixels.
+	 */
+	float getCellSize();
+
+	/**
+	 * @brief Zoom in or out one step.
+	 * Above 1px per cell, a step is one pixel, below it a step halves or doubles the size.
+	 * 
+	 * @param steps Positive to zoom in, negative to zoom out.
+	 */
+	void zoom(int steps);
+
+	/**
+	 * @brief Set the color that a zoomed out block takes if any of its cells has it.
+	 * 
+	 * @param col The color, i.e. the color of a head, so signals stay visible.
+	 */
+	void setPriorityColor(sf::Color col);
+
+	/**
+	 * @brief Show/hide a minimap of the whole grid in the top-right corner.
+	 * 
 	 */
-	int getCellSize();
+	void setMinimapVisible(bool visible);
+
+	/**
+	 * @return true If the minimap is shown.
+	 */
+	bool isMinimapVisible();
 
 	/**
 	 * @brief Set the top-left position of the grid.
 	 * 
-	 * @param newPos The position the grid should render from.
+	 * @param origin The cell in the top-left corner.
+	 * @param offset How far past the origin the corner is, in cells. Whole cells of it are moved into the origin.
 	 * 
 	 * @remarks This is in cell coords, i.e. if the cell size is 16, 16 you do not need to enter {16, 16} to get to cell {1, 1}.
 	 */
-	void setPosition(sf::Vector2f newPos);
+	void setPosition(WorldPos origin, sf::Vector2f offset = {0, 0});
 
 	/**
-	 * @brief Get the position of the grid.
+	 * @brief Move the grid's top-left position by an amount of cells.
 	 * 
-	 * @return sf::Vector2i The top-left coordinate of the (rendered) part of the grid.
+	 * @param delta The cells to move by, which only ever adds to the fraction of a cell kept as a float.
+	 */
+	void move(sf::Vector2f delta);
+
+	/**
+	 * @brief Put a cell in the middle of the grid.
 	 * 
-	 * @remarks This is in cell coords, i.e. *cell* (5, 5), and not screen coords.
 	 */
-	sf::Vector2f getPosition();
+	void centerOn(WorldPos cell);
+
+	/**
+	 * @return WorldPos The cell in the top-left corner of the grid.
+	 */
+	WorldPos getOrigin();
+
+	/**
+	 * @return sf::Vector2f How far into the origin cell the top-left corner is, from 0 to 1.
+	 */
+	sf::Vector2f getOffset();
+
+	/**
+	 * @return WorldPos The cell under a point on the grid, exact however far the grid is from 0,0.
+	 * 
+	 * @param point The point, in pixels from the grid's top-left corner.
+	 */
+	WorldPos getCellAt(sf::Vector2f point);
+
+	/**
+	 * @return WorldPos The cell in the middle of the grid.
+	 */
+	WorldPos getCenter();
 
 	/**
 	 * @brief Either push the new cell, or update the cell that already exists, if it's there.
@@ -76,6 +160,13 @@ public:
 	 */
 	void setCell(Cell c);
 
+	/**
+	 * @brief Add/update many cells at once, updating the vertex arrays only once.
+	 * 
+	 * @param cells The cells to add/update.
+	 */
+	void setCells(const std::vector<Cell>& cells);
+
 	/**
 	 * @brief Check if there's a cell at the given position.
 	 * 
@@ -83,7 +174,7 @@ public:
 	 * @return true If there is a cell there.
 	 * @return false If the square is empty.
 	 */
-	bool isCell(sf::Vector2i pos);
+	bool isCell(WorldPos pos);
 
 	/**
 	 * @brief Get the cell located at the given position.
@@ -94,14 +185,14 @@ public:
 	 * @remarks Returns a white cell @ 0,0 if there is none. 
 	 * Use isCell(pos) to check if there's a cell there in the first place.
 	 */
-	Cell getCell(sf::Vector2i pos);
+	Cell getCell(WorldPos pos);
 
 	/**
 	 * @brief Remove the cell at the given position, if it exists.
 	 * 
 	 * @param pos 
 	 */
-	void clearCell(sf::Vector2i pos);
+	void clearCell(WorldPos pos);
 
 	/**
 	 * @brief Clear the whole board.
@@ -144,6 +235,31 @@ private:
 	 */
 	void updateCells();
 
+	/**
+	 * @brief Update the grid cell vertex array from the LOD pyramid, when zoomed out below 1px per cell.
+	 * 
+	 * @remarks Costs O(min(blocks, screen pixels)), regardless of the amount of cells.
+	 */
+	void updateLodCells();
+
+	/**
+	 * @brief Update the minimap vertex array.
+	 * 
+	 */
+	void updateMinimap();
+
+	/**
+	 * @brief Append a colored axis-aligned quad to a vertex array.
+	 * 
+	 */
+	static void appendQuad(sf::VertexArray& arr, sf::Vector2f pos, sf::Vector2f size, sf::Color col);
+
+	/**
+	 * @brief Write a colored axis-aligned quad to 4 vertices.
+	 * 
+	 */
+	static void setQuad(sf::Vertex* quad, sf::Vector2f pos, sf::Vector2f size, sf::Color col);
+
 	/**
 	 * @brief The grid line vertex array.
 	 * 
@@ -159,31 +275,78 @@ private:
 	sf::Transform mGridLineTransform;
 
 	/**
-	 * @brief The vertex array for grid cells.
+	 * @brief Moves & scales the cached cells onto the screen, so panning & zooming don't touch the cache.
+	 * 
+	 */
+	sf::Transform mGridCellTransform;
+
+	/**
+	 * @brief The vertex array for zoomed out blocks, rebuilt from the LOD pyramid.
+	 * 
+	 */
+	sf::VertexArray mLodCells;
+
+	/**
+	 * @brief The blocks drawn in mLodCells, in order, and the blocks found by each band of rows.
 	 * 
 	 */
-	sf::VertexArray mGridCells;
+	std::vector<const LodPyramid::Level::value_type*> mVisibleBlocks;
+	std::vector<std::vector<const LodPyramid::Level::value_type*>> mBands;
 
 	/**
-	 * @brief All cells to draw.
+	 * @brief The cells, maybe shared with other grids.
 	 * 
 	 */
-	std::vector<Cell> mCells;
+	std::shared_ptr<GridCache> mCache;
+
+	/**
+	 * @brief See setOverlay().
+	 * 
+	 */
+	std::shared_ptr<HeatOverlay> mOverlay;
+
+	/**
+	 * @brief The cache's revision that the blocks & minimap were last built from.
+	 * 
+	 */
+	unsigned long long mCacheRevision;
+
+	/**
+	 * @brief The color that wins when summarizing a block.
+	 * 
+	 */
+	sf::Color mPriorityColor;
+
+	/**
+	 * @brief The minimap vertex array.
+	 * 
+	 */
+	sf::VertexArray mMinimap;
+
+	/**
+	 * @brief Whether the minimap is shown.
+	 * 
+	 */
+	bool mMinimapVisible;
 
 	/**
 	 * @brief The size of each cell to render.
 	 * 
 	 */
-	int mCellSize;
+	float mCellSize;
 
 	/**
-	 * @brief Grid position, by cells.
+	 * @brief Grid position, by cells: the cell in the top-left corner, and how far into it the corner is.
 	 * A.K.A
-	 * mCellSize = 16, mPosition = {1, 1}
-	 * actual position = {16, 16}
+	 * mCellSize = 16, mOrigin = {1, 1}, mOffset = {0.5, 0}
+	 * actual position = {24, 16}
+	 * 
+	 * @remarks Only the offset is a float, and it stays below 1, so the view is as precise far from 0,0 as near it.
+	 * Everything drawn is placed relative to the origin.
 	 * 
 	 */
-	sf::Vector2f mPosition;
+	WorldPos mOrigin;
+	sf::Vector2f mOffset;
 
 	/**
 	 * @brief The size of the window to render to.
@@ -200,4 +363,10 @@ private:
 	 * 
 	 */
 	sf::Color mLineColor;
+
+	/**
+	 * @brief The length of a side of the minimap, in pixels.
+	 * 
+	 */
+	const float MINIMAP_SIZE = 160;
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <SFML/Window.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Records the app's input, frame by frame, to a plain text log, and reads it back.
+ * 
+ * @remarks A frame is written as `F <dt in microseconds> <mouse x> <mouse y> <event count>`,
+ * followed by one `E <event type> <fields...>` line per event. Lines starting with '#' are comments.
+ * Only the events the app reacts to are kept.
+ */
+class InputLog
+{
+public:
+	/**
+	 * @brief Everything the app read from the window during one frame.
+	 * 
+	 */
+	struct Frame
+	{
+		sf::Time dt;
+		sf::Vector2i mouse;
+		std::vector<sf::Event> events;
+	};
+
+	/**
+	 * @brief Start writing a new log.
+	 * 
+	 * @param path The file to write to. Overwritten if it exists.
+	 * @return true If the file was opened.
+	 */
+	bool openWrite(const std::string& path);
+
+	/**
+	 * @brief Open an existing log to replay.
+	 * 
+	 * @param path The file to read.
+	 * @return true If the file was opened.
+	 */
+	bool openRead(const std::string& path);
+
+	/**
+	 * @brief Append a frame to the log.
+	 * 
+	 * @param frame The frame. Unsupported events are skipped.
+	 */
+	void write(const Frame& frame);
+
+	/**
+	 * @brief Read the next frame of the log.
+	 * 
+	 * @param frame Filled with the frame.
+	 * @return false Once the log is exhausted, or on a malformed line.
+	 */
+	bool read(Frame& frame);
+
+	/**
+	 * @return True If the event is one that gets recorded.
+	 */
+	static bool isRecorded(const sf::Event& event);
+
+private:
+	/**
+	 * @brief The log being written.
+	 * 
+	 */
+	std::ofstream mOut;
+
+	/**
+	 * @brief The log being replayed.
+	 * 
+	 */
+	std::ifstream mIn;
+
+	/**
+	 * @brief Read the next line that isn't a comment.
+	 * 
+	 */
+	bool nextLine(std::string& line);
+};
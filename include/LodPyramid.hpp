@@ -0,0 +1,139 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief A pyramid of per-block summaries of a grid of colored cells, for drawing it zoomed out.
+ * Level k summarizes blocks of 2^k by 2^k cells, and is kept up to date cell by cell,
+ * so a change costs O(LEVELS), and drawing a level never has to look at single cells.
+ * 
+ */
+class LodPyramid
+{
+public:
+	/**
+	 * @brief The amount of levels, the coarsest one has blocks of 2^LEVELS cells a side.
+	 * 
+	 */
+	static constexpr int LEVELS = 12;
+
+	/**
+	 * @brief The max amount of distinct colors counted per block.
+	 * Any colors past that are counted as the last one.
+	 * 
+	 */
+	static constexpr int PALETTE_SIZE = 8;
+
+	/**
+	 * @brief The summary of one block.
+	 * 
+	 */
+	struct Summary
+	{
+		unsigned int total = 0;
+		unsigned int counts[PALETTE_SIZE] = {};
+	};
+
+	/**
+	 * @brief A cell being added, recolored or removed, with its old & new colors as palette indices.
+	 * 
+	 */
+	struct Change
+	{
+		WorldPos pos;
+		int from, to;
+	};
+
+	/**
+	 * @brief The color index of a cell that isn't there, before it's added or after it's removed.
+	 * 
+	 */
+	static constexpr int NO_COLOR = -1;
+
+	/**
+	 * @brief All non-empty blocks of one level, by block position.
+	 * 
+	 */
+	typedef std::unordered_map<WorldPos, Summary, Cell::PositionHash> Level;
+
+	/**
+	 * @brief Count a new cell.
+	 * 
+	 * @param pos The cell's position.
+	 * @param col The cell's color.
+	 */
+	void add(WorldPos pos, sf::Color col);
+
+	/**
+	 * @brief Stop counting a cell.
+	 * 
+	 * @param pos The cell's position.
+	 * @param col The color the cell was counted with.
+	 */
+	void remove(WorldPos pos, sf::Color col);
+
+	/**
+	 * @brief Apply many changes to one level.
+	 * Only touches that level, so several levels can be updated by different threads at once.
+	 * @param level The level, from 1 to LEVELS.
+	 */
+	void apply(const std::vector<Change>& changes, int level);
+
+	/**
+	 * @brief Get the palette index of a color, adding it if there's space, for a Change.
+	 * 
+	 */
+	int getColorIndex(sf::Color col);
+
+	/**
+	 * @brief Remove all cells.
+	 * 
+	 */
+	void clear();
+
+	/**
+	 * @brief Get all blocks of a level.
+	 * 
+	 * @param level The level, from 1 to LEVELS.
+	 */
+	const Level& getLevel(int level) const;
+
+	/**
+	 * @brief Get the color a block should be drawn with.
+	 * 
+	 * @param summary The block.
+	 * @param level The block's level.
+	 * @param priority If any cell in the block has this color, the block gets it, 
+	 * no matter how many cells of other colors there are.
+	 * @return sf::Color The priority or most common color, more transparent the emptier the block is.
+	 */
+	sf::Color getColor(const Summary& summary, int level, sf::Color priority) const;
+
+	/**
+	 * @brief Get the approximate bounds of all cells.
+	 * 
+	 * @param bounds Set to the bounding box of all cells, rounded out to the blocks of a fine level.
+	 * @return false If there are no cells.
+	 */
+	bool getBounds(WorldRect& bounds) const;
+
+private:
+	/**
+	 * @brief The colors counted so far.
+	 * 
+	 */
+	std::vector<sf::Color> mPalette;
+
+	/**
+	 * @brief The levels, mLevels[0] being level 1.
+	 * 
+	 */
+	Level mLevels[LEVELS];
+};
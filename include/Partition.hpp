@@ -0,0 +1,111 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief A vertical strip of the world, simulated independently of the rest of it.
+ * The cells just outside of the strip's left & right edges are supplied each generation
+ * as a one-cell-wide halo of heads, which is all Cell::step needs to know about them.
+ * 
+ */
+class Partition
+{
+public:
+	/**
+	 * @brief Construct a new partition.
+	 * 
+	 * @param left The first column of the strip.
+	 * @param right One past the last column of the strip.
+	 * 
+	 * @remarks The default partition spans the whole world.
+	 */
+	Partition(sf::Int64 left = INT64_MIN, sf::Int64 right = INT64_MAX);
+
+	/**
+	 * @brief Check if a position lies within the strip.
+	 * 
+	 * @param pos The position to check.
+	 */
+	bool contains(WorldPos pos);
+
+	/**
+	 * @brief Add a cell to the partition, or update the one at its position.
+	 * 
+	 * @param c The cell, which must lie inside the strip.
+	 */
+	void setCell(Cell c);
+
+	/**
+	 * @brief Get the y coordinate of every head on one edge of the strip.
+	 * 
+	 * @param leftEdge True for the leftmost column, false for the rightmost.
+	 * @return std::vector<sf::Int64> The rows with a head in them.
+	 */
+	std::vector<sf::Int64> getEdgeHeads(bool leftEdge);
+
+	/**
+	 * @brief Set the heads just outside one edge of the strip, for the next step.
+	 * 
+	 * @param leftEdge True for the column left of the strip, false for the one right of it.
+	 * @param rows The rows with a head in them.
+	 */
+	void setHalo(bool leftEdge, const std::vector<sf::Int64>& rows);
+
+	/**
+	 * @brief Advance the partition one generation, using the current halo.
+	 * 
+	 */
+	void step();
+
+	/**
+	 * @return std::vector<Cell>& All cells in the partition.
+	 */
+	std::vector<Cell>& getCells();
+
+	/**
+	 * @return sf::Int64 The first column of the strip.
+	 */
+	sf::Int64 getLeft();
+
+	/**
+	 * @return sf::Int64 One past the last column of the strip.
+	 */
+	sf::Int64 getRight();
+
+private:
+	/**
+	 * @brief The strip's bounds, [mLeft, mRight).
+	 * 
+	 */
+	sf::Int64 mLeft, mRight;
+
+	/**
+	 * @brief The cells of the strip.
+	 * 
+	 */
+	std::vector<Cell> mCells;
+
+	/**
+	 * @brief Maps positions to indices in mCells.
+	 * 
+	 */
+	std::unordered_map<WorldPos, std::size_t, Cell::PositionHash> mIndex;
+
+	/**
+	 * @brief Indices of the cells in the leftmost & rightmost columns.
+	 * 
+	 */
+	std::vector<std::size_t> mLeftEdge, mRightEdge;
+
+	/**
+	 * @brief The head cells just outside of the strip.
+	 * 
+	 */
+	std::unordered_map<WorldPos, Cell, Cell::PositionHash> mHalo;
+};
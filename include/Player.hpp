@@ -0,0 +1,114 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <iomanip>
+#include <sstream>
+
+#include "InfiniteGrid.hpp"
+#include "RunReader.hpp"
+#include "Wireworld.hpp"
+
+/**
+ * @brief Plays back a run recorded with `--record-run`, at any speed, forwards or backwards,
+ * without simulating anything. Only the cells that changed between the generations shown are sent to the grid.
+ *
+ */
+class Player
+{
+public:
+	/**
+	 * @brief The slowest & fastest playback speeds, in generations per second.
+	 *
+	 */
+	static constexpr float MIN_SPEED = 1;
+	static constexpr float MAX_SPEED = 1 << 20;
+
+	Player();
+
+	/**
+	 * @brief Open a recording, and show its first generation.
+	 *
+	 * @return true If it could be read.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * @brief Main player loop.
+	 *
+	 * @return int Exit code of the program.
+	 */
+	int run();
+
+private:
+	/**
+	 * @brief Handle a single window event.
+	 *
+	 */
+	void handleEvent(const sf::Event& event);
+
+	/**
+	 * @brief Move as many generations as the speed asks for, in the direction of playback.
+	 *
+	 */
+	void advance(sf::Time dt);
+
+	/**
+	 * @brief Show another generation. Far away ones are jumped to, rather than played through.
+	 *
+	 */
+	void seek(long long generation);
+
+	/**
+	 * @brief Update the displayed text.
+	 *
+	 */
+	void updateHUD();
+
+	/**
+	 * @brief The player window.
+	 *
+	 */
+	sf::RenderWindow mWindow;
+
+	/**
+	 * @brief Renders the recorded cells.
+	 *
+	 */
+	InfiniteGrid mGrid;
+
+	RunReader mReader;
+
+	/**
+	 * @brief Playback speed, in generations per second, and the fraction of a generation left over from the last frame.
+	 *
+	 */
+	float mSpeed;
+	double mPending;
+
+	bool mPlaying, mBackwards;
+
+	/**
+	 * @brief Text displayed in the top-left corner.
+	 *
+	 */
+	sf::Text mHUD;
+
+	/**
+	 * @brief The HUD's font.
+	 *
+	 */
+	sf::Font mHUDFont;
+
+	/**
+	 * @brief Stores info while the middle-mouse button is held (window panning)
+	 *
+	 */
+	struct
+	{
+		bool mouseHeld = false;
+		sf::Vector2f initialMouse;
+		WorldPos initialOrigin;
+		sf::Vector2f initialOffset;
+	} mMousePan;
+};
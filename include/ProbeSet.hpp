@@ -0,0 +1,150 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+
+/**
+ * @brief Named probes on cells, each recording the cell's state every generation
+ * into a fixed-size ring buffer, like a logic analyzer.
+ * 
+ */
+class ProbeSet
+{
+public:
+	/**
+	 * @brief The amount of generations kept per probe.
+	 * 
+	 */
+	static const std::size_t HISTORY = 4096;
+
+	/**
+	 * @brief One probe, and its recorded states.
+	 * 
+	 */
+	struct Probe
+	{
+		std::string name;
+		WorldPos pos;
+		std::vector<std::uint8_t> ring;
+	};
+
+	/**
+	 * @brief Init an empty probe set.
+	 * 
+	 */
+	ProbeSet();
+
+	/**
+	 * @brief Attach a probe to a cell. Its history starts out as NONE.
+	 * 
+	 * @param name The probe's name, used in the panel & exports.
+	 * @param pos The probed cell.
+	 */
+	void add(const std::string& name, WorldPos pos);
+
+	/**
+	 * @brief Remove the probe on a cell.
+	 * 
+	 * @return true If there was one.
+	 */
+	bool remove(WorldPos pos);
+
+	/**
+	 * @brief Add a probe on a cell with the next free name, or remove the one there.
+	 * 
+	 */
+	void toggle(WorldPos pos);
+
+	/**
+	 * @brief Remove all probes, and their history.
+	 * 
+	 */
+	void clear();
+
+	/**
+	 * @brief Record every probe's state for a new generation.
+	 * 
+	 * @param generation The generation just reached.
+	 * @param lookup Gets the type of the cell at a position.
+	 * 
+	 * @remarks O(#probes), only the probed cells are looked up.
+	 */
+	void record(unsigned long long generation, const std::function<Cell::Type(WorldPos)>& lookup);
+
+	/**
+	 * @return const std::vector<Probe>& All probes.
+	 */
+	const std::vector<Probe>& getProbes() const;
+
+	/**
+	 * @return std::size_t The amount of generations recorded & still kept, at most HISTORY.
+	 */
+	std::size_t getLength() const;
+
+	/**
+	 * @return unsigned long long The generation of the oldest kept sample.
+	 */
+	unsigned long long getFirstGeneration() const;
+
+	/**
+	 * @brief Get a recorded state.
+	 * 
+	 * @param probe The probe's index.
+	 * @param i The sample, from 0 (oldest kept) to getLength() - 1 (newest).
+	 */
+	Cell::Type getSample(std::size_t probe, std::size_t i) const;
+
+	/**
+	 * @brief Export the kept history as CSV: one row per generation, one column per probe,
+	 * with states written as in pattern files ('.' for empty).
+	 * 
+	 * @return true If the file was written.
+	 */
+	bool saveCsv(const std::string& path) const;
+
+	/**
+	 * @brief Export the kept history as a VCD waveform, one 1-bit wire per probe,
+	 * high while its cell is a head. One generation is one time unit.
+	 * 
+	 * @return true If the file was written.
+	 */
+	bool saveVcd(const std::string& path) const;
+
+private:
+	/**
+	 * @brief The probes.
+	 * 
+	 */
+	std::vector<Probe> mProbes;
+
+	/**
+	 * @brief Where the next sample goes in every ring.
+	 * 
+	 */
+	std::size_t mHead;
+
+	/**
+	 * @brief The amount of samples recorded in total.
+	 * 
+	 */
+	unsigned long long mRecorded;
+
+	/**
+	 * @brief The generation of the newest sample.
+	 * 
+	 */
+	unsigned long long mLastGeneration;
+
+	/**
+	 * @brief The number used for the next auto-named probe.
+	 * 
+	 */
+	unsigned int mNextName;
+};
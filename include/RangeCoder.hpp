@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief An adaptive binary range coder, for packing streams of small integers close to their entropy.
+ *
+ * @remarks Integers are coded as their bit length in unary, then the bits below the top one. The length bits
+ * and the first few bits below the top one adapt to what was coded so far, the rest are stored as they are.
+ * Encoder & decoder must walk the same models with the same contexts.
+ */
+class RangeCoder
+{
+public:
+	/**
+	 * @brief How many contexts an IntModel tells apart.
+	 *
+	 */
+	static const std::size_t CONTEXTS = 8;
+
+	/**
+	 * @brief Integers coded with one IntModel are assumed to share a distribution, per context.
+	 *
+	 */
+	struct IntModel
+	{
+		IntModel();
+
+		/**
+		 * @brief The odds of each unary length bit, and of the 3 bits below the top one, per length.
+		 *
+		 */
+		std::uint16_t length[CONTEXTS][65];
+		std::uint16_t high[65][8];
+	};
+
+	class Encoder
+	{
+	public:
+		Encoder();
+
+		/**
+		 * @brief Code one bit, with odds that follow the bits coded with them.
+		 *
+		 */
+		void encodeBit(std::uint16_t& prob, unsigned int bit);
+
+		/**
+		 * @brief Code the lowest `bits` bits of `value` as they are.
+		 *
+		 */
+		void encodeDirect(std::uint64_t value, unsigned int bits);
+
+		/**
+		 * @param context Below CONTEXTS, typically picked from what was coded before.
+		 */
+		void encode(IntModel& model, std::uint64_t value, std::size_t context = 0);
+
+		/**
+		 * @brief Flush what's pending; nothing can be coded after that.
+		 *
+		 * @return const std::string& Everything coded.
+		 */
+		const std::string& finish();
+
+	private:
+		void shiftLow();
+
+		std::uint64_t mLow;
+		std::uint32_t mRange;
+		std::uint8_t mCache;
+		std::uint64_t mCacheSize;
+		std::string mOut;
+	};
+
+	class Decoder
+	{
+	public:
+		Decoder(const char* data, std::size_t size);
+
+		unsigned int decodeBit(std::uint16_t& prob);
+		std::uint64_t decodeDirect(unsigned int bits);
+		std::uint64_t decode(IntModel& model, std::size_t context = 0);
+
+		/**
+		 * @return true If more was decoded than was coded, meaning the data is damaged.
+		 */
+		bool isOverrun() const;
+
+	private:
+		std::uint8_t next();
+		void normalize();
+
+		const unsigned char* mData;
+		std::size_t mSize, mPos;
+		std::uint32_t mRange, mCode;
+	};
+};
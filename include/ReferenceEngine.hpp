@@ -0,0 +1,19 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "SimulationEngine.hpp"
+
+/**
+ * @brief The reference engine. Every cell gathers its neighbors and runs Cell::step,
+ * exactly like Wireworld always has. Slow, but obviously correct,
+ * so it's what all other engines are checked against.
+ * 
+ */
+class ReferenceEngine : public SimulationEngine
+{
+public:
+	virtual std::string getName() const;
+
+	virtual void step(CellStore& cells, std::vector<Cell>& changed);
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+#include "RangeCoder.hpp"
+#include "RunWriter.hpp"
+
+/**
+ * @brief Plays back a run recorded by RunWriter, to any generation, forwards or backwards, without stepping it again.
+ *
+ * @remarks Only the layout, the current heads & tails, and the seek positions are kept in memory.
+ * Any generation is its own heads and the ones of the generation before, so moving a single generation
+ * decodes one record, and jumping decodes two, after walking from the closest seek position.
+ */
+class RunReader
+{
+public:
+	RunReader();
+
+	/**
+	 * @brief Open a recording, at generation 0.
+	 *
+	 * @return true If it's a recording, with at least generation 0 complete.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * @brief Move to another generation.
+	 *
+	 * @param generation Clamped to the recorded ones.
+	 * @return true If it could be read.
+	 */
+	bool seek(unsigned long long generation);
+
+	/**
+	 * @return const std::vector<Cell>& The cells the last seek changed, with their new type.
+	 */
+	const std::vector<Cell>& getChanged() const;
+
+	/**
+	 * @return std::vector<Cell> The whole world at the current generation.
+	 */
+	std::vector<Cell> getCells() const;
+
+	unsigned long long getGeneration() const;
+
+	/**
+	 * @return unsigned long long The last generation recorded.
+	 */
+	unsigned long long getGenerations() const;
+
+	/**
+	 * @return bool If the recording was cut short, and its records had to be found by reading through it.
+	 */
+	bool isIncomplete() const;
+
+	/**
+	 * @return std::uint64_t The size of the file.
+	 */
+	std::uint64_t getBytes() const;
+
+private:
+	/**
+	 * @brief Read the layout, numbering the cells like the writer did.
+	 *
+	 */
+	bool readLayout(const RunWriter::Header& header);
+
+	/**
+	 * @brief Find the records of a recording that wasn't finished, up to the first one cut short.
+	 *
+	 */
+	void scanRecords(std::uint64_t start);
+
+	/**
+	 * @brief Decode a record, generation `record - 1`'s heads.
+	 *
+	 * @param cells Filled with the numbers of the cells, sorted.
+	 */
+	bool readRecord(std::uint64_t record, std::vector<std::uint32_t>& cells);
+
+	/**
+	 * @return std::uint64_t Where a record starts, walking from the closest position known, 0 if it couldn't be read.
+	 */
+	std::uint64_t locate(std::uint64_t record);
+
+	/**
+	 * @brief Read a record's length, at the start of it, or at the end of it.
+	 *
+	 */
+	bool readLength(std::uint64_t offset, std::uint32_t& length);
+
+	std::ifstream mFile;
+	std::uint64_t mBytes;
+
+	/**
+	 * @brief The layout, by cell number, and the current type of each cell.
+	 *
+	 */
+	std::vector<WorldPos> mPositions;
+	std::vector<Cell::Type> mTypes;
+
+	/**
+	 * @brief The heads & tails of the current generation.
+	 *
+	 */
+	std::vector<std::uint32_t> mHeads, mTails;
+
+	/**
+	 * @brief Where every mSeekInterval-th record starts.
+	 *
+	 */
+	std::vector<std::uint64_t> mSeeks;
+	std::uint64_t mSeekInterval;
+
+	std::uint64_t mRecords;
+	unsigned long long mGeneration;
+	bool mIncomplete;
+
+	/**
+	 * @brief The last record read, and where it starts, to walk to its neighbors from.
+	 *
+	 */
+	std::uint64_t mCursor, mCursorOffset;
+
+	std::vector<Cell> mChanged;
+};
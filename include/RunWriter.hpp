@@ -0,0 +1,129 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+#include "RangeCoder.hpp"
+
+/**
+ * @brief Records a whole run to a file: the layout & signals it started from, then what changed every generation,
+ * streamed out as it's stepped, so memory doesn't grow with the length of the run. RunReader plays it back.
+ *
+ * @remarks Heads always turn into tails, and tails into wire, so a generation is fully described by its heads
+ * and the previous generation's. Each generation is recorded as just the cells that became heads,
+ * as gaps between their numbers in the sorted layout, range coded.
+ *
+ * The file is a header, the layout, then one record per generation, starting with the tails & heads of
+ * generation 0. Records carry their length before & after them, so they can be walked either way, and the
+ * position of every SEEK_INTERVAL-th record is listed at the end. A run cut short is still readable,
+ * up to the last complete record.
+ */
+class RunWriter
+{
+public:
+	/**
+	 * @brief How many records apart the positions listed for seeking are.
+	 *
+	 */
+	static const std::uint32_t SEEK_INTERVAL = 256;
+
+	/**
+	 * @brief The start of the file. `seeks` is where the seek positions start, 0 while the run is being recorded.
+	 *
+	 */
+	struct Header
+	{
+		char magic[4];
+		std::uint32_t seekInterval;
+		std::uint64_t cells, records, seeks, layoutBytes;
+	};
+
+	RunWriter();
+
+	/**
+	 * @brief Finish the file, if it wasn't yet.
+	 *
+	 */
+	~RunWriter();
+
+	/**
+	 * @brief Start a recording.
+	 *
+	 * @param path The file to write to. Overwritten if it exists.
+	 * @param cells The world at generation 0. The layout can't change during the run.
+	 * @return true If the file was created.
+	 */
+	bool open(const std::string& path, const std::vector<Cell>& cells);
+
+	/**
+	 * @brief Record the next generation.
+	 *
+	 * @param changed The cells the step changed, with their new type, as returned by Simulation::step().
+	 */
+	void write(const std::vector<Cell>& changed);
+
+	/**
+	 * @brief Write the seek positions & complete the header.
+	 *
+	 * @return true If everything was written.
+	 */
+	bool finish();
+
+	/**
+	 * @return unsigned long long The amount of generations recorded after generation 0.
+	 */
+	unsigned long long getGenerations() const;
+
+	/**
+	 * @return std::uint64_t The size of the file so far.
+	 */
+	std::uint64_t getBytes() const;
+
+	/**
+	 * @brief Gaps between heads are coded depending on the size of the gap before, since heads come in bunches.
+	 *
+	 * @return std::size_t The context to code the gap after `previous` with.
+	 */
+	static std::size_t getGapContext(std::uint64_t previous);
+
+private:
+	/**
+	 * @brief Append a record of the cells with the given numbers, sorted.
+	 *
+	 */
+	void writeRecord(const std::vector<std::uint32_t>& cells);
+
+	std::ofstream mFile;
+
+	/**
+	 * @brief The number of each cell, its place in the layout sorted by row, then column.
+	 *
+	 */
+	std::unordered_map<WorldPos, std::uint32_t, Cell::PositionHash> mNumbers;
+
+	/**
+	 * @brief Where every SEEK_INTERVAL-th record starts.
+	 *
+	 */
+	std::vector<std::uint64_t> mSeeks;
+
+	std::uint64_t mRecords, mBytes;
+
+	/**
+	 * @brief If finish() was called, or there's no file.
+	 *
+	 */
+	bool mFinished;
+
+	/**
+	 * @brief The heads of the generation being recorded, reused between generations.
+	 *
+	 */
+	std::vector<std::uint32_t> mHeads;
+};
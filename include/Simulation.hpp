@@ -0,0 +1,281 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+#include "CellLayout.hpp"
+#include "CellStore.hpp"
+#include "CompileCache.hpp"
+#include "HeatMap.hpp"
+#include "ProbeSet.hpp"
+#include "SimulationEngine.hpp"
+#include "Tracer.hpp"
+#include "WorldFile.hpp"
+
+/**
+ * @brief A headless Wireworld world: the cells, the engine stepping them, and the probes watching them.
+ * 
+ * @remarks Only depends on SFML's system module, so tools & services can step worlds without a window.
+ */
+class Simulation
+{
+public:
+	/**
+	 * @brief The engine used when none is picked.
+	 * 
+	 */
+	static constexpr const char* DEFAULT_ENGINE = "compiled";
+
+	/**
+	 * @brief The cells are put back in curve order once more than 1 in this many were added or moved since.
+	 * 
+	 */
+	static const std::size_t REORDER_SHARE = 8;
+
+	/**
+	 * @brief Construct an empty world.
+	 * 
+	 * @param engine The name of the simulation engine to use.
+	 */
+	Simulation(const std::string& engine = DEFAULT_ENGINE);
+
+	/**
+	 * @brief Switch the engine used to step the world.
+	 * 
+	 * @param name The name of the engine, see SimulationEngine::getNames().
+	 * @return true If the engine exists, false if the current one was kept.
+	 */
+	bool setEngine(const std::string& name);
+
+	/**
+	 * @return std::string The name of the current engine.
+	 */
+	std::string getEngine();
+
+	/**
+	 * @brief Advance the world one generation, and sample the probes.
+	 * 
+	 * @return const std::vector<Cell>& The cells whose type changed, with their new type.
+	 */
+	const std::vector<Cell>& step();
+
+	/**
+	 * @brief Advance the world several generations, e.g. all the ones due before the next frame.
+	 * Engines with their own state only write the cells once, unless probes or the heat map
+	 * need to see every generation.
+	 * 
+	 * @return const std::vector<Cell>& The cells whose type changed, with their new type.
+	 * A cell can be listed more than once, the last time with its type now.
+	 */
+	const std::vector<Cell>& advance(std::size_t generations);
+
+	/**
+	 * @brief Either add the cell, or update the cell that already exists there.
+	 * 
+	 */
+	void setCell(Cell c);
+
+	/**
+	 * @brief Add or update many cells at once.
+	 * 
+	 */
+	void setCells(const std::vector<Cell>& cells);
+
+	/**
+	 * @brief Remove the cell at the given position, if it exists.
+	 * 
+	 */
+	void clearCell(WorldPos pos);
+
+	/**
+	 * @brief Remove all cells.
+	 * 
+	 */
+	void clear();
+
+	/**
+	 * @return True If there's a cell at the given position.
+	 */
+	bool isCell(WorldPos pos);
+
+	/**
+	 * @return Cell The cell at the given position. A NONE cell @ 0,0 if there is none.
+	 */
+	Cell getCell(WorldPos pos);
+
+	/**
+	 * @return std::vector<Cell> The cells inside a region, e.g. to send a viewer a keyframe.
+	 */
+	std::vector<Cell> getCellsIn(WorldRect region);
+
+	/**
+	 * @return const CellStore& All cells. Copy it for an O(1) snapshot.
+	 */
+	const CellStore& getCells();
+
+	/**
+	 * @return std::size_t The amount of cells that can never carry a signal, which the engine skips.
+	 * Known once the world has been stepped since the last edit.
+	 */
+	std::size_t getPrunedCells();
+
+	/**
+	 * @return std::size_t The amount of cells the engine steps as part of a recognized circuit part.
+	 * Known once the world has been stepped since the last edit.
+	 */
+	std::size_t getNativeCells();
+
+	/**
+	 * @brief Pick the order the cells are stored & stepped in, and reorder them right away.
+	 * 
+	 * @remarks Edits add cells at the end, so the order is restored by the first step after enough of them.
+	 * The engine recompiles then, as it would have anyway after the edits. That waits while a snapshot
+	 * shares the cells, and doesn't happen while paging, since it'd rewrite chunks the order barely changed.
+	 */
+	void setLayout(CellLayout::Curve curve);
+
+	/**
+	 * @return CellLayout::Curve The order the cells are kept in.
+	 */
+	CellLayout::Curve getLayout();
+
+	/**
+	 * @brief Put the cells in the layout's order now, rather than after enough edits.
+	 * Only chunks with cells that moved are written.
+	 * 
+	 */
+	void reorder();
+
+	/**
+	 * @brief Page cold parts of the world out to a file, to keep memory use under a cap.
+	 * Chunks of cells with signals in them always stay in memory.
+	 * 
+	 * @param path The page file, truncated. Empty to stop paging.
+	 * @param maxResidentBytes Roughly how much memory the cells may take up.
+	 * @return true If the file could be created.
+	 */
+	bool setPaging(const std::string& path, std::size_t maxResidentBytes);
+
+	/**
+	 * @brief Keep what engines compile from the layout in a directory, so loading the same world again is quicker.
+	 * 
+	 * @param directory The cache's directory, created if needed. Empty to stop caching.
+	 * @param maxBytes How much the cache may take up, the least recently used entries are deleted past that.
+	 * @return true If the directory could be created.
+	 */
+	bool setCache(const std::string& directory, std::uintmax_t maxBytes);
+
+	/**
+	 * @return const CompileCache* The compile cache, or nullptr if there isn't one.
+	 */
+	const CompileCache* getCache();
+
+	/**
+	 * @return unsigned long long The amount of generations stepped so far.
+	 */
+	unsigned long long getGeneration();
+
+	/**
+	 * @return ProbeSet& The probes, sampled after every step.
+	 */
+	ProbeSet& getProbes();
+
+	/**
+	 * @brief Start or stop counting how often each cell is a head, see HeatMap.
+	 * 
+	 * @param window The amount of generations to count over. 0 stops counting, and frees the counts.
+	 */
+	void setHeatMap(std::size_t window);
+
+	/**
+	 * @return const HeatMap* The counts, updated after every step, or nullptr while not counting.
+	 */
+	const HeatMap* getHeatMap();
+
+	/**
+	 * @brief Replace the world with a pattern file.
+	 * 
+	 * @return true If the file was read successfully.
+	 */
+	bool load(const std::string& path);
+
+	/**
+	 * @brief Write the world to a pattern file.
+	 * 
+	 * @return true If the file was written successfully.
+	 */
+	bool save(const std::string& path);
+
+private:
+	/**
+	 * @brief The cells, in chunks that snapshots can share.
+	 * 
+	 */
+	CellStore mCells;
+
+	/**
+	 * @brief Maps positions to indices in mCells.
+	 * 
+	 */
+	std::unordered_map<WorldPos, std::size_t, Cell::PositionHash> mIndex;
+
+	/**
+	 * @brief See setLayout(), and the amount of cells added or moved since the cells were last in its order.
+	 * 
+	 */
+	CellLayout::Curve mLayout;
+	std::size_t mDisordered;
+
+	/**
+	 * @brief Steps mCells forward.
+	 * 
+	 */
+	std::unique_ptr<SimulationEngine> mEngine;
+
+	/**
+	 * @brief See setCache(), handed to every engine.
+	 * 
+	 */
+	std::shared_ptr<CompileCache> mCache;
+
+	/**
+	 * @brief The cells changed by the last step.
+	 * 
+	 */
+	std::vector<Cell> mChanged;
+
+	/**
+	 * @brief The amount of generations stepped so far.
+	 * 
+	 */
+	unsigned long long mGeneration;
+
+	/**
+	 * @brief The probed cells.
+	 * 
+	 */
+	ProbeSet mProbes;
+
+	/**
+	 * @brief See setHeatMap().
+	 * 
+	 */
+	std::unique_ptr<HeatMap> mHeat;
+
+	/**
+	 * @brief Add or update a cell, without invalidating the engine.
+	 * 
+	 */
+	void put(const Cell& c);
+
+	/**
+	 * @brief Reorder the cells if enough were added or moved, see setLayout().
+	 * 
+	 */
+	void reorderIfDue();
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+#include "CellStore.hpp"
+#include "CompileCache.hpp"
+
+/**
+ * @brief Steps a world of cells forward one generation.
+ * Engines may cache whatever they derive from the layout of the world between steps,
+ * so whoever owns the cells has to call invalidate() after editing them.
+ * 
+ */
+class SimulationEngine
+{
+public:
+	virtual ~SimulationEngine() = default;
+
+	/**
+	 * @return std::string The name the engine is picked by.
+	 */
+	virtual std::string getName() const = 0;
+
+	/**
+	 * @brief Called after the cells were edited outside of step(),
+	 * so any state derived from them is stale.
+	 * 
+	 */
+	virtual void invalidate();
+
+	/**
+	 * @brief Advance the cells one generation, in place.
+	 * 
+	 * @param cells The world. Must not be reordered or edited between steps without calling invalidate().
+	 * @param changed Filled with the cells whose type changed, with their new type.
+	 */
+	virtual void step(CellStore& cells, std::vector<Cell>& changed) = 0;
+
+	/**
+	 * @brief Advance the cells several generations, e.g. all the ones due before the next frame is drawn.
+	 * Engines that keep their own state only write the cells back at the end.
+	 * 
+	 * @param changed Filled with the cells whose type changed, with their new type. A cell can be
+	 * listed more than once, the last time with its type now.
+	 */
+	virtual void advance(CellStore& cells, std::size_t generations, std::vector<Cell>& changed);
+
+	/**
+	 * @return std::size_t The amount of cells the engine found could never change, and skips.
+	 */
+	virtual std::size_t getPrunedCells() const;
+
+	/**
+	 * @return std::size_t The amount of cells the engine steps as part of a recognized circuit part,
+	 * rather than one by one.
+	 */
+	virtual std::size_t getNativeCells() const;
+
+	/**
+	 * @brief Keep what the engine compiles from a layout in a cache, to reuse it next time the same layout is loaded.
+	 *
+	 * @param cache The cache, or nullptr to always compile.
+	 */
+	void setCache(std::shared_ptr<CompileCache> cache);
+
+	/**
+	 * @brief Create an engine by name.
+	 * 
+	 * @param name One of getNames().
+	 * @return std::unique_ptr<SimulationEngine> The engine, or nullptr if there's no engine by that name.
+	 */
+	static std::unique_ptr<SimulationEngine> create(const std::string& name);
+
+	/**
+	 * @return std::vector<std::string> The names of all engines, the reference engine first.
+	 */
+	static std::vector<std::string> getNames();
+
+protected:
+	/**
+	 * @brief See setCache().
+	 *
+	 */
+	std::shared_ptr<CompileCache> mCache;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "CellStore.hpp"
+#include "Tracer.hpp"
+#include "WorldFile.hpp"
+
+/**
+ * @brief Saves a snapshot of the world to a pattern file on a background thread.
+ * 
+ * @remarks The snapshot shares its chunks with the live world, so taking it is O(1),
+ * and only chunks the live world modifies before the save is done get duplicated.
+ */
+class SnapshotSaver
+{
+public:
+	/**
+	 * @brief Start saving.
+	 * 
+	 * @param snapshot The cells to save. Pass a copy of the live store.
+	 * @param path The file to write to.
+	 */
+	SnapshotSaver(const CellStore& snapshot, const std::string& path);
+
+	/**
+	 * @brief Wait for the save to finish.
+	 * 
+	 */
+	~SnapshotSaver();
+
+	/**
+	 * @return float How much of the snapshot is written, from 0 to 1.
+	 */
+	float getProgress();
+
+	/**
+	 * @return True Once the save is over, successfully or not.
+	 */
+	bool isDone();
+
+	/**
+	 * @return True If the file couldn't be written.
+	 */
+	bool hasFailed();
+
+	/**
+	 * @return std::string The file being written to.
+	 */
+	std::string getPath();
+
+private:
+	/**
+	 * @brief The cells being saved. Released as soon as they're written.
+	 * 
+	 */
+	CellStore mSnapshot;
+
+	/**
+	 * @brief The file being written to.
+	 * 
+	 */
+	std::string mPath;
+
+	/**
+	 * @brief The amount of cells in the snapshot.
+	 * 
+	 */
+	std::size_t mTotal;
+
+	/**
+	 * @brief The amount of cells written so far.
+	 * 
+	 */
+	std::atomic<std::size_t> mWritten;
+
+	/**
+	 * @brief Save state, see isDone() & hasFailed().
+	 * 
+	 */
+	std::atomic<bool> mDone, mFailed;
+
+	/**
+	 * @brief The thread writing the file.
+	 * 
+	 */
+	std::thread mThread;
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <SFML/System.hpp>
+
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "DeltaPacket.hpp"
+#include "Simulation.hpp"
+
+/**
+ * @brief Publishes a running simulation to remote viewers.
+ * Each viewer subscribes to a region, and receives a keyframe of it followed by
+ * one delta per generation, holding only the cells in the region that changed.
+ * 
+ * @remarks Viewer sockets never block the simulation. Packets wait in a short queue per viewer,
+ * and a viewer that falls too far behind has its pending deltas replaced by a keyframe.
+ */
+class StreamServer
+{
+public:
+	/**
+	 * @brief Construct a new stream server.
+	 * 
+	 * @param port The port viewers connect to.
+	 * @param keyframeInterval Send every viewer a full keyframe every this many generations.
+	 */
+	StreamServer(unsigned short port, unsigned int keyframeInterval = 100);
+
+	/**
+	 * @brief Accept new viewers, read subscription changes, and send what's still queued.
+	 * 
+	 * @param world The simulated world, to send keyframes from.
+	 * @param timeout How long to wait for viewer activity.
+	 */
+	void poll(Simulation& world, sf::Time timeout);
+
+	/**
+	 * @brief Queue the changes of the last generation for all viewers, and send as much as their sockets take.
+	 * 
+	 * @param world The simulated world, just stepped.
+	 * @param changed The cells the step changed, as returned by Simulation::step().
+	 * @param generation The generation just simulated.
+	 */
+	void publish(Simulation& world, const std::vector<Cell>& changed, sf::Uint64 generation);
+
+	/**
+	 * @return std::size_t The amount of connected viewers.
+	 */
+	std::size_t getViewerCount();
+
+private:
+	/**
+	 * @brief A connected viewer.
+	 * 
+	 */
+	struct Viewer
+	{
+		sf::TcpSocket socket;
+		bool subscribed = false;
+		WorldRect region;
+		unsigned int sinceKeyframe = 0;
+
+		/**
+		 * @brief Packets waiting to be sent, oldest first.
+		 * 
+		 */
+		std::deque<DeltaPacket> queue;
+
+		/**
+		 * @brief Whether the first queued packet is partly sent, so it can't be dropped.
+		 * 
+		 */
+		bool sending = false;
+	};
+
+	/**
+	 * @brief The most packets queued for one viewer. Past that, it's sent a keyframe instead.
+	 * 
+	 */
+	static const std::size_t MAX_QUEUED = 32;
+
+	/**
+	 * @brief Queue every cell in a viewer's region, in place of the deltas still waiting.
+	 * 
+	 */
+	void queueKeyframe(Viewer& viewer, Simulation& world);
+
+	/**
+	 * @brief Queue the changes of the last generation inside a viewer's region,
+	 * or a keyframe if too many are waiting already.
+	 * 
+	 */
+	void queueDelta(Viewer& viewer, Simulation& world, const std::vector<Cell>& changed);
+
+	/**
+	 * @brief Send a viewer's queued packets, until its socket can't take any more.
+	 * 
+	 * @return true If the viewer is still connected.
+	 */
+	bool flush(Viewer& viewer);
+
+	/**
+	 * @brief Disconnect a viewer.
+	 * 
+	 * @return The viewer after it.
+	 */
+	std::vector<std::unique_ptr<Viewer>>::iterator remove(std::vector<std::unique_ptr<Viewer>>::iterator viewer);
+
+	/**
+	 * @brief Accepts new viewers.
+	 * 
+	 */
+	sf::TcpListener mListener;
+
+	/**
+	 * @brief Waits on the listener & all viewer sockets at once.
+	 * 
+	 */
+	sf::SocketSelector mSelector;
+
+	/**
+	 * @brief All connected viewers.
+	 * 
+	 */
+	std::vector<std::unique_ptr<Viewer>> mViewers;
+
+	/**
+	 * @brief Generations between keyframes.
+	 * 
+	 */
+	unsigned int mKeyframeInterval;
+
+	/**
+	 * @brief The last generation published, stamped on keyframes.
+	 * 
+	 */
+	sf::Uint64 mGeneration;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Tracer.hpp"
+
+/**
+ * @brief A fixed set of threads that split a batch of independent jobs with the calling thread,
+ * for work that's cut into slices that don't overlap, like filling parts of one vertex array.
+ *
+ * @remarks Meant to be driven by one thread; run() blocks until the whole batch is done,
+ * so jobs can use the caller's data without copying it.
+ */
+class ThreadPool
+{
+public:
+	/**
+	 * @brief Start the threads.
+	 *
+	 * @param threads The amount of threads besides the caller's. With 0, run() does everything itself.
+	 * @param name The name the threads get in traces.
+	 */
+	ThreadPool(unsigned int threads, const std::string& name);
+
+	/**
+	 * @brief Stop the threads.
+	 *
+	 */
+	~ThreadPool();
+
+	/**
+	 * @brief Call job(0) to job(count - 1), spread over the threads, and wait for all of them.
+	 *
+	 */
+	void run(std::size_t count, const std::function<void(std::size_t)>& job);
+
+	/**
+	 * @return std::size_t How many jobs can run at once, counting the caller.
+	 */
+	std::size_t getConcurrency() const;
+
+	/**
+	 * @return unsigned int The amount of threads worth starting on this machine, besides the caller's.
+	 */
+	static unsigned int getDefaultThreads();
+
+private:
+	/**
+	 * @brief Take jobs of the current batch until there are none left.
+	 *
+	 */
+	void claim();
+
+	/**
+	 * @brief The loop of each thread.
+	 *
+	 */
+	void work();
+
+	/**
+	 * @brief The current batch, see run().
+	 *
+	 */
+	const std::function<void(std::size_t)>* mJob;
+	std::size_t mCount;
+
+	/**
+	 * @brief The next job of the batch to take.
+	 *
+	 */
+	std::atomic<std::size_t> mNext;
+
+	/**
+	 * @brief The threads still working on the batch.
+	 *
+	 */
+	std::size_t mActive;
+
+	/**
+	 * @brief Counts up with every batch, so the threads know there's a new one.
+	 *
+	 */
+	unsigned long long mBatch;
+
+	/**
+	 * @brief Set to stop the threads.
+	 *
+	 */
+	bool mStopping;
+
+	/**
+	 * @brief Guards everything above but mNext.
+	 *
+	 */
+	std::mutex mMutex;
+
+	/**
+	 * @brief Signalled when a batch starts, and when a thread is done with it.
+	 *
+	 */
+	std::condition_variable mStarted, mDone;
+
+	std::string mName;
+	std::vector<std::thread> mThreads;
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Records timed spans from any thread, and writes them as Chrome trace-event JSON,
+ * to be opened in chrome://tracing or Perfetto.
+ *
+ * @remarks While tracing is off, a Span only checks one flag.
+ */
+class Tracer
+{
+public:
+	/**
+	 * @brief Times a scope, from construction to destruction.
+	 *
+	 */
+	class Span
+	{
+	public:
+		/**
+		 * @param name The span's name. Must outlive the trace, i.e. a string literal.
+		 */
+		Span(const char* name)
+			: mName(isEnabled() ? name : nullptr),
+			  mStart(mName ? now() : 0)
+		{
+		}
+
+		~Span()
+		{
+			if (mName)
+			{
+				record(mName, mStart, now());
+			}
+		}
+
+		Span(const Span&) = delete;
+		Span& operator=(const Span&) = delete;
+
+	private:
+		const char* mName;
+		std::int64_t mStart;
+	};
+
+	/**
+	 * @brief Start tracing, dropping any spans from an earlier trace that wasn't written.
+	 *
+	 * @param path Where stop() writes the trace.
+	 */
+	static void start(const std::string& path);
+
+	/**
+	 * @brief Stop tracing, and write the trace.
+	 *
+	 * @return true If the trace was written.
+	 */
+	static bool stop();
+
+	/**
+	 * @return True While tracing.
+	 */
+	static bool isEnabled()
+	{
+		return mEnabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Name the calling thread in traces.
+	 *
+	 */
+	static void setThreadName(const std::string& name);
+
+	/**
+	 * @return std::string The file the current trace will be written to.
+	 */
+	static std::string getPath();
+
+private:
+	/**
+	 * @brief A finished span.
+	 *
+	 */
+	struct Event
+	{
+		const char* name;
+		std::int64_t start, end;
+	};
+
+	/**
+	 * @brief One thread's spans. Only locked by its thread & the thread writing the trace.
+	 *
+	 */
+	struct Thread
+	{
+		std::mutex mutex;
+		std::uint32_t id;
+		std::string name;
+		std::vector<Event> events;
+	};
+
+	/**
+	 * @return std::int64_t Microseconds since the clock's epoch.
+	 */
+	static std::int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+				   std::chrono::steady_clock::now().time_since_epoch())
+			.count();
+	}
+
+	/**
+	 * @brief Store a span in the calling thread's list.
+	 *
+	 */
+	static void record(const char* name, std::int64_t start, std::int64_t end);
+
+	/**
+	 * @return Thread& The calling thread's spans, registering them on first use.
+	 */
+	static Thread& getThread();
+
+	/**
+	 * @brief See isEnabled().
+	 *
+	 */
+	inline static std::atomic<bool> mEnabled{false};
+
+	/**
+	 * @brief Guards everything below.
+	 *
+	 */
+	inline static std::mutex mMutex;
+
+	/**
+	 * @brief Every thread that has recorded a span or been named.
+	 *
+	 */
+	inline static std::vector<std::shared_ptr<Thread>> mThreads;
+
+	/**
+	 * @brief The id the next thread gets.
+	 *
+	 */
+	inline static std::uint32_t mNextThread = 1;
+
+	/**
+	 * @brief Where & when the current trace started.
+	 *
+	 */
+	inline static std::string mPath;
+	inline static std::int64_t mStart = 0;
+};
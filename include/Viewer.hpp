@@ -0,0 +1,128 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Network.hpp>
+
+#include <iomanip>
+#include <sstream>
+
+#include "DeltaPacket.hpp"
+#include "InfiniteGrid.hpp"
+#include "Wireworld.hpp"
+
+/**
+ * @brief A thin remote viewer, watching a simulation published by a StreamServer.
+ * Only the region around the visible part of the grid is subscribed to,
+ * so the traffic depends on the activity on screen and not on the world size.
+ * 
+ */
+class Viewer
+{
+public:
+	/**
+	 * @brief Construct a new viewer.
+	 * 
+	 * @param host The server's address.
+	 * @param port The server's port.
+	 */
+	Viewer(sf::IpAddress host, unsigned short port);
+
+	/**
+	 * @brief Main viewer loop.
+	 * 
+	 * @return int Exit code of the program.
+	 */
+	int run();
+
+private:
+	/**
+	 * @brief Handle a single window event.
+	 * 
+	 */
+	void handleEvent(const sf::Event& event);
+
+	/**
+	 * @brief Apply all keyframes & deltas received since the last frame.
+	 * 
+	 * @return false If the connection was lost.
+	 */
+	bool receive();
+
+	/**
+	 * @brief Subscribe to the region around the visible grid, if it's no longer covered.
+	 * 
+	 */
+	void subscribe();
+
+	/**
+	 * @brief Update the displayed text.
+	 * 
+	 */
+	void updateHUD();
+
+	/**
+	 * @brief Get the region of the world currently on screen.
+	 * 
+	 */
+	WorldRect getVisibleRegion();
+
+	/**
+	 * @brief The viewer window.
+	 * 
+	 */
+	sf::RenderWindow mWindow;
+
+	/**
+	 * @brief Renders the received cells.
+	 * 
+	 */
+	InfiniteGrid mGrid;
+
+	/**
+	 * @brief The connection to the server.
+	 * 
+	 */
+	sf::TcpSocket mSocket;
+
+	/**
+	 * @brief The region subscribed to, empty before the first subscription.
+	 * 
+	 */
+	WorldRect mRegion;
+
+	/**
+	 * @brief The last generation received.
+	 * 
+	 */
+	sf::Uint64 mGeneration;
+
+	/**
+	 * @brief Total bytes received, for the HUD.
+	 * 
+	 */
+	std::size_t mBytesReceived;
+
+	/**
+	 * @brief Text displayed in the top-left corner.
+	 * 
+	 */
+	sf::Text mHUD;
+
+	/**
+	 * @brief The HUD's font.
+	 * 
+	 */
+	sf::Font mHUDFont;
+
+	/**
+	 * @brief Stores info while the middle-mouse button is held (window panning)
+	 * 
+	 */
+	struct
+	{
+		bool mouseHeld = false;
+		sf::Vector2f initialMouse;
+		WorldPos initialOrigin;
+		sf::Vector2f initialOffset;
+	} mMousePan;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ProbeSet.hpp"
+
+/**
+ * @brief Draws the recent history of every probe as a strip chart along the bottom of the window.
+ * 
+ */
+class WaveformPanel : public sf::Drawable
+{
+public:
+	/**
+	 * @brief Init the panel.
+	 * 
+	 * @param font The font probe names are written in.
+	 */
+	WaveformPanel(const sf::Font& font);
+
+	/**
+	 * @brief Rebuild the chart from the probes' current history.
+	 * 
+	 * @param probes The probes.
+	 * @param windowSize The size of the window the panel is drawn at the bottom of.
+	 * @param colors The color of each cell type.
+	 */
+	void update(const ProbeSet& probes, sf::Vector2u windowSize, const std::unordered_map<Cell::Type, sf::Color>& colors);
+
+	/**
+	 * @brief The height of one probe's row, in pixels.
+	 * 
+	 */
+	static const int ROW_HEIGHT = 22;
+
+	/**
+	 * @brief The width of one generation, in pixels.
+	 * 
+	 */
+	static const int SAMPLE_WIDTH = 3;
+
+	/**
+	 * @brief The width of the name column, in pixels.
+	 * 
+	 */
+	static const int LABEL_WIDTH = 60;
+
+private:
+	/**
+	 * @brief SFML's draw() override.
+	 * 
+	 */
+	virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+	/**
+	 * @brief The font for the names.
+	 * 
+	 */
+	const sf::Font& mFont;
+
+	/**
+	 * @brief The background & waveforms.
+	 * 
+	 */
+	sf::VertexArray mVertices;
+
+	/**
+	 * @brief One name per probe.
+	 * 
+	 */
+	std::vector<sf::Text> mLabels;
+};
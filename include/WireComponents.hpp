@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+#include "CellStore.hpp"
+#include "CompileCache.hpp"
+
+/**
+ * @brief Splits a world into connected groups of cells, and finds the ones that can never carry a signal.
+ *
+ * @remarks A wire only turns into a head next to a head, so a group of touching cells without
+ * heads or tails stays wire until it's edited. Those cells are dead, and can be skipped by engines.
+ */
+class WireComponents
+{
+public:
+	/**
+	 * @brief Cell positions to their index in the store.
+	 *
+	 */
+	typedef std::unordered_map<WorldPos, std::uint32_t, Cell::PositionHash> Index;
+
+	/**
+	 * @brief Find the components of a world. Must be called again after the world is edited.
+	 *
+	 */
+	void analyze(const CellStore& cells);
+
+	/**
+	 * @brief Write the neighbors & components of the last analyzed layout.
+	 *
+	 */
+	void save(CompileCache::Writer& out) const;
+
+	/**
+	 * @brief Restore the neighbors & components saved for the same layout, instead of analyzing it.
+	 * The index isn't saved, and stays empty.
+	 *
+	 * @return true If they were read.
+	 */
+	bool load(CompileCache::Reader& in, const CellStore& cells);
+
+	/**
+	 * @return True If the cell at that index is in a component that has a head or a tail.
+	 */
+	bool isLive(std::size_t i) const;
+
+	/**
+	 * @return const Index& The index of every cell by position, built while analyzing.
+	 */
+	const Index& getIndex() const;
+
+	/**
+	 * @brief The neighbors of cell i are getNeighbors()[getOffsets()[i]] to getNeighbors()[getOffsets()[i + 1]].
+	 *
+	 */
+	const std::vector<std::uint32_t>& getOffsets() const;
+	const std::vector<std::uint32_t>& getNeighbors() const;
+
+	/**
+	 * @return std::size_t The amount of components.
+	 */
+	std::size_t getComponents() const;
+
+	/**
+	 * @return std::size_t The amount of cells and components that are dead.
+	 */
+	std::size_t getDeadCells() const;
+	std::size_t getDeadComponents() const;
+
+private:
+	/**
+	 * @brief Find the component a cell belongs to, shortening the path there on the way.
+	 *
+	 */
+	std::uint32_t find(std::uint32_t i);
+
+	/**
+	 * @brief Count the components, and find the live ones from the types of the cells.
+	 *
+	 */
+	void mark(const CellStore& cells);
+
+	/**
+	 * @brief See getIndex().
+	 *
+	 */
+	Index mIndex;
+
+	/**
+	 * @brief For every cell, the cell it was merged into. Component roots point to themselves.
+	 *
+	 */
+	std::vector<std::uint32_t> mParents;
+
+	/**
+	 * @brief See getOffsets().
+	 *
+	 */
+	std::vector<std::uint32_t> mOffsets, mNeighbors;
+
+	/**
+	 * @brief For every cell, if its component is live.
+	 *
+	 */
+	std::vector<bool> mLive;
+
+	std::size_t mComponents = 0;
+	std::size_t mDeadCells = 0, mDeadComponents = 0;
+};
@@ -4,12 +4,22 @@
 
 #include <algorithm>
 #include <iomanip>
+#include <iostream>
+#include <memory>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "Cell.hpp"
+#include "EditJournal.hpp"
+#include "FrameRecorder.hpp"
 #include "InfiniteGrid.hpp"
+#include "Simulation.hpp"
+#include "SnapshotSaver.hpp"
+#include "Tracer.hpp"
+#include "WaveformPanel.hpp"
+#include "WorldLoader.hpp"
 
 /**
  * @brief Encapsulates and controls an InfiniteGrid instance to
@@ -23,8 +33,9 @@ public:
 	 * @brief Construct a new Wireworld instance.
 	 * 
 	 * @param window A pointer to the app window.
+	 * @param engine The name of the simulation engine to use.
 	 */
-	Wireworld(sf::RenderWindow* window);
+	Wireworld(sf::RenderWindow* window, const std::string& engine = DEFAULT_ENGINE);
 
 	/**
 	 * @brief Called by the event handler on a window resize event.
@@ -59,19 +70,72 @@ public:
 	 */
 	sf::Time getSpeed();
 
+	/**
+	 * @brief Switch the engine used to step the simulation.
+	 * 
+	 * @param name The name of the engine, see SimulationEngine::getNames().
+	 * @return true If the engine exists, false if the current one was kept.
+	 */
+	bool setEngine(const std::string& name);
+
+	/**
+	 * @return std::string The name of the current engine.
+	 */
+	std::string getEngine();
+
+	/**
+	 * @brief The engine used when none is picked.
+	 * 
+	 */
+	static constexpr const char* DEFAULT_ENGINE = Simulation::DEFAULT_ENGINE;
+
 	/**
 	 * @brief Update the simulation.
 	 * 
+	 * @param dt The time since the last frame.
+	 * 
 	 * @remarks Call once per frame.
 	 * 
 	 */
-	void update();
+	void update(sf::Time dt);
+
+	/**
+	 * @brief Set where the mouse is this frame.
+	 * 
+	 * @param pos The mouse position, relative to the window.
+	 * 
+	 * @remarks Call once per frame, before update(). All mouse input reads this,
+	 * so recorded input replays exactly.
+	 */
+	void setMousePosition(sf::Vector2i pos);
+
+	/**
+	 * @return True If anything visible changed since the last setDrawn().
+	 */
+	bool needsRedraw();
+
+	/**
+	 * @brief Mark the current state as drawn.
+	 * 
+	 */
+	void setDrawn();
+
+	/**
+	 * @return True If nothing will change until the next input event.
+	 */
+	bool isIdle();
 
 	/**
-	 * @brief Advance the simulation forward one step.
+	 * @return sf::Time How long until the next step is due, while running.
+	 */
+	sf::Time getTimeToNextStep();
+
+	/**
+	 * @brief Advance the simulation forward, and redraw the cells that changed.
 	 * 
+	 * @param generations How many generations to step before redrawing.
 	 */
-	void step();
+	void step(std::size_t generations = 1);
 
 	/////////EVENT HANDLERS///////////
 
@@ -100,8 +164,9 @@ public:
 	 * @brief Called on every key press.
 	 * 
 	 * @param key The key pressed.
+	 * @param shift Whether shift was held.
 	 */
-	void onKeyPress(sf::Keyboard::Key key);
+	void onKeyPress(sf::Keyboard::Key key, bool shift = false);
 
 	/**
 	 * @brief Called on every key release.
@@ -126,7 +191,7 @@ public:
 	 * @return true If there is a cell there.
 	 * @return false If the square is empty.
 	 */
-	bool isCell(sf::Vector2i pos);
+	bool isCell(WorldPos pos);
 
 	/**
 	 * @brief Get the cell located at the given position.
@@ -137,14 +202,62 @@ public:
 	 * @remarks Returns a white cell @ 0,0 if there is none. 
 	 * Use isCell(pos) to check if there's a cell there in the first place.
 	 */
-	Cell getCell(sf::Vector2i pos);
+	Cell getCell(WorldPos pos);
 
 	/**
 	 * @brief Remove the cell at the given position, if it exists.
 	 * 
 	 * @param pos 
 	 */
-	void clearCell(sf::Vector2i pos);
+	void clearCell(WorldPos pos);
+
+	/**
+	 * @brief Start saving the world to a pattern file in the background.
+	 * The simulation keeps running while it's written.
+	 * 
+	 * @param path The file to write to.
+	 * @return true If the save started, false if one is still in progress.
+	 */
+	bool save(const std::string& path);
+
+	/**
+	 * @brief Replace the world with a pattern file, loaded in the background.
+	 * Cells show up as they're parsed, nearest to the view first. Editing & panning
+	 * keep working, but the simulation can't run until the load is done.
+	 * 
+	 * @param path The pattern file.
+	 */
+	void load(const std::string& path);
+
+	/**
+	 * @brief Page cold parts of the world out to a file, see Simulation::setPaging().
+	 * 
+	 */
+	bool setPaging(const std::string& path, std::size_t maxResidentBytes);
+
+	/**
+	 * @brief Cache what engines compile from the layout in a directory, see Simulation::setCache().
+	 * 
+	 */
+	bool setCache(const std::string& directory, std::uintmax_t maxBytes);
+
+	/**
+	 * @brief Journal every edit to a directory, after putting back the world journaled there last time.
+	 * 
+	 * @return true If the directory could be opened.
+	 */
+	bool setAutosave(const std::string& directory);
+
+	/**
+	 * @return True While a load is in progress.
+	 */
+	bool isLoading();
+
+	/**
+	 * @brief The constant mapping of cell types to colors.
+	 * 
+	 */
+	static const std::unordered_map<Cell::Type, sf::Color> CELL_COLORS;
 
 private:
 	/**
@@ -166,44 +279,58 @@ private:
 	InfiniteGrid mGrid;
 
 	/**
-	 * @brief The vector of actual game cells.
+	 * @brief Extra views of the world, in panes down the right side of the window.
+	 * They share mGrid's cache, so each one only costs its own draw calls.
 	 * 
 	 */
-	std::vector<Cell> mCells;
+	std::vector<InfiniteGrid> mPanes;
 
 	/**
-	 * @brief The constant mapping of cell types to colors.
+	 * @brief The most panes shown at once.
 	 * 
 	 */
-	const std::unordered_map<Cell::Type, sf::Color> CELL_COLORS = {
-		{Cell::NONE, sf::Color::White},
-		{Cell::HEAD, sf::Color::Blue},
-		{Cell::TAIL, sf::Color::Red},
-		{Cell::WIRE, sf::Color::Yellow}};
+	static const std::size_t MAX_PANES = 3;
 
 	/**
-	 * @brief Get a pointer to the cell at the given position.
+	 * @brief Add a pane, zoomed in on the hovered cell.
 	 * 
-	 * @param pos The position.
-	 * @return Cell* The cell at that position. Nullptr if it doesn't exist.
 	 */
-	Cell* getCellPtr(sf::Vector2i pos);
+	void addPane();
 
 	/**
-	 * @brief Get the position of the mouse as a cell position, not a window position.
+	 * @brief Start counting heads & draw the heat map over every view, or stop.
 	 * 
-	 * @param translate True if the position should be translated by the grid's position.
-	 * @return sf::Vector2f The cell the mouse is hovering over.
 	 */
-	sf::Vector2f getMousePos(bool translate = true);
+	void toggleHeatMap();
+
+	/**
+	 * @brief Remove the last pane added.
+	 * 
+	 */
+	void removePane();
+
+	/**
+	 * @return sf::FloatRect Where a pane is drawn in the window, in pixels.
+	 */
+	sf::FloatRect getPaneRect(std::size_t i) const;
+
+	/**
+	 * @return InfiniteGrid& The pane at a point in the window, or mGrid if there's none.
+	 */
+	InfiniteGrid& getGridAt(sf::Vector2i pos);
 
 	/**
-	 * @brief Get the floored position of the mouse as a cell position, not a window position.
+	 * @brief The actual game cells, and the engine stepping them.
 	 * 
-	 * @param translate True if the position should be translated by the grid's position.
-	 * @return sf::Vector2f The cell the mouse is hovering over.
 	 */
-	sf::Vector2f getFlooredMousePos(bool translate = true);
+	Simulation mSimulation;
+
+	/**
+	 * @brief Get the position of the mouse as a cell position, not a window position.
+	 * 
+	 * @return WorldPos The cell the mouse is hovering over.
+	 */
+	WorldPos getMouseCell();
 
 	/**
 	 * @brief Check if the mouse is inside the viewable window.
@@ -214,10 +341,16 @@ private:
 	bool isMouseValid();
 
 	/**
-	 * @brief The internal simulation clock.
+	 * @brief Time passed since the last step.
+	 * 
+	 */
+	sf::Time mElapsed;
+
+	/**
+	 * @brief The mouse position this frame, relative to the window.
 	 * 
 	 */
-	sf::Clock mClock;
+	sf::Vector2i mMouse;
 
 	/**
 	 * @brief The speed of the simulation.
@@ -231,6 +364,91 @@ private:
 	 */
 	bool mRunning;
 
+
+	/**
+	 * @brief Records every generation to an image sequence, while set.
+	 * 
+	 */
+	std::unique_ptr<FrameRecorder> mRecorder;
+
+	/**
+	 * @brief Saves a snapshot of the world in the background, while set.
+	 * 
+	 */
+	std::unique_ptr<SnapshotSaver> mSaver;
+
+	/**
+	 * @brief mCells' copied chunk count when the save started.
+	 * 
+	 */
+	std::size_t mSaveCopiedChunks;
+
+	/**
+	 * @brief The file the world is saved to.
+	 * 
+	 */
+	static constexpr const char* SAVE_PATH = "world.wi";
+
+	/**
+	 * @brief The file traces started with T are written to.
+	 * 
+	 */
+	static constexpr const char* TRACE_PATH = "trace.json";
+
+	/**
+	 * @brief Records every edit, while set. See setAutosave().
+	 * 
+	 */
+	std::unique_ptr<EditJournal> mJournal;
+
+	/**
+	 * @brief Loads a pattern file in the background, while set.
+	 * 
+	 */
+	std::unique_ptr<WorldLoader> mLoader;
+
+	/**
+	 * @brief Positions edited by hand during the load, which loaded cells mustn't overwrite.
+	 * 
+	 */
+	std::unordered_set<WorldPos, Cell::PositionHash> mLoadEdits;
+
+	/**
+	 * @brief The max amount of loaded cells added per frame.
+	 * 
+	 */
+	static const std::size_t LOAD_BATCH = 65536;
+
+	/**
+	 * @brief The most generations stepped between two frames, when the interval is shorter than a frame.
+	 * 
+	 */
+	static constexpr std::size_t MAX_FRAME_GENERATIONS = 64;
+
+	/**
+	 * @brief Add cells handed over by mLoader, skipping the positions edited by hand.
+	 * 
+	 */
+	void addLoaded(const std::vector<Cell>& cells);
+
+	/**
+	 * @brief Charts mProbes' history.
+	 * 
+	 */
+	WaveformPanel mWaveforms;
+
+	/**
+	 * @brief Rebuild the waveform panel.
+	 * 
+	 */
+	void updateWaveforms();
+
+	/**
+	 * @brief Whether anything visible changed since the last frame was drawn.
+	 * 
+	 */
+	bool mRedraw;
+
 	///////////////TEXT////////////////////
 
 	/**
@@ -245,6 +463,12 @@ private:
 	 */
 	sf::Font mHUDFont;
 
+	/**
+	 * @brief The text currently laid out in mHUD.
+	 * 
+	 */
+	std::string mHUDString;
+
 	/**
 	 * @brief Update the displayed text.
 	 *
@@ -267,7 +491,7 @@ private:
 	struct
 	{
 		bool mouseHeld = false;
-		std::vector<sf::Vector2i> log;
+		std::vector<WorldPos> log;
 		sf::Mouse::Button btn;
 	} mCellPlacement;
 
@@ -279,6 +503,9 @@ private:
 	{
 		bool mouseHeld = false;
 		sf::Vector2f initialMouse;
-		sf::Vector2f initialGrid;
+		WorldPos initialOrigin;
+		sf::Vector2f initialOffset;
+		sf::Vector2f moved;
+		InfiniteGrid* grid = nullptr;
 	} mMousePan;
 };
\ No newline at end of file
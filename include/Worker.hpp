@@ -0,0 +1,104 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <SFML/System.hpp>
+
+#include <iostream>
+
+#include "Coordinator.hpp"
+#include "Partition.hpp"
+
+/**
+ * @brief Simulates one strip of a distributed world, exchanging edge halos
+ * with the workers on either side of it, in lockstep with the Coordinator.
+ * 
+ */
+class Worker
+{
+public:
+	/**
+	 * @brief Construct a new worker.
+	 * 
+	 * @param host The coordinator's address.
+	 * @param port The coordinator's port.
+	 */
+	Worker(sf::IpAddress host, unsigned short port);
+
+	/**
+	 * @brief Connect to the coordinator, and simulate until told to quit.
+	 * 
+	 * @return int Exit code of the process.
+	 */
+	int run();
+
+private:
+	/**
+	 * @brief Receive the worker's strip, and connect to its neighbors.
+	 * 
+	 * @return true If the worker is ready to step.
+	 */
+	bool setup();
+
+	/**
+	 * @brief Trade edge heads with both neighbors, then step the partition.
+	 * 
+	 * @return true If the halos were exchanged successfully.
+	 */
+	bool step();
+
+	/**
+	 * @brief Trade edge heads with the neighbor on one side.
+	 * 
+	 * @param leftSide True to trade with the left neighbor.
+	 * @return true If the halo was exchanged successfully.
+	 */
+	bool exchange(bool leftSide);
+
+	/**
+	 * @brief The coordinator's address.
+	 * 
+	 */
+	sf::IpAddress mHost;
+
+	/**
+	 * @brief The coordinator's port.
+	 * 
+	 */
+	unsigned short mPort;
+
+	/**
+	 * @brief The connection to the coordinator.
+	 * 
+	 */
+	sf::TcpSocket mCoordinator;
+
+	/**
+	 * @brief Accepts the connection from the left neighbor.
+	 * 
+	 */
+	sf::TcpListener mListener;
+
+	/**
+	 * @brief The connections to the left & right neighbors.
+	 * 
+	 */
+	sf::TcpSocket mLeft, mRight;
+
+	/**
+	 * @brief Whether there is a neighbor on each side.
+	 * 
+	 */
+	bool mHasLeft, mHasRight;
+
+	/**
+	 * @brief The worker's position in the strip order.
+	 * 
+	 */
+	unsigned int mIndex;
+
+	/**
+	 * @brief The strip of the world this worker simulates.
+	 * 
+	 */
+	Partition mPartition;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Cell.hpp"
+#include "CellStore.hpp"
+
+/**
+ * @brief Reads and writes worlds as plain text pattern files.
+ * 
+ * @remarks Each non-empty line that doesn't start with '#' is one cell,
+ * written as `<type> <x> <y>` where type is one of W (wire), H (head) or T (tail).
+ */
+class WorldFile
+{
+public:
+	/**
+	 * @brief Load all cells from a pattern file.
+	 * 
+	 * @param path The file to read.
+	 * @param cells Filled with the loaded cells.
+	 * @return true If the file was read successfully.
+	 * @return false If it couldn't be opened, or a line was malformed.
+	 */
+	static bool load(const std::string& path, std::vector<Cell>& cells);
+
+	/**
+	 * @brief Parse one line of a pattern file.
+	 * 
+	 * @param line The line.
+	 * @param cells The cell on it is appended to this, if it's not a comment or blank.
+	 * @return false If the line is malformed.
+	 */
+	static bool parseLine(const std::string& line, std::vector<Cell>& cells);
+
+	/**
+	 * @brief Write cells to a pattern file.
+	 * 
+	 * @param path The file to write to.
+	 * @param cells The cells to save.
+	 * @return true If the file was written successfully.
+	 */
+	static bool save(const std::string& path, const std::vector<Cell>& cells);
+
+	/**
+	 * @brief Write cells to a pattern file.
+	 * 
+	 * @param path The file to write to.
+	 * @param cells The cells to save.
+	 * @param written If set, kept up to date with the amount of cells written so far.
+	 * @return true If the file was written successfully.
+	 */
+	static bool save(const std::string& path, const CellStore& cells, std::atomic<std::size_t>* written = nullptr);
+
+	/**
+	 * @brief Get the character a cell type is written as.
+	 * 
+	 * @param type The cell type.
+	 * @return char W, H or T. '?' for NONE.
+	 */
+	static char typeToChar(Cell::Type type);
+
+	/**
+	 * @brief Parse a cell type character.
+	 * 
+	 * @param c The character.
+	 * @return Cell::Type The parsed type, NONE if it's not a valid type.
+	 */
+	static Cell::Type charToType(char c);
+};
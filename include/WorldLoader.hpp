@@ -0,0 +1,134 @@
+#pragma once
+
+#include <SFML/System.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+#include "Tracer.hpp"
+#include "WorldFile.hpp"
+
+/**
+ * @brief Parses a pattern file on a background thread, and hands the cells over
+ * in square blocks, nearest to a focus point first.
+ * 
+ */
+class WorldLoader
+{
+public:
+	/**
+	 * @brief The width & height of a block, in cells.
+	 * 
+	 */
+	static const int BLOCK_SIZE = 64;
+
+	/**
+	 * @brief Start parsing.
+	 * 
+	 * @param path The pattern file to load.
+	 */
+	WorldLoader(const std::string& path);
+
+	/**
+	 * @brief Stop parsing, and wait for the thread.
+	 * 
+	 */
+	~WorldLoader();
+
+	/**
+	 * @brief Take parsed cells, whole blocks at a time, nearest to the focus first.
+	 * 
+	 * @param focus The cell position to load around, usually the middle of the view.
+	 * @param max Stop taking blocks once this many cells were taken.
+	 * @param cells The taken cells are appended to this.
+	 */
+	void take(WorldPos focus, std::size_t max, std::vector<Cell>& cells);
+
+	/**
+	 * @return float How much of the file is parsed, from 0 to 1.
+	 */
+	float getProgress();
+
+	/**
+	 * @return std::size_t The amount of cells taken so far.
+	 */
+	std::size_t getTaken();
+
+	/**
+	 * @return True Once the whole file is parsed and taken, or parsing failed.
+	 */
+	bool isDone();
+
+	/**
+	 * @return True If the file couldn't be opened, or a line was malformed.
+	 */
+	bool hasFailed();
+
+	/**
+	 * @return std::string The file being loaded.
+	 */
+	std::string getPath();
+
+private:
+	/**
+	 * @brief The file being loaded.
+	 * 
+	 */
+	std::string mPath;
+
+	/**
+	 * @brief Parsed cells that weren't taken yet, by block.
+	 * 
+	 */
+	std::unordered_map<WorldPos, std::vector<Cell>, Cell::PositionHash> mPending;
+
+	/**
+	 * @brief Guards mPending.
+	 * 
+	 */
+	std::mutex mMutex;
+
+	/**
+	 * @brief Bytes parsed so far, and the file's size.
+	 * 
+	 */
+	std::atomic<std::size_t> mParsedBytes, mTotalBytes;
+
+	/**
+	 * @brief The amount of cells taken so far.
+	 * 
+	 */
+	std::size_t mTaken;
+
+	/**
+	 * @brief Parse state.
+	 * 
+	 */
+	std::atomic<bool> mParsed, mFailed, mStop;
+
+	/**
+	 * @brief The parsing thread.
+	 * 
+	 */
+	std::thread mThread;
+
+	/**
+	 * @brief The parsing thread's loop.
+	 * 
+	 */
+	void parse();
+
+	/**
+	 * @brief Get the block a cell position is in.
+	 * 
+	 */
+	static WorldPos getBlock(WorldPos pos);
+};
@@ -1,11 +1,80 @@
 #include "Application.hpp"
 
-Application::Application()
+const sf::Time Application::MAX_SLEEP = sf::milliseconds(4);
+
+Application::Application(const std::string& engine)
 	: mWindow(sf::VideoMode(700, 700),
 			  "Wireworld",
 			  sf::Style::Titlebar | sf::Style::Close),
-	  mSimulation(&mWindow)
+	  mSimulation(&mWindow, engine),
+	  mRecording(false),
+	  mReplaying(false)
+{
+	setFrameLimit(DEFAULT_FRAME_LIMIT);
+}
+
+void Application::load(const std::string& path)
 {
+	mSimulation.load(path);
+}
+
+bool Application::setPaging(const std::string& path, std::size_t maxResidentBytes)
+{
+	return mSimulation.setPaging(path, maxResidentBytes);
+}
+
+bool Application::setCache(const std::string& directory, std::uintmax_t maxBytes)
+{
+	return mSimulation.setCache(directory, maxBytes);
+}
+
+bool Application::setAutosave(const std::string& directory)
+{
+	return mSimulation.setAutosave(directory);
+}
+
+void Application::setFrameLimit(unsigned int fps)
+{
+	mFrameInterval = fps ? sf::microseconds(1000000 / fps) : sf::Time::Zero;
+}
+
+void Application::waitForWork(std::vector<sf::Event>& events, sf::Time sinceDrawn)
+{
+	//Nothing will change on its own, so sleep until the next event.
+	if (mSimulation.isIdle() && !mSimulation.needsRedraw())
+	{
+		sf::Event event;
+		if (mWindow.waitEvent(event))
+		{
+			events.push_back(event);
+		}
+		return;
+	}
+
+	//Otherwise until the next step or frame is due, checking for input in between.
+	sf::Time wait = mSimulation.isRunning() ? mSimulation.getTimeToNextStep() : MAX_SLEEP;
+	if (mSimulation.needsRedraw())
+	{
+		wait = std::min(wait, mFrameInterval - sinceDrawn);
+	}
+	wait = std::min(wait, MAX_SLEEP);
+	if (wait > sf::Time::Zero)
+	{
+		sf::sleep(wait);
+	}
+}
+
+bool Application::recordInput(const std::string& path)
+{
+	mRecording = mInputLog.openWrite(path);
+	return mRecording;
+}
+
+bool Application::replayInput(const std::string& path, const std::string& timings)
+{
+	mReplaying	 = mInputLog.openRead(path);
+	mTimingsPath = timings;
+	return mReplaying;
 }
 
 int Application::run()
@@ -13,58 +82,142 @@ int Application::run()
 	//The ImGui internal clock.
 	sf::Clock imgui_clock;
 
+	//Times each frame.
+	sf::Clock frame_clock;
+
+	//Time since the window was last redrawn.
+	sf::Clock drawn_clock;
+
+	Tracer::setThreadName("main");
+
 	//App loop.
 	while (mWindow.isOpen())
 	{
+		//This frame's input.
+		InputLog::Frame frame;
+
+		//Replays run flat out, otherwise sleep until there's something to do.
+		if (!mReplaying)
+		{
+			waitForWork(frame.events, drawn_clock.getElapsedTime());
+		}
+		frame.dt = frame_clock.restart();
+
 		//Handle events.
 		sf::Event event;
 		while (mWindow.pollEvent(event))
 		{
-			//SFML events..
-			switch (event.type)
+			//While replaying, only closing the window gets through.
+			if (!mReplaying || event.type == sf::Event::Closed)
 			{
-			default:
-				break;
-			case sf::Event::Closed:
-				mWindow.close();
-				break;
-			case sf::Event::Resized:
-				mWindow.setSize({event.size.width, event.size.height});
-				mSimulation.updateWindowSize(mWindow.getSize());
-				break;
-				//Handle mouse events for Wireworld simul.
-			case sf::Event::MouseButtonPressed:
-				mSimulation.onMousePress(event.mouseButton.button);
-				break;
-			case sf::Event::MouseButtonReleased:
-				mSimulation.onMouseRelease(event.mouseButton.button);
-				break;
-			case sf::Event::MouseWheelScrolled:
-				mSimulation.onMouseScroll(event.mouseWheelScroll.delta);
-				break;
+				frame.events.push_back(event);
+			}
+		}
+		frame.mouse = sf::Mouse::getPosition(mWindow);
 
-				//Wireworld keyboard events.
-			case sf::Event::KeyPressed:
-				mSimulation.onKeyPress(event.key.code);
-				break;
-			case sf::Event::KeyReleased:
-				mSimulation.onKeyRelease(event.key.code);
+		//Swap in the recorded frame, ending once the log runs out.
+		if (mReplaying)
+		{
+			bool closed = !frame.events.empty();
+			if (closed || !mInputLog.read(frame))
+			{
 				break;
 			}
 		}
+		if (mRecording)
+		{
+			mInputLog.write(frame);
+		}
+
+		//Only the work done for the frame is timed, not the wait for the next one.
+		sf::Clock work_clock;
+		Tracer::Span frameSpan("Application::frame");
+
+		{
+			Tracer::Span span("Application::handleEvents");
+			for (auto& e : frame.events)
+			{
+				handleEvent(e);
+			}
+		}
 
 		//Update the simulation.
-		mSimulation.update();
+		mSimulation.setMousePosition(frame.mouse);
+		mSimulation.update(frame.dt);
 
-		//Clear the window.
-		mWindow.clear(sf::Color::White);
-		//Draw here...
+		//Only redraw when something changed, and at most once per frame interval.
+		if (mSimulation.needsRedraw() && (mReplaying || drawn_clock.getElapsedTime() >= mFrameInterval))
+		{
+			Tracer::Span span("Application::draw");
 
-		mWindow.draw(mSimulation);
+			//Clear the window.
+			mWindow.clear(sf::Color::White);
+			//Draw here...
 
-		//Finish drawing.
-		mWindow.display();
+			mWindow.draw(mSimulation);
+
+			//Finish drawing.
+			mWindow.display();
+			mSimulation.setDrawn();
+			drawn_clock.restart();
+		}
+
+		if (mReplaying)
+		{
+			mTimings.add(work_clock.getElapsedTime());
+		}
+	}
+
+	//Write the trace of a session that ended while tracing.
+	if (Tracer::isEnabled() && !Tracer::stop())
+	{
+		std::cerr << "Couldn't write " << Tracer::getPath() << "\n";
+	}
+
+	if (mReplaying)
+	{
+		mTimings.report(std::cout);
+		if (!mTimingsPath.empty() && !mTimings.save(mTimingsPath))
+		{
+			std::cerr << "Couldn't write " << mTimingsPath << "\n";
+			return 1;
+		}
 	}
 
 	return 0;
-}
\ No newline at end of file
+}
+
+void Application::handleEvent(const sf::Event& event)
+{
+	//SFML events..
+	switch (event.type)
+	{
+	default:
+		break;
+	case sf::Event::Closed:
+		mWindow.close();
+		break;
+	case sf::Event::Resized:
+		mWindow.setSize({event.size.width, event.size.height});
+		mSimulation.updateWindowSize(mWindow.getSize());
+		break;
+		//Handle mouse events for Wireworld simul.
+	case sf::Event::MouseButtonPressed:
+		mSimulation.onMousePress(event.mouseButton.button);
+		break;
+	case sf::Event::MouseButtonReleased:
+		mSimulation.onMouseRelease(event.mouseButton.button);
+		break;
+	case sf::Event::MouseWheelScrolled:
+		mSimulation.onMouseScroll(event.mouseWheelScroll.delta);
+		break;
+
+		//Wireworld keyboard events.
+	case sf::Event::KeyPressed:
+		mSimulation.onKeyPress(event.key.code, event.key.shift);
+		break;
+	case sf::Event::KeyReleased:
+		mSimulation.onKeyRelease(event.key.code);
+		break;
+	}
+}
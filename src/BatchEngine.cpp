@@ -0,0 +1,261 @@
+#include "BatchEngine.hpp"
+
+template <std::size_t WORDS>
+BatchEngine<WORDS>::BatchEngine(const std::vector<Cell>& cells)
+	: mActiveValid(false),
+	  mGeneration(0)
+{
+	for (auto& cell : cells)
+	{
+		if (!mIndex.count(cell.getPosition()))
+		{
+			mIndex[cell.getPosition()] = mPositions.size();
+			mPositions.push_back(cell.getPosition());
+		}
+	}
+
+	Mask none{}, all;
+	all.fill(~std::uint64_t(0));
+	mHeads.assign(mPositions.size(), none);
+	mTails.assign(mPositions.size(), none);
+	for (auto& cell : cells)
+	{
+		std::uint32_t i = mIndex[cell.getPosition()];
+		mHeads[i]		= cell.getType() == Cell::HEAD ? all : none;
+		mTails[i]		= cell.getType() == Cell::TAIL ? all : none;
+	}
+
+	//The same neighbor lists as CompiledEngine.
+	mOffsets.assign(1, 0);
+	for (auto& pos : mPositions)
+	{
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				if (dx == 0 && dy == 0)
+				{
+					continue;
+				}
+				auto found = mIndex.find(pos + WorldPos(dx, dy));
+				if (found != mIndex.end())
+				{
+					mNeighbors.push_back(found->second);
+				}
+			}
+		}
+		mOffsets.push_back(mNeighbors.size());
+	}
+
+	mOnes.resize(mPositions.size());
+	mTwos.resize(mPositions.size());
+	mMore.resize(mPositions.size());
+	mTouchedFlag.assign(mPositions.size(), 0);
+}
+
+template <std::size_t WORDS>
+bool BatchEngine<WORDS>::setCell(std::size_t instance, WorldPos pos, Cell::Type type)
+{
+	auto found = mIndex.find(pos);
+	if (found == mIndex.end() || instance >= LANES)
+	{
+		return false;
+	}
+
+	std::uint64_t bit = std::uint64_t(1) << (instance % 64);
+	Mask& heads		  = mHeads[found->second];
+	Mask& tails		  = mTails[found->second];
+	heads[instance / 64] &= ~bit;
+	tails[instance / 64] &= ~bit;
+	if (type == Cell::HEAD)
+	{
+		heads[instance / 64] |= bit;
+	}
+	else if (type == Cell::TAIL)
+	{
+		tails[instance / 64] |= bit;
+	}
+
+	mActiveValid = false;
+	return true;
+}
+
+template <std::size_t WORDS>
+Cell::Type BatchEngine<WORDS>::getCell(std::size_t instance, WorldPos pos)
+{
+	auto found = mIndex.find(pos);
+	if (found == mIndex.end())
+	{
+		return Cell::NONE;
+	}
+	return typeOf(mHeads[found->second], mTails[found->second], instance);
+}
+
+template <std::size_t WORDS>
+std::vector<Cell> BatchEngine<WORDS>::getCells(std::size_t instance)
+{
+	std::vector<Cell> cells;
+	cells.reserve(mPositions.size());
+	for (std::size_t i = 0; i < mPositions.size(); ++i)
+	{
+		cells.push_back(Cell(typeOf(mHeads[i], mTails[i], instance), mPositions[i]));
+	}
+	return cells;
+}
+
+template <std::size_t WORDS>
+int BatchEngine<WORDS>::addProbe(WorldPos pos)
+{
+	auto found = mIndex.find(pos);
+	if (found == mIndex.end())
+	{
+		return -1;
+	}
+	mProbes.push_back(found->second);
+	mTraces.emplace_back();
+	return mProbes.size() - 1;
+}
+
+template <std::size_t WORDS>
+std::vector<Cell::Type> BatchEngine<WORDS>::getTrace(std::size_t probe, std::size_t instance)
+{
+	std::vector<Cell::Type> trace;
+	trace.reserve(mTraces[probe].size());
+	for (auto& sample : mTraces[probe])
+	{
+		trace.push_back(typeOf(sample.first, sample.second, instance));
+	}
+	return trace;
+}
+
+template <std::size_t WORDS>
+void BatchEngine<WORDS>::step()
+{
+	if (!mActiveValid)
+	{
+		updateActive();
+	}
+
+	//Add every head up into its neighbors' bit-sliced counters, across all instances at once.
+	mTouched.clear();
+	for (auto& head : mActiveHeads)
+	{
+		const Mask& h = mHeads[head];
+		for (std::uint32_t i = mOffsets[head]; i < mOffsets[head + 1]; ++i)
+		{
+			std::uint32_t n = mNeighbors[i];
+			if (!mTouchedFlag[n])
+			{
+				mTouchedFlag[n] = 1;
+				mOnes[n]		= Mask{};
+				mTwos[n]		= Mask{};
+				mMore[n]		= Mask{};
+				mTouched.push_back(n);
+			}
+
+			Mask& ones = mOnes[n];
+			Mask& twos = mTwos[n];
+			Mask& more = mMore[n];
+			for (std::size_t w = 0; w < WORDS; ++w)
+			{
+				std::uint64_t carry = ones[w] & h[w];
+				ones[w] ^= h[w];
+				more[w] |= twos[w] & carry;
+				twos[w] ^= carry;
+			}
+		}
+	}
+
+	//A wire becomes a head with 1 or 2 head neighbors: exactly one of ones/twos set, and not 4+.
+	mNewHeads.clear();
+	for (auto& n : mTouched)
+	{
+		mTouchedFlag[n] = 0;
+		Mask& born		= mOnes[n];
+		for (std::size_t w = 0; w < WORDS; ++w)
+		{
+			born[w] = ~mHeads[n][w] & ~mTails[n][w] & (mOnes[n][w] ^ mTwos[n][w]) & ~mMore[n][w];
+		}
+		if (any(born))
+		{
+			mNewHeads.push_back(n);
+		}
+	}
+
+	//Tails become wire, heads become tails, and the counted wires become heads.
+	for (auto& tail : mActiveTails)
+	{
+		mTails[tail] = Mask{};
+	}
+	for (auto& head : mActiveHeads)
+	{
+		mTails[head] = mHeads[head];
+		mHeads[head] = Mask{};
+	}
+	for (auto& n : mNewHeads)
+	{
+		mHeads[n] = mOnes[n];
+	}
+	mActiveTails.swap(mActiveHeads);
+	mActiveHeads.swap(mNewHeads);
+
+	mGeneration++;
+	for (std::size_t p = 0; p < mProbes.size(); ++p)
+	{
+		mTraces[p].push_back({mHeads[mProbes[p]], mTails[mProbes[p]]});
+	}
+}
+
+template <std::size_t WORDS>
+unsigned long long BatchEngine<WORDS>::getGeneration()
+{
+	return mGeneration;
+}
+
+template <std::size_t WORDS>
+void BatchEngine<WORDS>::updateActive()
+{
+	mActiveHeads.clear();
+	mActiveTails.clear();
+	for (std::uint32_t i = 0; i < mPositions.size(); ++i)
+	{
+		if (any(mHeads[i]))
+		{
+			mActiveHeads.push_back(i);
+		}
+		if (any(mTails[i]))
+		{
+			mActiveTails.push_back(i);
+		}
+	}
+	mActiveValid = true;
+}
+
+template <std::size_t WORDS>
+bool BatchEngine<WORDS>::any(const Mask& m)
+{
+	std::uint64_t bits = 0;
+	for (auto& word : m)
+	{
+		bits |= word;
+	}
+	return bits != 0;
+}
+
+template <std::size_t WORDS>
+Cell::Type BatchEngine<WORDS>::typeOf(const Mask& heads, const Mask& tails, std::size_t instance)
+{
+	std::uint64_t bit = std::uint64_t(1) << (instance % 64);
+	if (heads[instance / 64] & bit)
+	{
+		return Cell::HEAD;
+	}
+	if (tails[instance / 64] & bit)
+	{
+		return Cell::TAIL;
+	}
+	return Cell::WIRE;
+}
+
+template class BatchEngine<1>;
+template class BatchEngine<4>;
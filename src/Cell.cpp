@@ -1,22 +1,22 @@
 #include "Cell.hpp"
 
-Cell::Cell(Cell::Type type, sf::Vector2i pos)
+Cell::Cell(Cell::Type type, WorldPos pos)
 {
 	mType = type;
 	mPos  = pos;
 }
 
-void Cell::setPosition(sf::Vector2i newPos)
+void Cell::setPosition(WorldPos newPos)
 {
 	mPos = newPos;
 }
 
-sf::Vector2i Cell::getPosition()
+WorldPos Cell::getPosition() const
 {
 	return mPos;
 }
 
-Cell::Type Cell::getType()
+Cell::Type Cell::getType() const
 {
 	return mType;
 }
@@ -49,3 +49,11 @@ void Cell::step(std::vector<Cell*> neighbors)
 		mType = WIRE;
 	}
 }
+
+std::size_t Cell::PositionHash::operator()(const WorldPos& pos) const
+{
+	//Pack both coordinates into one 64-bit key, and hash that. The bits past 32, which are all 0 for
+	//coordinates that fit in 32 bits, are folded into the low ones, so far away cells spread out too.
+	auto fold = [](sf::Int64 v) { return (unsigned int)v ^ (unsigned int)((v >> 31) + (v < 0)); };
+	return std::hash<unsigned long long>()(((unsigned long long)fold(pos.x) << 32) | fold(pos.y));
+}
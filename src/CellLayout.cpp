@@ -0,0 +1,126 @@
+#include "CellLayout.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+std::vector<std::size_t> CellLayout::getOrder(const std::vector<Cell>& cells, Curve curve)
+{
+	std::vector<std::size_t> order(cells.size());
+	std::iota(order.begin(), order.end(), 0);
+	if (curve == INSERTION || cells.empty())
+	{
+		return order;
+	}
+
+	WorldPos min = cells[0].getPosition(), max = min;
+	for (auto& cell : cells)
+	{
+		min.x = std::min(min.x, cell.getPosition().x);
+		min.y = std::min(min.y, cell.getPosition().y);
+		max.x = std::max(max.x, cell.getPosition().x);
+		max.y = std::max(max.y, cell.getPosition().y);
+	}
+
+	//Enough bits for the wider side, dropping the lowest ones past 32. Unsigned, so even the widest spans fit.
+	std::uint64_t span = std::max((std::uint64_t)max.x - (std::uint64_t)min.x, (std::uint64_t)max.y - (std::uint64_t)min.y);
+	int bits		   = 1;
+	while (bits < 64 && (span >> bits) != 0)
+	{
+		bits++;
+	}
+	int shift = std::max(bits - 32, 0);
+	bits -= shift;
+
+	std::vector<std::pair<std::uint64_t, std::size_t>> keys(cells.size());
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		WorldPos pos	= cells[i].getPosition();
+		std::uint32_t x = ((std::uint64_t)pos.x - (std::uint64_t)min.x) >> shift;
+		std::uint32_t y = ((std::uint64_t)pos.y - (std::uint64_t)min.y) >> shift;
+		keys[i]			= {curve == MORTON ? getMortonKey(x, y) : getHilbertKey(x, y, bits), i};
+	}
+	std::sort(keys.begin(), keys.end(), [&](const auto& a, const auto& b) {
+		if (a.first != b.first)
+		{
+			return a.first < b.first;
+		}
+		WorldPos pa = cells[a.second].getPosition();
+		WorldPos pb = cells[b.second].getPosition();
+		return pa.y != pb.y ? pa.y < pb.y : pa.x < pb.x;
+	});
+
+	for (std::size_t i = 0; i < keys.size(); ++i)
+	{
+		order[i] = keys[i].second;
+	}
+	return order;
+}
+
+std::uint64_t CellLayout::getMortonKey(std::uint32_t x, std::uint32_t y)
+{
+	//Spread the bits out with a zero between each, then slot y's bits in between x's.
+	auto spread = [](std::uint64_t v) {
+		v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+		v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+		v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+		v = (v | (v << 2)) & 0x3333333333333333ull;
+		v = (v | (v << 1)) & 0x5555555555555555ull;
+		return v;
+	};
+	return spread(x) | (spread(y) << 1);
+}
+
+std::uint64_t CellLayout::getHilbertKey(std::uint32_t x, std::uint32_t y, int bits)
+{
+	//Walk down the quadrants, largest first. Each quadrant is turned so its curve joins up with the next one's.
+	std::uint64_t key = 0;
+	for (std::uint32_t s = (std::uint32_t)1 << (bits - 1); s > 0; s >>= 1)
+	{
+		std::uint32_t rx = (x & s) != 0;
+		std::uint32_t ry = (y & s) != 0;
+		key += (std::uint64_t)s * s * ((3 * rx) ^ ry);
+		if (ry == 0)
+		{
+			//Only the bits below s matter from here on, so flipping them all mirrors the quadrant.
+			if (rx == 1)
+			{
+				x = ~x;
+				y = ~y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return key;
+}
+
+std::string CellLayout::getName(Curve curve)
+{
+	switch (curve)
+	{
+	case MORTON:
+		return "morton";
+	case HILBERT:
+		return "hilbert";
+	default:
+		return "insertion";
+	}
+}
+
+bool CellLayout::fromName(const std::string& name, Curve& curve)
+{
+	for (auto candidate : getCurves())
+	{
+		if (getName(candidate) == name)
+		{
+			curve = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<CellLayout::Curve> CellLayout::getCurves()
+{
+	return {INSERTION, MORTON, HILBERT};
+}
@@ -0,0 +1,336 @@
+#include "CellStore.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+CellStore::CellStore()
+	: mTable(std::make_shared<Table>()),
+	  mOwnsTable(true),
+	  mSize(0),
+	  mCopiedChunks(0),
+	  mMaxResident(0),
+	  mResident(0),
+	  mTick(0),
+	  mLastChunk(std::numeric_limits<std::size_t>::max())
+{
+}
+
+CellStore::CellStore(const std::vector<Cell>& cells)
+	: CellStore()
+{
+	for (auto& cell : cells)
+	{
+		push_back(cell);
+	}
+}
+
+CellStore::CellStore(const CellStore& other)
+	: mTable(other.mTable),
+	  mOwnsTable(false),
+	  mSize(other.mSize),
+	  mCopiedChunks(other.mCopiedChunks),
+	  mPager(other.mPager),
+	  mMaxResident(other.mMaxResident),
+	  mResident(other.mResident),
+	  mTick(other.mTick),
+	  mLastChunk(other.mLastChunk)
+{
+}
+
+CellStore& CellStore::operator=(const CellStore& other)
+{
+	mTable		  = other.mTable;
+	mOwnsTable	  = false;
+	mSize		  = other.mSize;
+	mCopiedChunks = other.mCopiedChunks;
+	mPager		  = other.mPager;
+	mMaxResident  = other.mMaxResident;
+	mResident	  = other.mResident;
+	mTick		  = other.mTick;
+	mLastChunk	  = other.mLastChunk;
+	mScratchPage.reset();
+	return *this;
+}
+
+std::size_t CellStore::size() const
+{
+	return mSize;
+}
+
+bool CellStore::empty() const
+{
+	return mSize == 0;
+}
+
+const Cell& CellStore::operator[](std::size_t i) const
+{
+	return readChunk(i / CHUNK_SIZE)[i % CHUNK_SIZE];
+}
+
+void CellStore::set(std::size_t i, const Cell& c)
+{
+	Cell& old = editChunk(i / CHUNK_SIZE)[i % CHUNK_SIZE];
+	(*mTable)[i / CHUNK_SIZE].active += (int)isActive(c) - (int)isActive(old);
+	old = c;
+}
+
+void CellStore::push_back(const Cell& c)
+{
+	//Start a new chunk once the last one is full.
+	bool added = mSize % CHUNK_SIZE == 0;
+	if (added)
+	{
+		auto chunk = std::make_shared<Chunk>();
+		chunk->reserve(CHUNK_SIZE);
+		Entry entry;
+		entry.chunk = chunk;
+		editTable().push_back(entry);
+		mResident++;
+	}
+	editChunk(mSize / CHUNK_SIZE).push_back(c);
+	(*mTable)[mSize / CHUNK_SIZE].active += isActive(c);
+	mSize++;
+
+	if (added)
+	{
+		trim();
+	}
+}
+
+void CellStore::erase(std::size_t i)
+{
+	//Copy the last cell, since moving it can page out the chunk it's in.
+	if (i != mSize - 1)
+	{
+		Cell last = (*this)[mSize - 1];
+		set(i, last);
+	}
+
+	//Drop the last cell, and its chunk once it's empty.
+	std::size_t last = (mSize - 1) / CHUNK_SIZE;
+	Chunk& chunk	 = editChunk(last);
+	(*mTable)[last].active -= isActive(chunk.back());
+	chunk.pop_back();
+	if (chunk.empty())
+	{
+		editTable().pop_back();
+		mResident--;
+	}
+	mSize--;
+}
+
+void CellStore::clear()
+{
+	mTable	   = std::make_shared<Table>();
+	mOwnsTable = true;
+	mSize	   = 0;
+	mResident  = 0;
+	mLastChunk = std::numeric_limits<std::size_t>::max();
+	mScratchPage.reset();
+}
+
+std::vector<Cell> CellStore::toVector() const
+{
+	std::vector<Cell> cells;
+	cells.reserve(mSize);
+	Chunk paged;
+	for (auto& entry : *mTable)
+	{
+		//Read paged out chunks straight from the file, without putting them back in memory.
+		if (!entry.chunk)
+		{
+			readPage(*entry.page, paged);
+		}
+		const Chunk& chunk = entry.chunk ? *entry.chunk : paged;
+		cells.insert(cells.end(), chunk.begin(), chunk.end());
+	}
+	return cells;
+}
+
+std::size_t CellStore::getCopiedChunks() const
+{
+	return mCopiedChunks;
+}
+
+bool CellStore::isShared() const
+{
+	if (mTable.use_count() > 1)
+	{
+		return true;
+	}
+	for (auto& entry : *mTable)
+	{
+		if (entry.chunk.use_count() > 1)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void CellStore::setPaging(std::shared_ptr<ChunkPager> pager, std::size_t maxResident)
+{
+	//Bring everything back from the old file first.
+	if (mPager)
+	{
+		mMaxResident = std::numeric_limits<std::size_t>::max();
+		Table& table = editTable();
+		for (std::size_t i = 0; i < table.size(); ++i)
+		{
+			readChunk(i);
+			table[i].page.reset();
+		}
+	}
+
+	mPager		 = pager;
+	mMaxResident = std::max<std::size_t>(maxResident, 2);
+	trim();
+}
+
+std::shared_ptr<ChunkPager> CellStore::getPager() const
+{
+	return mPager;
+}
+
+std::size_t CellStore::getChunks() const
+{
+	return mTable->size();
+}
+
+std::size_t CellStore::getResidentChunks() const
+{
+	return mResident;
+}
+
+CellStore::Table& CellStore::editTable() const
+{
+	//use_count() can only overestimate while another thread drops its copy, which just costs a spare copy.
+	if (!mOwnsTable || mTable.use_count() > 1)
+	{
+		mTable	   = std::make_shared<Table>(*mTable);
+		mOwnsTable = true;
+	}
+	return *mTable;
+}
+
+CellStore::Chunk& CellStore::editChunk(std::size_t chunk)
+{
+	//Own the table first, so a paged out chunk is read back into it rather than into scratch space.
+	editTable();
+	readChunk(chunk);
+	Entry& entry = (*mTable)[chunk];
+	if (entry.chunk.use_count() > 1)
+	{
+		auto copy = std::make_shared<Chunk>(*entry.chunk);
+		copy->reserve(CHUNK_SIZE);
+		entry.chunk = copy;
+		mCopiedChunks++;
+	}
+
+	//The copy on disk is about to be out of date.
+	entry.page.reset();
+
+	//The table holds const chunks so shared ones can't be written by accident;
+	//this one is owned by this store alone now.
+	return const_cast<Chunk&>(*entry.chunk);
+}
+
+const CellStore::Chunk& CellStore::readChunk(std::size_t chunk) const
+{
+	//Without paging, or when hitting the same chunk again, there's nothing to keep track of.
+	const Entry& current = (*mTable)[chunk];
+	if (!mPager || (chunk == mLastChunk && current.chunk))
+	{
+		return *current.chunk;
+	}
+
+	//The table may be read by another store on another thread, so leave it alone,
+	//and read paged out chunks into scratch space instead.
+	if (!mOwnsTable || mTable.use_count() > 1)
+	{
+		if (current.chunk)
+		{
+			return *current.chunk;
+		}
+		if (mScratchPage != current.page)
+		{
+			readPage(*current.page, mScratch);
+			mScratchPage = current.page;
+		}
+		return mScratch;
+	}
+
+	Entry& entry = (*mTable)[chunk];
+	if (chunk != mLastChunk)
+	{
+		mTick++;
+		mLastChunk = chunk;
+	}
+	entry.used = mTick;
+
+	if (!entry.chunk)
+	{
+		auto loaded = std::make_shared<Chunk>();
+		readPage(*entry.page, *loaded);
+		entry.chunk = loaded;
+		mResident++;
+		trim();
+	}
+	return *entry.chunk;
+}
+
+void CellStore::readPage(const ChunkPager::Page& page, Chunk& cells) const
+{
+	//The cells only exist on disk now, so there's nothing sensible to carry on with.
+	if (!mPager->read(page, cells))
+	{
+		std::cerr << "Couldn't read a chunk back from " << mPager->getPath() << "\n";
+		std::abort();
+	}
+}
+
+void CellStore::trim() const
+{
+	if (!mPager || mResident <= mMaxResident)
+	{
+		return;
+	}
+
+	//Page out a few more than needed, so the table isn't scanned on every page in.
+	//The last two chunks accessed are kept, since references into them may still be in use.
+	Table& table	   = editTable();
+	std::size_t target = mMaxResident - mMaxResident / 8;
+	std::vector<std::pair<std::uint64_t, std::size_t>> cold;
+	for (std::size_t i = 0; i < table.size(); ++i)
+	{
+		if (table[i].chunk && table[i].active == 0 && table[i].used + 1 < mTick)
+		{
+			cold.emplace_back(table[i].used, i);
+		}
+	}
+	std::size_t count = std::min(cold.size(), mResident - target);
+	std::partial_sort(cold.begin(), cold.begin() + count, cold.end());
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		//Unchanged chunks are still on disk, so they can just be dropped.
+		Entry& entry = table[cold[i].second];
+		if (!entry.page)
+		{
+			entry.page = mPager->write(*entry.chunk);
+			if (!entry.page)
+			{
+				continue;
+			}
+		}
+		entry.chunk.reset();
+		mResident--;
+	}
+}
+
+bool CellStore::isActive(const Cell& c)
+{
+	return c.getType() == Cell::HEAD || c.getType() == Cell::TAIL;
+}
@@ -0,0 +1,133 @@
+#include "ChunkPager.hpp"
+
+ChunkPager::Page::Page(std::shared_ptr<ChunkPager> pager, std::size_t index, std::size_t count)
+	: mPager(pager),
+	  mIndex(index),
+	  mCount(count)
+{
+}
+
+ChunkPager::Page::~Page()
+{
+	mPager->release(mIndex);
+}
+
+std::size_t ChunkPager::Page::getCount() const
+{
+	return mCount;
+}
+
+ChunkPager::ChunkPager(const std::string& path, std::size_t pageCells)
+	: mPath(path),
+	  mFile(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc),
+	  mPageCells(pageCells),
+	  mPageCount(0),
+	  mWrites(0),
+	  mReads(0),
+	  mBuffer(pageCells * CELL_BYTES)
+{
+}
+
+std::shared_ptr<ChunkPager> ChunkPager::create(const std::string& path, std::size_t pageCells)
+{
+	std::shared_ptr<ChunkPager> pager(new ChunkPager(path, pageCells));
+	return pager->mFile ? pager : nullptr;
+}
+
+std::shared_ptr<const ChunkPager::Page> ChunkPager::write(const std::vector<Cell>& cells)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (cells.size() > mPageCells)
+	{
+		return nullptr;
+	}
+
+	//Reuse a free page, or grow the file by one.
+	std::size_t index;
+	if (!mFreePages.empty())
+	{
+		index = mFreePages.back();
+		mFreePages.pop_back();
+	}
+	else
+	{
+		index = mPageCount++;
+	}
+
+	char* out = mBuffer.data();
+	for (auto& cell : cells)
+	{
+		std::int64_t x = cell.getPosition().x, y = cell.getPosition().y;
+		*out++		   = (char)cell.getType();
+		std::memcpy(out, &x, 8);
+		std::memcpy(out + 8, &y, 8);
+		out += 16;
+	}
+	mFile.seekp(index * mPageCells * CELL_BYTES);
+	mFile.write(mBuffer.data(), cells.size() * CELL_BYTES);
+	if (!mFile)
+	{
+		mFile.clear();
+		mFreePages.push_back(index);
+		return nullptr;
+	}
+
+	mWrites++;
+	return std::make_shared<const Page>(shared_from_this(), index, cells.size());
+}
+
+bool ChunkPager::read(const Page& page, std::vector<Cell>& cells)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFile.seekg(page.mIndex * mPageCells * CELL_BYTES);
+	mFile.read(mBuffer.data(), page.mCount * CELL_BYTES);
+	if (!mFile)
+	{
+		mFile.clear();
+		return false;
+	}
+
+	cells.clear();
+	cells.reserve(mPageCells);
+	const char* in = mBuffer.data();
+	for (std::size_t i = 0; i < page.mCount; ++i)
+	{
+		std::int64_t x, y;
+		std::memcpy(&x, in + 1, 8);
+		std::memcpy(&y, in + 9, 8);
+		cells.emplace_back((Cell::Type)*in, WorldPos(x, y));
+		in += CELL_BYTES;
+	}
+
+	mReads++;
+	return true;
+}
+
+std::string ChunkPager::getPath()
+{
+	return mPath;
+}
+
+std::size_t ChunkPager::getPages()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mPageCount - mFreePages.size();
+}
+
+std::size_t ChunkPager::getWrites()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mWrites;
+}
+
+std::size_t ChunkPager::getReads()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mReads;
+}
+
+void ChunkPager::release(std::size_t index)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFreePages.push_back(index);
+}
@@ -0,0 +1,531 @@
+#include "CircuitEngine.hpp"
+
+CircuitEngine::CircuitEngine()
+	: mCompiled(false),
+	  mTables(CircuitRecognizer::getShapes().size()),
+	  mNativeCells(0)
+{
+}
+
+std::string CircuitEngine::getName() const
+{
+	return "circuit";
+}
+
+void CircuitEngine::invalidate()
+{
+	mCompiled = false;
+}
+
+std::size_t CircuitEngine::getPrunedCells() const
+{
+	return mCompiled ? mComponents.getDeadCells() : 0;
+}
+
+std::size_t CircuitEngine::getNativeCells() const
+{
+	return mCompiled ? mNativeCells : 0;
+}
+
+const CircuitRecognizer& CircuitEngine::getRecognizer() const
+{
+	return mRecognizer;
+}
+
+void CircuitEngine::compile(const CellStore& cells)
+{
+	//Finding the parts is the slow bit, so it's what's worth caching.
+	std::uint64_t key = mCache ? CompileCache::hashLayout(cells) : 0;
+	CompileCache::Reader in;
+	if (!mCache || !mCache->load(getName(), CACHE_VERSION, key, in) || !mComponents.load(in, cells) ||
+		!mRecognizer.load(in, cells.size()) || !in.isDone())
+	{
+		mComponents.analyze(cells);
+		mRecognizer.analyze(cells, mComponents.getIndex());
+		if (mCache)
+		{
+			CompileCache::Writer out;
+			mComponents.save(out);
+			mRecognizer.save(out);
+			mCache->store(getName(), CACHE_VERSION, key, out);
+		}
+	}
+	const std::vector<std::uint32_t>& offsets	= mComponents.getOffsets();
+	const std::vector<std::uint32_t>& neighbors = mComponents.getNeighbors();
+
+	mTypes.resize(cells.size());
+	mPositions.resize(cells.size());
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		mTypes[i]	  = cells[i].getType();
+		mPositions[i] = cells[i].getPosition();
+	}
+
+	//Units, with their state taken from the cells.
+	mUnitOf.assign(cells.size(), NO_UNIT);
+	mSlotOf.assign(cells.size(), 0);
+	mUnits.clear();
+	mNativeCells = 0;
+	for (auto& part : mRecognizer.getParts())
+	{
+		Unit unit;
+		unit.cells	= part.cells;
+		unit.wire	= part.kind == CircuitRecognizer::WIRE || part.kind == CircuitRecognizer::CLOCK;
+		unit.cycle	= part.cycle;
+		unit.shape	= part.shape;
+		unit.state	= 0;
+		unit.queued = false;
+		unit.dirty	= false;
+		if (unit.wire)
+		{
+			std::size_t words = (unit.cells.size() + 63) / 64;
+			unit.heads.assign(words, 0);
+			unit.tails.assign(words, 0);
+		}
+		for (std::size_t slot = 0; slot < unit.cells.size(); ++slot)
+		{
+			std::uint32_t i = unit.cells[slot];
+			mUnitOf[i]		= mUnits.size();
+			mSlotOf[i]		= slot;
+			if (!unit.wire)
+			{
+				unit.state |= (std::uint64_t)mTypes[i] << (2 * slot);
+			}
+			else if (mTypes[i] == Cell::HEAD)
+			{
+				unit.heads[slot / 64] |= 1ull << (slot % 64);
+			}
+			else if (mTypes[i] == Cell::TAIL)
+			{
+				unit.tails[slot / 64] |= 1ull << (slot % 64);
+			}
+		}
+		unit.shownHeads = unit.heads;
+		unit.shownTails = unit.tails;
+		unit.shownState = unit.state;
+		mNativeCells += unit.cells.size();
+		mUnits.push_back(std::move(unit));
+	}
+
+	auto forNeighbors = [&](std::uint32_t i, auto&& visit) {
+		for (std::uint32_t n = offsets[i]; n < offsets[i + 1]; ++n)
+		{
+			visit(neighbors[n]);
+		}
+	};
+
+	//Every unit reads the cells touching it from outside.
+	std::vector<std::uint32_t> watchCounts(cells.size() + 1, 0);
+	for (std::uint32_t u = 0; u < mUnits.size(); ++u)
+	{
+		Unit& unit = mUnits[u];
+		for (std::uint32_t slot = 0; slot < unit.cells.size(); ++slot)
+		{
+			forNeighbors(unit.cells[slot], [&](std::uint32_t n) {
+				if (mUnitOf[n] != u)
+				{
+					unit.edges.push_back({slot, n});
+					watchCounts[n + 1]++;
+				}
+			});
+		}
+	}
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		watchCounts[i + 1] += watchCounts[i];
+	}
+	mWatchOffsets = watchCounts;
+	mWatchers.resize(mWatchOffsets.back());
+	for (std::uint32_t u = 0; u < mUnits.size(); ++u)
+	{
+		for (auto& edge : mUnits[u].edges)
+		{
+			mWatchers[watchCounts[edge.second]++] = u;
+		}
+	}
+
+	//The cells of each unit that others read.
+	for (auto& unit : mUnits)
+	{
+		unit.watched.assign(unit.heads.size(), 0);
+		unit.watchedState = 0;
+		for (std::uint32_t slot = 0; slot < unit.cells.size(); ++slot)
+		{
+			std::uint32_t i = unit.cells[slot];
+			if (mWatchOffsets[i] == mWatchOffsets[i + 1])
+			{
+				continue;
+			}
+			if (unit.wire)
+			{
+				unit.watched[slot / 64] |= 1ull << (slot % 64);
+			}
+			else
+			{
+				unit.watchedState |= 2ull << (2 * slot);
+			}
+		}
+	}
+
+	//The cells left over only need their neighbors that are left over too, units count for themselves.
+	mOffsets.assign(1, 0);
+	mNeighbors.clear();
+	mHeads.clear();
+	mTails.clear();
+	for (std::uint32_t i = 0; i < cells.size(); ++i)
+	{
+		if (mUnitOf[i] == NO_UNIT && mComponents.isLive(i))
+		{
+			if (mTypes[i] == Cell::HEAD)
+			{
+				mHeads.push_back(i);
+			}
+			else if (mTypes[i] == Cell::TAIL)
+			{
+				mTails.push_back(i);
+			}
+			forNeighbors(i, [&](std::uint32_t n) {
+				if (mUnitOf[n] == NO_UNIT)
+				{
+					mNeighbors.push_back(n);
+				}
+			});
+		}
+		mOffsets.push_back(mNeighbors.size());
+	}
+	mCounts.assign(cells.size(), 0);
+	mDirtyCells.clear();
+	mDirtyUnits.clear();
+	mCellDirty.assign(cells.size(), false);
+
+	//Every unit is stepped once, and from then on only while busy or woken.
+	mActive.clear();
+	mNextActive.clear();
+	for (std::uint32_t u = 0; u < mUnits.size(); ++u)
+	{
+		wake(u);
+	}
+
+	mCompiled = true;
+}
+
+void CircuitEngine::step(CellStore& cells, std::vector<Cell>& changed)
+{
+	advance(cells, 1, changed);
+}
+
+void CircuitEngine::advance(CellStore& cells, std::size_t generations, std::vector<Cell>& changed)
+{
+	changed.clear();
+	if (!mCompiled)
+	{
+		compile(cells);
+	}
+
+	for (std::size_t gen = 0; gen < generations; ++gen)
+	{
+		tick();
+	}
+	flush(cells, changed);
+}
+
+void CircuitEngine::tick()
+{
+	mActive.swap(mNextActive);
+	mNextActive.clear();
+	for (auto& u : mActive)
+	{
+		mUnits[u].queued = false;
+	}
+
+	//Count the heads next to loose wires, from the loose heads, then from the units' heads.
+	mTouched.clear();
+	auto count = [this](std::uint32_t n) {
+		if (mTypes[n] == Cell::WIRE && mCounts[n]++ == 0)
+		{
+			mTouched.push_back(n);
+		}
+	};
+	for (auto& head : mHeads)
+	{
+		for (std::uint32_t i = mOffsets[head]; i < mOffsets[head + 1]; ++i)
+		{
+			count(mNeighbors[i]);
+		}
+	}
+	for (auto& u : mActive)
+	{
+		Unit& unit = mUnits[u];
+		for (auto& edge : unit.edges)
+		{
+			if (mUnitOf[edge.second] != NO_UNIT)
+			{
+				continue;
+			}
+			bool head = unit.wire ? (unit.heads[edge.first / 64] >> (edge.first % 64)) & 1
+								  : ((unit.state >> (2 * edge.first)) & 3) == Cell::HEAD;
+			if (head)
+			{
+				count(edge.second);
+			}
+		}
+		evaluate(unit);
+	}
+	mNewHeads.clear();
+	for (auto& wire : mTouched)
+	{
+		if (mCounts[wire] <= 2)
+		{
+			mNewHeads.push_back(wire);
+		}
+		mCounts[wire] = 0;
+	}
+
+	//Everything was worked out from the old types, so now they can change.
+	for (auto& tail : mTails)
+	{
+		setLoose(tail, Cell::WIRE);
+	}
+	for (auto& head : mHeads)
+	{
+		setLoose(head, Cell::TAIL);
+	}
+	for (auto& wire : mNewHeads)
+	{
+		setLoose(wire, Cell::HEAD);
+	}
+	mTails.swap(mHeads);
+	mHeads.swap(mNewHeads);
+
+	for (auto& u : mActive)
+	{
+		Unit& unit	 = mUnits[u];
+		bool busy	 = false;
+		bool changed = false;
+		if (unit.wire)
+		{
+			//Heads become tails, and only the cells others read need to wake anyone.
+			for (std::size_t w = 0; w < unit.heads.size(); ++w)
+			{
+				std::uint64_t heads = unit.heads[w], next = unit.nextHeads[w];
+				for (std::uint64_t woken = next & unit.watched[w]; woken; woken &= woken - 1)
+				{
+					wakeWatchers(unit.cells[w * 64 + __builtin_ctzll(woken)]);
+				}
+				changed		  = changed || heads || unit.tails[w] || next;
+				unit.tails[w] = heads;
+				unit.heads[w] = next;
+				busy		  = busy || heads || next;
+			}
+		}
+		else
+		{
+			//Heads are 10 in binary, so the high bit without the low one.
+			std::uint64_t heads = unit.next & 0xAAAAAAAAAAAAAAAAull & ~(unit.next << 1);
+			for (std::uint64_t woken = heads & unit.watchedState; woken; woken &= woken - 1)
+			{
+				wakeWatchers(unit.cells[__builtin_ctzll(woken) / 2]);
+			}
+			changed	   = unit.state != unit.next;
+			unit.state = unit.next;
+
+			//Heads & tails have the high bit set, wires don't.
+			busy = unit.state & 0xAAAAAAAAAAAAAAAAull;
+		}
+		if (changed && !unit.dirty)
+		{
+			unit.dirty = true;
+			mDirtyUnits.push_back(u);
+		}
+		if (busy)
+		{
+			wake(u);
+		}
+	}
+}
+
+void CircuitEngine::flush(CellStore& cells, std::vector<Cell>& changed)
+{
+	auto write = [&](std::uint32_t i, Cell::Type type) {
+		Cell cell(type, mPositions[i]);
+		mTypes[i] = type;
+		cells.set(i, cell);
+		changed.push_back(cell);
+	};
+
+	//Loose cells can change back within a few generations, then there's nothing to write.
+	for (auto& i : mDirtyCells)
+	{
+		mCellDirty[i] = false;
+		if (cells[i].getType() != mTypes[i])
+		{
+			write(i, (Cell::Type)mTypes[i]);
+		}
+	}
+	mDirtyCells.clear();
+
+	for (auto& u : mDirtyUnits)
+	{
+		Unit& unit = mUnits[u];
+		unit.dirty = false;
+		if (unit.wire)
+		{
+			for (std::size_t w = 0; w < unit.heads.size(); ++w)
+			{
+				std::uint64_t heads = unit.heads[w], tails = unit.tails[w];
+				for (std::uint64_t diff = (heads ^ unit.shownHeads[w]) | (tails ^ unit.shownTails[w]); diff; diff &= diff - 1)
+				{
+					int bit			= __builtin_ctzll(diff);
+					std::uint64_t b = 1ull << bit;
+					write(unit.cells[w * 64 + bit], (heads & b) ? Cell::HEAD : (tails & b) ? Cell::TAIL : Cell::WIRE);
+				}
+				unit.shownHeads[w] = heads;
+				unit.shownTails[w] = tails;
+			}
+		}
+		else
+		{
+			std::uint64_t diff = unit.state ^ unit.shownState;
+			for (std::size_t slot = 0; diff >> (2 * slot); ++slot)
+			{
+				if ((diff >> (2 * slot)) & 3)
+				{
+					write(unit.cells[slot], (Cell::Type)((unit.state >> (2 * slot)) & 3));
+				}
+			}
+			unit.shownState = unit.state;
+		}
+	}
+	mDirtyUnits.clear();
+}
+
+void CircuitEngine::evaluate(Unit& unit)
+{
+	if (!unit.wire)
+	{
+		std::uint64_t inputs = 0;
+		for (auto& edge : unit.edges)
+		{
+			std::uint64_t shift = 2 * edge.first;
+			if (isHead(edge.second) && ((inputs >> shift) & 3) < 3)
+			{
+				inputs += 1ull << shift;
+			}
+		}
+		unit.next = lookup(unit.shape, unit.state, inputs);
+		return;
+	}
+
+	//Every cell touches just the cells before & after it, so a wire becomes a head next to any head.
+	std::size_t length = unit.cells.size(), words = unit.heads.size();
+	std::vector<std::uint64_t>& heads = unit.heads;
+	unit.nextHeads.resize(words);
+	for (std::size_t w = 0; w < words; ++w)
+	{
+		std::uint64_t up   = (heads[w] << 1) | (w > 0 ? heads[w - 1] >> 63 : 0);
+		std::uint64_t down = (heads[w] >> 1) | (w + 1 < words ? heads[w + 1] << 63 : 0);
+		unit.nextHeads[w]  = up | down;
+	}
+	std::size_t last = length - 1;
+	if (unit.cycle)
+	{
+		unit.nextHeads[0] |= (heads[last / 64] >> (last % 64)) & 1;
+		unit.nextHeads[last / 64] |= (heads[0] & 1) << (last % 64);
+	}
+	for (auto& edge : unit.edges)
+	{
+		if (isHead(edge.second))
+		{
+			unit.nextHeads[edge.first / 64] |= 1ull << (edge.first % 64);
+		}
+	}
+	for (std::size_t w = 0; w < words; ++w)
+	{
+		std::uint64_t valid = w + 1 < words || length % 64 == 0 ? ~0ull : (1ull << (length % 64)) - 1;
+		unit.nextHeads[w] &= ~heads[w] & ~unit.tails[w] & valid;
+	}
+}
+
+bool CircuitEngine::isHead(std::uint32_t cell) const
+{
+	std::uint32_t u = mUnitOf[cell];
+	if (u == NO_UNIT)
+	{
+		return mTypes[cell] == Cell::HEAD;
+	}
+	const Unit& unit   = mUnits[u];
+	std::uint32_t slot = mSlotOf[cell];
+	return unit.wire ? (unit.heads[slot / 64] >> (slot % 64)) & 1 : ((unit.state >> (2 * slot)) & 3) == Cell::HEAD;
+}
+
+void CircuitEngine::setLoose(std::uint32_t cell, Cell::Type type)
+{
+	mTypes[cell] = type;
+	if (!mCellDirty[cell])
+	{
+		mCellDirty[cell] = true;
+		mDirtyCells.push_back(cell);
+	}
+	if (type == Cell::HEAD)
+	{
+		wakeWatchers(cell);
+	}
+}
+
+std::uint64_t CircuitEngine::lookup(std::uint32_t shape, std::uint64_t state, std::uint64_t inputs)
+{
+	std::uint64_t key = state | (inputs << 32);
+	auto found		  = mTables[shape].find(key);
+	if (found != mTables[shape].end())
+	{
+		return found->second;
+	}
+
+	//Step the gate's cells by the usual rules, once.
+	const CircuitRecognizer::Shape& s = CircuitRecognizer::getShapes()[shape];
+	auto type						  = [](std::uint64_t state, std::size_t slot) {
+		 return (state >> (2 * slot)) & 3;
+	};
+	std::uint64_t next = 0;
+	for (std::size_t slot = 0; slot < s.cells.size(); ++slot)
+	{
+		std::uint64_t t = type(state, slot);
+		if (t == Cell::HEAD)
+		{
+			t = Cell::TAIL;
+		}
+		else if (t == Cell::TAIL)
+		{
+			t = Cell::WIRE;
+		}
+		else
+		{
+			std::uint64_t heads = type(inputs, slot);
+			for (auto& n : s.neighbors[slot])
+			{
+				heads += type(state, n) == Cell::HEAD;
+			}
+			t = (heads == 1 || heads == 2) ? Cell::HEAD : Cell::WIRE;
+		}
+		next |= t << (2 * slot);
+	}
+	mTables[shape][key] = next;
+	return next;
+}
+
+void CircuitEngine::wake(std::uint32_t unit)
+{
+	if (!mUnits[unit].queued)
+	{
+		mUnits[unit].queued = true;
+		mNextActive.push_back(unit);
+	}
+}
+
+void CircuitEngine::wakeWatchers(std::uint32_t cell)
+{
+	for (std::uint32_t i = mWatchOffsets[cell]; i < mWatchOffsets[cell + 1]; ++i)
+	{
+		wake(mWatchers[i]);
+	}
+}
@@ -0,0 +1,374 @@
+#include "CircuitRecognizer.hpp"
+
+#include <algorithm>
+
+const WorldPos CircuitRecognizer::NEIGHBORS[8] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0},
+													  {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+void CircuitRecognizer::analyze(const CellStore& cells, const WireComponents::Index& index)
+{
+	mParts.clear();
+	mClaimed.assign(cells.size(), false);
+	std::fill(std::begin(mCounts), std::end(mCounts), 0);
+
+	mMasks.resize(cells.size());
+	for (std::uint32_t i = 0; i < cells.size(); ++i)
+	{
+		mMasks[i] = 0;
+		for (int n = 0; n < 8; ++n)
+		{
+			mMasks[i] |= index.count(cells[i].getPosition() + NEIGHBORS[n]) << n;
+		}
+	}
+
+	//Gates first, so the wires don't run into them, and the biggest first, whatever order the cells are in:
+	//an XOR's output end, with its wire, is shaped like a diode.
+	const std::vector<Shape>& shapes = getShapes();
+	static const std::vector<std::uint32_t> order = [&shapes]() {
+		std::vector<std::uint32_t> order(shapes.size());
+		for (std::uint32_t s = 0; s < shapes.size(); ++s)
+		{
+			order[s] = s;
+		}
+		std::stable_sort(order.begin(), order.end(), [&shapes](std::uint32_t a, std::uint32_t b) {
+			return shapes[a].cells.size() > shapes[b].cells.size();
+		});
+		return order;
+	}();
+	for (auto s : order)
+	{
+		for (std::uint32_t i = 0; i < cells.size(); ++i)
+		{
+			if (!mClaimed[i] && (mMasks[i] & shapes[s].required) == shapes[s].required &&
+				!(mMasks[i] & shapes[s].forbidden))
+			{
+				matchShape(cells, index, i, s);
+			}
+		}
+	}
+
+	//Then the wires, in whatever's left.
+	for (std::uint32_t i = 0; i < cells.size(); ++i)
+	{
+		if (!mClaimed[i] && __builtin_popcount(mMasks[i]) == 2)
+		{
+			traceWire(cells, index, i);
+		}
+	}
+}
+
+void CircuitRecognizer::save(CompileCache::Writer& out) const
+{
+	out.write<std::uint64_t>(mParts.size());
+	for (auto& part : mParts)
+	{
+		out.write<std::uint32_t>(part.kind);
+		out.write(part.shape);
+		out.write<std::uint8_t>(part.cycle);
+		out.write(part.cells);
+	}
+}
+
+bool CircuitRecognizer::load(CompileCache::Reader& in, std::size_t cells)
+{
+	mParts.clear();
+	std::fill(std::begin(mCounts), std::end(mCounts), 0);
+	std::uint64_t parts;
+	if (!in.read(parts))
+	{
+		return false;
+	}
+
+	const std::vector<Shape>& shapes = getShapes();
+	for (std::uint64_t p = 0; p < parts; ++p)
+	{
+		Part part;
+		std::uint32_t kind;
+		std::uint8_t cycle;
+		if (!in.read(kind) || !in.read(part.shape) || !in.read(cycle) || !in.read(part.cells) || kind >= KINDS)
+		{
+			return false;
+		}
+		part.kind  = (Kind)kind;
+		part.cycle = cycle;
+
+		//Gates must still fit their shape, in case the shapes changed without the cache version.
+		bool wire = part.kind == WIRE || part.kind == CLOCK;
+		if (part.cells.empty() ||
+			(!wire && (part.shape >= shapes.size() || shapes[part.shape].cells.size() != part.cells.size())))
+		{
+			return false;
+		}
+		for (auto& i : part.cells)
+		{
+			if (i >= cells)
+			{
+				return false;
+			}
+		}
+		mCounts[part.kind]++;
+		mParts.push_back(std::move(part));
+	}
+	return true;
+}
+
+const std::vector<CircuitRecognizer::Part>& CircuitRecognizer::getParts() const
+{
+	return mParts;
+}
+
+std::size_t CircuitRecognizer::getCount(Kind kind) const
+{
+	return mCounts[kind];
+}
+
+const std::vector<CircuitRecognizer::Shape>& CircuitRecognizer::getShapes()
+{
+	//Signals go in on the left, and out on the right.
+	static const std::vector<Shape> shapes = []() {
+		std::vector<Shape> shapes;
+		addShapes(shapes, DIODE,
+				  {".##",
+				   "##.",
+				   ".##"});
+		//Two inputs on the left at the corners.
+		addShapes(shapes, OR,
+				  {"#...",
+				   ".#..",
+				   "####",
+				   ".#..",
+				   "#..."});
+		addShapes(shapes, XOR,
+				  {"##...",
+				   "..#..",
+				   ".####",
+				   ".#..#",
+				   ".####",
+				   "..#..",
+				   "##..."});
+		//A on the left of the middle row, B from below the middle column, 2 generations after A.
+		addShapes(shapes, AND_NOT,
+				  {"#...#",
+				   ".#.#.",
+				   "..#..",
+				   ".###."});
+		return shapes;
+	}();
+	return shapes;
+}
+
+const char* CircuitRecognizer::getName(Kind kind)
+{
+	static const char* names[KINDS] = {"wire", "clock", "diode", "or", "xor", "and-not"};
+	return names[kind];
+}
+
+void CircuitRecognizer::addShapes(std::vector<Shape>& shapes, Kind kind, const std::vector<std::string>& drawing)
+{
+	std::vector<WorldPos> cells, empty;
+	for (int y = 0; y < (int)drawing.size(); ++y)
+	{
+		for (int x = 0; x < (int)drawing[y].size(); ++x)
+		{
+			if (drawing[y][x] == '#')
+			{
+				cells.push_back({x, y});
+			}
+			else if (drawing[y][x] == '.')
+			{
+				empty.push_back({x, y});
+			}
+		}
+	}
+
+	//The engine packs a gate's state into 32 bits.
+	if (cells.size() > MAX_GATE_CELLS)
+	{
+		return;
+	}
+
+	auto before = [](WorldPos a, WorldPos b) {
+		return a.y != b.y ? a.y < b.y : a.x < b.x;
+	};
+
+	//4 rotations, each also mirrored.
+	std::size_t first = shapes.size();
+	for (int t = 0; t < 8; ++t)
+	{
+		auto transform = [t](WorldPos p) {
+			for (int r = 0; r < t % 4; ++r)
+			{
+				p = {-p.y, p.x};
+			}
+			return t >= 4 ? WorldPos(-p.x, p.y) : p;
+		};
+
+		Shape shape;
+		shape.kind = kind;
+		for (auto& p : cells)
+		{
+			shape.cells.push_back(transform(p));
+		}
+		for (auto& p : empty)
+		{
+			shape.empty.push_back(transform(p));
+		}
+
+		//Relative to the topmost, then leftmost cell, which is the one found first when scanning.
+		std::sort(shape.cells.begin(), shape.cells.end(), before);
+		WorldPos origin = shape.cells.front();
+		for (auto& p : shape.cells)
+		{
+			p -= origin;
+		}
+		for (auto& p : shape.empty)
+		{
+			p -= origin;
+		}
+
+		//Symmetric gates look the same in several orientations.
+		bool seen = false;
+		for (std::size_t i = first; i < shapes.size(); ++i)
+		{
+			seen = seen || shapes[i].cells == shape.cells;
+		}
+		if (seen)
+		{
+			continue;
+		}
+
+		shape.neighbors.resize(shape.cells.size());
+		for (std::size_t a = 0; a < shape.cells.size(); ++a)
+		{
+			for (std::size_t b = 0; b < shape.cells.size(); ++b)
+			{
+				WorldPos d = shape.cells[a] - shape.cells[b];
+				if (a != b && std::abs(d.x) <= 1 && std::abs(d.y) <= 1)
+				{
+					shape.neighbors[a].push_back(b);
+				}
+			}
+		}
+		shape.required	= getMask(shape.cells, {0, 0});
+		shape.forbidden = getMask(shape.empty, {0, 0});
+		shapes.push_back(shape);
+	}
+}
+
+bool CircuitRecognizer::matchShape(const CellStore& cells, const WireComponents::Index& index,
+								   std::uint32_t first, std::uint32_t shape)
+{
+	const Shape& s		= getShapes()[shape];
+	WorldPos origin = cells[first].getPosition();
+
+	Part part;
+	part.kind  = s.kind;
+	part.shape = shape;
+	part.cycle = false;
+	for (auto& offset : s.cells)
+	{
+		auto found = index.find(origin + offset);
+		if (found == index.end() || mClaimed[found->second])
+		{
+			return false;
+		}
+		part.cells.push_back(found->second);
+	}
+	for (auto& offset : s.empty)
+	{
+		if (index.count(origin + offset))
+		{
+			return false;
+		}
+	}
+
+	for (auto& i : part.cells)
+	{
+		mClaimed[i] = true;
+	}
+	mCounts[part.kind]++;
+	mParts.push_back(std::move(part));
+	return true;
+}
+
+void CircuitRecognizer::traceWire(const CellStore& cells, const WireComponents::Index& index, std::uint32_t first)
+{
+	//Walk both ways from the first cell, for as long as the cells touch exactly two others.
+	std::size_t count;
+	std::array<std::uint32_t, 8> ends = getNeighbors(cells, index, first, count);
+	std::vector<std::uint32_t> halves[2];
+	bool cycle	= false;
+	mClaimed[first] = true;
+	for (int side = 0; side < 2 && !cycle; ++side)
+	{
+		std::uint32_t prev = first, cur = ends[side];
+		while (true)
+		{
+			if (cur == first)
+			{
+				cycle = true;
+				break;
+			}
+			if (__builtin_popcount(mMasks[cur]) != 2 || mClaimed[cur])
+			{
+				break;
+			}
+			std::array<std::uint32_t, 8> next = getNeighbors(cells, index, cur, count);
+			mClaimed[cur] = true;
+			halves[side].push_back(cur);
+			std::uint32_t after = next[0] == prev ? next[1] : next[0];
+			prev				= cur;
+			cur					= after;
+		}
+	}
+
+	//Cells too short to be worth it stay claimed, so they aren't traced again, but aren't a part.
+	std::size_t length = halves[0].size() + halves[1].size() + 1;
+	if (length < MIN_WIRE_CELLS)
+	{
+		return;
+	}
+
+	Part part;
+	part.shape = 0;
+	part.cycle = cycle;
+	part.cells.assign(halves[1].rbegin(), halves[1].rend());
+	part.cells.push_back(first);
+	part.cells.insert(part.cells.end(), halves[0].begin(), halves[0].end());
+
+	//A clock is a loop, either on its own, or closed through a junction next to both ends.
+	WorldPos gap = cells[part.cells.front()].getPosition() - cells[part.cells.back()].getPosition();
+	bool loop		 = cycle || (length >= 2 * CLOCK_GAP && std::abs(gap.x) <= CLOCK_GAP && std::abs(gap.y) <= CLOCK_GAP);
+	part.kind = loop ? CLOCK : WIRE;
+	mCounts[part.kind]++;
+	mParts.push_back(std::move(part));
+}
+
+std::array<std::uint32_t, 8> CircuitRecognizer::getNeighbors(const CellStore& cells, const WireComponents::Index& index,
+															 std::uint32_t i, std::size_t& count)
+{
+	std::array<std::uint32_t, 8> neighbors;
+	count = 0;
+	for (auto& offset : NEIGHBORS)
+	{
+		auto found = index.find(cells[i].getPosition() + offset);
+		if (found != index.end())
+		{
+			neighbors[count++] = found->second;
+		}
+	}
+	return neighbors;
+}
+
+std::uint8_t CircuitRecognizer::getMask(const std::vector<WorldPos>& positions, WorldPos center)
+{
+	std::uint8_t mask = 0;
+	for (int n = 0; n < 8; ++n)
+	{
+		if (std::find(positions.begin(), positions.end(), center + NEIGHBORS[n]) != positions.end())
+		{
+			mask |= 1 << n;
+		}
+	}
+	return mask;
+}
@@ -0,0 +1,184 @@
+#include "CompileCache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+CompileCache::CompileCache(const std::string& directory, std::uintmax_t maxBytes)
+	: mDirectory(directory),
+	  mMaxBytes(maxBytes),
+	  mBytes(0),
+	  mHits(0),
+	  mMisses(0)
+{
+}
+
+std::shared_ptr<CompileCache> CompileCache::create(const std::string& directory, std::uintmax_t maxBytes)
+{
+	std::error_code err;
+	std::filesystem::create_directories(directory, err);
+	if (!std::filesystem::is_directory(directory, err))
+	{
+		return nullptr;
+	}
+
+	std::shared_ptr<CompileCache> cache(new CompileCache(directory, maxBytes));
+	cache->evict();
+	return cache;
+}
+
+std::uint64_t CompileCache::hashLayout(const CellStore& cells)
+{
+	std::uint64_t size = cells.size();
+	std::uint64_t h	   = hash((const char*)&size, sizeof(size));
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		std::int64_t pos[2] = {cells[i].getPosition().x, cells[i].getPosition().y};
+		h					= hash((const char*)pos, sizeof(pos), h);
+	}
+	return h;
+}
+
+bool CompileCache::load(const std::string& engine, std::uint32_t version, std::uint64_t key, Reader& entry)
+{
+	std::filesystem::path path = getPath(engine, key);
+	std::ifstream file(path, std::ios::binary);
+	Header header;
+	if (!file || !file.read((char*)&header, sizeof(header)))
+	{
+		mMisses++;
+		return false;
+	}
+
+	std::string data;
+	bool valid = std::memcmp(header.magic, "WWCC", 4) == 0 && header.format == FORMAT_VERSION &&
+				 header.version == version && header.key == key;
+	if (valid)
+	{
+		data.resize(header.size);
+		valid = file.read(&data[0], data.size()) && hash(data.data(), data.size()) == header.checksum;
+	}
+	file.close();
+
+	//Written by another version of the engine, or damaged, so it's no use to anyone.
+	std::error_code err;
+	if (!valid)
+	{
+		std::filesystem::remove(path, err);
+		mMisses++;
+		return false;
+	}
+
+	//Mark it as recently used, so it's evicted last.
+	std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), err);
+	entry = Reader(std::move(data));
+	mHits++;
+	return true;
+}
+
+bool CompileCache::store(const std::string& engine, std::uint32_t version, std::uint64_t key, const Writer& entry)
+{
+	const std::string& data = entry.getData();
+	Header header;
+	std::memcpy(header.magic, "WWCC", 4);
+	header.format	= FORMAT_VERSION;
+	header.version	= version;
+	header.key		= key;
+	header.size		= data.size();
+	header.checksum = hash(data.data(), data.size());
+
+	//Write next to it, then swap it in, so other processes never read half an entry.
+	std::filesystem::path path = getPath(engine, key);
+	std::filesystem::path temp = path;
+	temp += ".tmp";
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		if (!file || !file.write((const char*)&header, sizeof(header)) || !file.write(data.data(), data.size()))
+		{
+			return false;
+		}
+	}
+	std::error_code err;
+	std::filesystem::rename(temp, path, err);
+	if (err)
+	{
+		std::filesystem::remove(temp, err);
+		return false;
+	}
+
+	evict();
+	return true;
+}
+
+std::size_t CompileCache::getHits() const
+{
+	return mHits;
+}
+
+std::size_t CompileCache::getMisses() const
+{
+	return mMisses;
+}
+
+std::uintmax_t CompileCache::getBytes() const
+{
+	return mBytes;
+}
+
+std::string CompileCache::getDirectory() const
+{
+	return mDirectory.string();
+}
+
+std::filesystem::path CompileCache::getPath(const std::string& engine, std::uint64_t key) const
+{
+	std::stringstream name;
+	name << engine << "-" << std::hex << std::setw(16) << std::setfill('0') << key << ".cache";
+	return mDirectory / name.str();
+}
+
+void CompileCache::evict()
+{
+	struct File
+	{
+		std::filesystem::path path;
+		std::filesystem::file_time_type used;
+		std::uintmax_t size;
+	};
+	std::vector<File> files;
+	std::error_code err;
+	mBytes = 0;
+	for (auto& entry : std::filesystem::directory_iterator(mDirectory, err))
+	{
+		if (entry.path().extension() == ".cache")
+		{
+			File file = {entry.path(), entry.last_write_time(err), entry.file_size(err)};
+			files.push_back(file);
+			mBytes += file.size;
+		}
+	}
+
+	std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.used < b.used; });
+	for (auto& file : files)
+	{
+		if (mBytes <= mMaxBytes)
+		{
+			break;
+		}
+		if (std::filesystem::remove(file.path, err))
+		{
+			mBytes -= file.size;
+		}
+	}
+}
+
+std::uint64_t CompileCache::hash(const char* data, std::size_t size, std::uint64_t seed)
+{
+	std::uint64_t h = seed;
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		h = (h ^ (unsigned char)data[i]) * 1099511628211ull;
+	}
+	return h;
+}
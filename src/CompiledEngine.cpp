@@ -0,0 +1,121 @@
+#include "CompiledEngine.hpp"
+
+CompiledEngine::CompiledEngine()
+	: mCompiled(false)
+{
+}
+
+std::string CompiledEngine::getName() const
+{
+	return "compiled";
+}
+
+void CompiledEngine::invalidate()
+{
+	mCompiled = false;
+}
+
+void CompiledEngine::compile(const CellStore& cells)
+{
+	std::uint64_t key = mCache ? CompileCache::hashLayout(cells) : 0;
+	CompileCache::Reader in;
+	if (!mCache || !mCache->load(getName(), CACHE_VERSION, key, in) || !mComponents.load(in, cells) || !in.isDone())
+	{
+		mComponents.analyze(cells);
+		if (mCache)
+		{
+			CompileCache::Writer out;
+			mComponents.save(out);
+			mCache->store(getName(), CACHE_VERSION, key, out);
+		}
+	}
+	const std::vector<std::uint32_t>& offsets	= mComponents.getOffsets();
+	const std::vector<std::uint32_t>& neighbors = mComponents.getNeighbors();
+
+	mTypes.resize(cells.size());
+	mOffsets.assign(1, 0);
+	mNeighbors.clear();
+	mHeads.clear();
+	mTails.clear();
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		mTypes[i] = cells[i].getType();
+		if (mTypes[i] == Cell::HEAD)
+		{
+			mHeads.push_back(i);
+		}
+		else if (mTypes[i] == Cell::TAIL)
+		{
+			mTails.push_back(i);
+		}
+
+		//Dead cells are never next to a head, so they don't need neighbors.
+		if (mComponents.isLive(i))
+		{
+			mNeighbors.insert(mNeighbors.end(), neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1]);
+		}
+		mOffsets.push_back(mNeighbors.size());
+	}
+
+	mCounts.assign(cells.size(), 0);
+	mCompiled = true;
+}
+
+std::size_t CompiledEngine::getPrunedCells() const
+{
+	return mCompiled ? mComponents.getDeadCells() : 0;
+}
+
+void CompiledEngine::step(CellStore& cells, std::vector<Cell>& changed)
+{
+	changed.clear();
+	if (!mCompiled)
+	{
+		compile(cells);
+	}
+
+	//Only wires next to a head can become heads, so count from the heads outwards.
+	mTouched.clear();
+	for (auto& head : mHeads)
+	{
+		for (std::uint32_t i = mOffsets[head]; i < mOffsets[head + 1]; ++i)
+		{
+			std::uint32_t n = mNeighbors[i];
+			if (mTypes[n] == Cell::WIRE && mCounts[n]++ == 0)
+			{
+				mTouched.push_back(n);
+			}
+		}
+	}
+	mNewHeads.clear();
+	for (auto& wire : mTouched)
+	{
+		if (mCounts[wire] <= 2)
+		{
+			mNewHeads.push_back(wire);
+		}
+		mCounts[wire] = 0;
+	}
+
+	//Tails become wire, heads become tails, and the counted wires become heads.
+	auto set = [&](std::uint32_t i, Cell::Type type) {
+		mTypes[i] = type;
+		cells.set(i, Cell(type, cells[i].getPosition()));
+		changed.push_back(cells[i]);
+	};
+	for (auto& tail : mTails)
+	{
+		set(tail, Cell::WIRE);
+	}
+	for (auto& head : mHeads)
+	{
+		set(head, Cell::TAIL);
+	}
+	for (auto& wire : mNewHeads)
+	{
+		set(wire, Cell::HEAD);
+	}
+
+	mTails.swap(mHeads);
+	mHeads.swap(mNewHeads);
+}
@@ -0,0 +1,241 @@
+#include "Coordinator.hpp"
+
+#ifdef __unix__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+Coordinator::Coordinator(unsigned short port, unsigned int workers)
+	: mWorkerCount(std::max(workers, 1u))
+{
+	if (mListener.listen(port) != sf::Socket::Done)
+	{
+		std::cerr << "Coordinator: could not listen on port " << port << "\n";
+	}
+	mPort = mListener.getLocalPort();
+}
+
+bool Coordinator::spawnLocalWorkers(const std::string& exe)
+{
+#ifdef __unix__
+	std::string port = std::to_string(mPort);
+	for (unsigned int i = 0; i < mWorkerCount; ++i)
+	{
+		int pid = fork();
+		if (pid < 0)
+		{
+			return false;
+		}
+		if (pid == 0)
+		{
+			execl(exe.c_str(), exe.c_str(), "--worker", "127.0.0.1", port.c_str(), (char*)nullptr);
+			_exit(127);
+		}
+		mChildren.push_back(pid);
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Coordinator::run(std::vector<Cell>& cells, unsigned int generations)
+{
+	if (!acceptWorkers())
+	{
+		shutdown();
+		return false;
+	}
+
+	//Split the world into strips, and bucket the cells by strip.
+	std::vector<sf::Int64> bounds = splitColumns(cells);
+	std::vector<std::vector<Cell>> strips(mPeers.size());
+	for (auto& cell : cells)
+	{
+		std::size_t i = std::upper_bound(bounds.begin(), bounds.end(), cell.getPosition().x) - bounds.begin() - 1;
+		strips[i].push_back(cell);
+	}
+
+	//Hand every worker its strip, and the address of its right neighbor.
+	for (std::size_t i = 0; i < mPeers.size(); ++i)
+	{
+		sf::Packet packet;
+		packet << (sf::Uint8)ASSIGN << (sf::Uint32)i << (sf::Int64)bounds[i] << (sf::Int64)bounds[i + 1];
+
+		bool hasRight = i + 1 < mPeers.size();
+		packet << (i > 0) << hasRight;
+		if (hasRight)
+		{
+			packet << mPeers[i + 1]->socket.getRemoteAddress().toString()
+				   << (sf::Uint16)mPeers[i + 1]->listenPort;
+		}
+
+		packet << (sf::Uint32)strips[i].size();
+		for (auto& cell : strips[i])
+		{
+			packet << (sf::Int64)cell.getPosition().x
+				   << (sf::Int64)cell.getPosition().y
+				   << (sf::Uint8)cell.getType();
+		}
+
+		if (mPeers[i]->socket.send(packet) != sf::Socket::Done)
+		{
+			shutdown();
+			return false;
+		}
+	}
+
+	std::vector<sf::Packet> replies;
+	if (!gather(READY, replies))
+	{
+		shutdown();
+		return false;
+	}
+
+	//The lockstep loop. No worker starts generation n+1 before all have finished n.
+	for (unsigned int gen = 0; gen < generations; ++gen)
+	{
+		sf::Packet go;
+		go << (sf::Uint8)GO << (sf::Uint32)gen;
+		if (!broadcast(go) || !gather(DONE, replies))
+		{
+			shutdown();
+			return false;
+		}
+	}
+
+	//Collect the resulting world.
+	sf::Packet request;
+	request << (sf::Uint8)GATHER;
+	if (!broadcast(request) || !gather(CELLS, replies))
+	{
+		shutdown();
+		return false;
+	}
+
+	cells.clear();
+	for (auto& reply : replies)
+	{
+		sf::Uint32 count;
+		reply >> count;
+		for (sf::Uint32 i = 0; i < count; ++i)
+		{
+			sf::Int64 x, y;
+			sf::Uint8 type;
+			reply >> x >> y >> type;
+			cells.push_back(Cell((Cell::Type)type, {x, y}));
+		}
+	}
+
+	shutdown();
+	return true;
+}
+
+bool Coordinator::acceptWorkers()
+{
+	while (mPeers.size() < mWorkerCount)
+	{
+		auto peer = std::make_unique<Peer>();
+		if (mListener.accept(peer->socket) != sf::Socket::Done)
+		{
+			return false;
+		}
+
+		sf::Packet hello;
+		sf::Uint8 type;
+		sf::Uint16 port;
+		if (peer->socket.receive(hello) != sf::Socket::Done ||
+			!(hello >> type >> port) || type != HELLO)
+		{
+			return false;
+		}
+		peer->listenPort = port;
+
+		mPeers.push_back(std::move(peer));
+	}
+
+	return true;
+}
+
+std::vector<sf::Int64> Coordinator::splitColumns(std::vector<Cell> cells)
+{
+	std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+		return a.getPosition().x < b.getPosition().x;
+	});
+
+	//The first strip always reaches to the far left.
+	std::vector<sf::Int64> bounds = {INT64_MIN};
+	for (std::size_t i = 1; i < mPeers.size(); ++i)
+	{
+		//Start the next strip at the column holding the i/n'th cell,
+		//as long as that's right of the previous strip's start.
+		std::size_t target = cells.size() * i / mPeers.size();
+		while (target < cells.size() && cells[target].getPosition().x <= bounds.back())
+		{
+			++target;
+		}
+		if (target >= cells.size())
+		{
+			break;
+		}
+		bounds.push_back(cells[target].getPosition().x);
+	}
+
+	//Workers without any columns left get an empty strip at the far right,
+	//so strips next to each other are always simulated by neighboring workers.
+	while (bounds.size() < mPeers.size() + 1)
+	{
+		bounds.push_back(INT64_MAX);
+	}
+
+	return bounds;
+}
+
+bool Coordinator::broadcast(sf::Packet& packet)
+{
+	for (auto& peer : mPeers)
+	{
+		if (peer->socket.send(packet) != sf::Socket::Done)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Coordinator::gather(Message type, std::vector<sf::Packet>& replies)
+{
+	replies.assign(mPeers.size(), sf::Packet());
+	for (std::size_t i = 0; i < mPeers.size(); ++i)
+	{
+		sf::Uint8 reply;
+		if (mPeers[i]->socket.receive(replies[i]) != sf::Socket::Done ||
+			!(replies[i] >> reply) || reply != type)
+		{
+			std::cerr << "Coordinator: lost worker " << i << "\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+void Coordinator::shutdown()
+{
+	//Tell every worker still around to quit, then drop all connections.
+	for (auto& peer : mPeers)
+	{
+		sf::Packet quit;
+		quit << (sf::Uint8)QUIT;
+		peer->socket.send(quit);
+	}
+	mPeers.clear();
+	mListener.close();
+
+#ifdef __unix__
+	for (auto& pid : mChildren)
+	{
+		waitpid(pid, nullptr, 0);
+	}
+#endif
+	mChildren.clear();
+}
@@ -0,0 +1,121 @@
+#include "DeltaPacket.hpp"
+
+void DeltaPacket::writeCells(std::vector<Cell> cells)
+{
+	//Sort row by row, so neighboring cells end up next to each other.
+	std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+		return a.getPosition().y != b.getPosition().y
+				   ? a.getPosition().y < b.getPosition().y
+				   : a.getPosition().x < b.getPosition().x;
+	});
+
+	//Split the cells into runs of one type.
+	struct Run
+	{
+		WorldPos start;
+		sf::Uint64 length;
+		Cell::Type type;
+	};
+	std::vector<Run> runs;
+	for (auto& cell : cells)
+	{
+		if (!runs.empty() &&
+			runs.back().type == cell.getType() &&
+			runs.back().start.y == cell.getPosition().y &&
+			runs.back().start.x + (sf::Int64)runs.back().length == cell.getPosition().x)
+		{
+			runs.back().length++;
+		}
+		else
+		{
+			runs.push_back({cell.getPosition(), 1, cell.getType()});
+		}
+	}
+
+	//Each run is stored relative to the end of the previous one.
+	writeVarint(runs.size());
+	WorldPos prev(0, 0);
+	for (auto& run : runs)
+	{
+		writeSigned((sf::Int64)run.start.y - prev.y);
+		writeSigned((sf::Int64)run.start.x - prev.x);
+		writeVarint((run.length << 2) | run.type);
+		prev = {run.start.x + (sf::Int64)run.length, run.start.y};
+	}
+}
+
+bool DeltaPacket::readCells(std::vector<Cell>& cells)
+{
+	sf::Uint64 count;
+	if (!readVarint(count))
+	{
+		return false;
+	}
+
+	WorldPos prev(0, 0);
+	for (sf::Uint64 i = 0; i < count; ++i)
+	{
+		sf::Int64 dx, dy;
+		sf::Uint64 lengthType;
+		if (!readSigned(dy) || !readSigned(dx) || !readVarint(lengthType))
+		{
+			return false;
+		}
+
+		WorldPos start(prev.x + dx, prev.y + dy);
+		sf::Uint64 length = lengthType >> 2;
+		Cell::Type type	  = (Cell::Type)(lengthType & 3);
+		for (sf::Uint64 j = 0; j < length; ++j)
+		{
+			cells.push_back(Cell(type, {start.x + (sf::Int64)j, start.y}));
+		}
+		prev = {start.x + (sf::Int64)length, start.y};
+	}
+
+	return true;
+}
+
+void DeltaPacket::writeVarint(sf::Uint64 value)
+{
+	while (value >= 0x80)
+	{
+		*this << (sf::Uint8)((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	*this << (sf::Uint8)value;
+}
+
+bool DeltaPacket::readVarint(sf::Uint64& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		sf::Uint8 byte;
+		if (!(*this >> byte))
+		{
+			return false;
+		}
+		value |= (sf::Uint64)(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void DeltaPacket::writeSigned(sf::Int64 value)
+{
+	writeVarint(((sf::Uint64)value << 1) ^ (sf::Uint64)(value >> 63));
+}
+
+bool DeltaPacket::readSigned(sf::Int64& value)
+{
+	sf::Uint64 raw;
+	if (!readVarint(raw))
+	{
+		return false;
+	}
+	value = (sf::Int64)(raw >> 1) ^ -(sf::Int64)(raw & 1);
+	return true;
+}
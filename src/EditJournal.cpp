@@ -0,0 +1,407 @@
+#include "EditJournal.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+const sf::Time EditJournal::SYNC_INTERVAL	 = sf::seconds(1);
+const sf::Time EditJournal::COMPACT_INTERVAL = sf::seconds(300);
+
+EditJournal::EditJournal(const std::string& directory)
+	: mDirectory(directory),
+	  mFile(-1),
+	  mEpoch(0),
+	  mEdits(0),
+	  mDirty(false),
+	  mStale(false),
+	  mSavingEpoch(0)
+{
+}
+
+std::unique_ptr<EditJournal> EditJournal::open(const std::string& directory)
+{
+	std::error_code err;
+	std::filesystem::create_directories(directory, err);
+	if (!std::filesystem::is_directory(directory, err))
+	{
+		return nullptr;
+	}
+
+	std::unique_ptr<EditJournal> journal(new EditJournal(directory));
+	if (!journal->recover())
+	{
+		return nullptr;
+	}
+	return journal;
+}
+
+EditJournal::~EditJournal()
+{
+	sync();
+	if (mSaver)
+	{
+		while (!mSaver->isDone())
+		{
+			sf::sleep(sf::milliseconds(10));
+		}
+		finishCompaction();
+	}
+	if (mFile >= 0)
+	{
+		::close(mFile);
+	}
+}
+
+std::string EditJournal::getSnapshot() const
+{
+	return mSnapshot;
+}
+
+const std::vector<EditJournal::Edit>& EditJournal::getRecovered() const
+{
+	return mRecovered;
+}
+
+void EditJournal::set(const Cell& cell)
+{
+	append(SET, cell.getType(), cell.getPosition());
+}
+
+void EditJournal::clear(WorldPos pos)
+{
+	append(CLEAR, Cell::NONE, pos);
+}
+
+void EditJournal::reset()
+{
+	append(RESET, Cell::NONE, {0, 0});
+	mStale = true;
+}
+
+void EditJournal::flush()
+{
+	//Written, it survives the process dying. Flushed, it survives the machine dying.
+	std::size_t written = 0;
+	while (mFile >= 0 && written < mBuffer.size())
+	{
+		ssize_t n = ::write(mFile, mBuffer.data() + written, mBuffer.size() - written);
+		if (n <= 0)
+		{
+			break;
+		}
+		written += n;
+		mDirty = true;
+	}
+	mBuffer.erase(0, written);
+
+	if (mDirty && mSinceSync.getElapsedTime() >= SYNC_INTERVAL)
+	{
+		::fsync(mFile);
+		mDirty = false;
+		mSinceSync.restart();
+	}
+
+	if (mSaver && mSaver->isDone())
+	{
+		finishCompaction();
+	}
+}
+
+void EditJournal::sync()
+{
+	flush();
+	if (mDirty)
+	{
+		::fsync(mFile);
+		mDirty = false;
+		mSinceSync.restart();
+	}
+}
+
+bool EditJournal::needsCompaction()
+{
+	if (mSaver)
+	{
+		return false;
+	}
+	return mStale || mEdits >= COMPACT_EDITS || (mEdits > 0 && mSinceCompact.getElapsedTime() >= COMPACT_INTERVAL);
+}
+
+void EditJournal::compact(const CellStore& cells)
+{
+	if (mSaver)
+	{
+		return;
+	}
+
+	//New edits go to the next journal, which starts from the snapshot.
+	sync();
+	if (!startJournal(mEpoch + 1))
+	{
+		return;
+	}
+	mStale		 = false;
+	mSavingEpoch = mEpoch;
+	mSinceCompact.restart();
+	mSaver = std::make_unique<SnapshotSaver>(cells, getPath("snapshot", mSavingEpoch, ".wi.tmp").string());
+}
+
+bool EditJournal::isCompacting()
+{
+	return mSaver != nullptr;
+}
+
+bool EditJournal::isSettled()
+{
+	return mBuffer.empty() && !mDirty && !mSaver;
+}
+
+std::size_t EditJournal::getEpoch() const
+{
+	return mEpoch;
+}
+
+std::size_t EditJournal::getEdits() const
+{
+	return mEdits;
+}
+
+std::string EditJournal::getDirectory() const
+{
+	return mDirectory.string();
+}
+
+bool EditJournal::recover()
+{
+	//Snapshots & journals by epoch. Leftover .tmp files are half-written snapshots.
+	std::map<std::size_t, std::filesystem::path> snapshots, journals;
+	std::error_code err;
+	for (auto& entry : std::filesystem::directory_iterator(mDirectory, err))
+	{
+		std::size_t epoch;
+		if (parseName(entry.path(), "snapshot", ".wi", epoch))
+		{
+			snapshots[epoch] = entry.path();
+		}
+		else if (parseName(entry.path(), "journal", ".bin", epoch))
+		{
+			journals[epoch] = entry.path();
+		}
+	}
+
+	//The newest snapshot, and every journal started since.
+	std::size_t base = 0, last = 0;
+	if (!snapshots.empty())
+	{
+		base	  = snapshots.rbegin()->first;
+		mSnapshot = snapshots.rbegin()->second.string();
+		last	  = base;
+	}
+	for (auto& journal : journals)
+	{
+		if (journal.first >= base)
+		{
+			readJournal(journal.second, journal.first);
+		}
+		last = std::max(last, journal.first);
+	}
+
+	//The files stay until the recovered world is compacted.
+	mStale = !mSnapshot.empty() || !mRecovered.empty() || !journals.empty();
+	return startJournal(last + 1);
+}
+
+void EditJournal::readJournal(const std::filesystem::path& path, std::size_t epoch)
+{
+	std::ifstream file(path, std::ios::binary);
+	char header[16];
+	std::uint64_t stored;
+	if (!file.read(header, sizeof(header)) || std::memcmp(header, "WWJ", 3) != 0 || (header[3] != '1' && header[3] != '2'))
+	{
+		return;
+	}
+	//Version 1 journals stored 32-bit positions.
+	bool wide		 = header[3] == '2';
+	std::size_t size = wide ? RECORD_SIZE : OLD_RECORD_SIZE;
+	std::memcpy(&stored, header + 8, sizeof(stored));
+	if (stored != epoch)
+	{
+		return;
+	}
+
+	//A crash can leave a partly written edit at the end, which fails its check.
+	unsigned char record[RECORD_SIZE];
+	while (file.read((char*)record, size))
+	{
+		std::uint16_t stored;
+		std::memcpy(&stored, record + 2, sizeof(stored));
+		if (stored != check(record, size) || record[0] < SET || record[0] > RESET || record[1] > Cell::TAIL)
+		{
+			break;
+		}
+
+		Edit edit;
+		edit.op	  = (Op)record[0];
+		edit.type = (Cell::Type)record[1];
+		if (wide)
+		{
+			std::int64_t pos[2];
+			std::memcpy(pos, record + 4, sizeof(pos));
+			edit.pos = {pos[0], pos[1]};
+		}
+		else
+		{
+			std::int32_t pos[2];
+			std::memcpy(pos, record + 4, sizeof(pos));
+			edit.pos = {pos[0], pos[1]};
+		}
+
+		//Nothing from before a reset matters, not even the snapshot.
+		if (edit.op == RESET)
+		{
+			mRecovered.clear();
+			mSnapshot.clear();
+			continue;
+		}
+		mRecovered.push_back(edit);
+	}
+}
+
+bool EditJournal::startJournal(std::size_t epoch)
+{
+	std::filesystem::path path = getPath("journal", epoch, ".bin");
+	int file				   = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	char header[16] = {'W', 'W', 'J', '2'};
+	std::uint64_t stored = epoch;
+	std::memcpy(header + 8, &stored, sizeof(stored));
+	if (::write(file, header, sizeof(header)) != sizeof(header))
+	{
+		::close(file);
+		return false;
+	}
+	::fsync(file);
+
+	if (mFile >= 0)
+	{
+		::close(mFile);
+	}
+	mFile  = file;
+	mEpoch = epoch;
+	mEdits = 0;
+	mDirty = false;
+	return true;
+}
+
+void EditJournal::finishCompaction()
+{
+	std::filesystem::path temp = getPath("snapshot", mSavingEpoch, ".wi.tmp");
+	std::error_code err;
+	bool failed = mSaver->hasFailed();
+	mSaver.reset();
+	if (failed)
+	{
+		//The older snapshot & journals still hold everything, try again later.
+		std::filesystem::remove(temp, err);
+		return;
+	}
+
+	syncFile(temp);
+	std::filesystem::rename(temp, getPath("snapshot", mSavingEpoch, ".wi"), err);
+	if (err)
+	{
+		return;
+	}
+	syncFile(mDirectory);
+
+	//Everything before the snapshot is in it now.
+	std::vector<std::filesystem::path> replaced;
+	for (auto& entry : std::filesystem::directory_iterator(mDirectory, err))
+	{
+		std::size_t epoch;
+		if ((parseName(entry.path(), "snapshot", ".wi", epoch) || parseName(entry.path(), "snapshot", ".wi.tmp", epoch) ||
+			 parseName(entry.path(), "journal", ".bin", epoch)) &&
+			epoch < mSavingEpoch)
+		{
+			replaced.push_back(entry.path());
+		}
+	}
+	for (auto& path : replaced)
+	{
+		std::filesystem::remove(path, err);
+	}
+	mSnapshot.clear();
+	mRecovered.clear();
+}
+
+void EditJournal::append(Op op, Cell::Type type, WorldPos pos)
+{
+	unsigned char record[RECORD_SIZE];
+	std::int64_t coords[2] = {pos.x, pos.y};
+	record[0]			   = op;
+	record[1]			   = type;
+	std::memcpy(record + 4, coords, sizeof(coords));
+	std::uint16_t stored = check(record, RECORD_SIZE);
+	std::memcpy(record + 2, &stored, sizeof(stored));
+	mBuffer.append((const char*)record, RECORD_SIZE);
+	mEdits++;
+}
+
+std::uint16_t EditJournal::check(const unsigned char* record, std::size_t size)
+{
+	//FNV-1a over everything but the check itself.
+	std::uint32_t h = 2166136261u;
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		if (i != 2 && i != 3)
+		{
+			h = (h ^ record[i]) * 16777619u;
+		}
+	}
+	return (h >> 16) ^ (h & 0xFFFF);
+}
+
+std::filesystem::path EditJournal::getPath(const char* kind, std::size_t epoch, const char* extension) const
+{
+	return mDirectory / (std::string(kind) + "-" + std::to_string(epoch) + extension);
+}
+
+bool EditJournal::parseName(const std::filesystem::path& path, const char* kind, const char* extension, std::size_t& epoch)
+{
+	std::string name = path.filename().string();
+	std::string prefix = std::string(kind) + "-";
+	if (name.compare(0, prefix.size(), prefix) != 0)
+	{
+		return false;
+	}
+	std::size_t end = prefix.size();
+	while (end < name.size() && std::isdigit((unsigned char)name[end]))
+	{
+		end++;
+	}
+	if (end == prefix.size() || name.substr(end) != extension)
+	{
+		return false;
+	}
+	epoch = std::stoull(name.substr(prefix.size(), end - prefix.size()));
+	return true;
+}
+
+void EditJournal::syncFile(const std::filesystem::path& path)
+{
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file >= 0)
+	{
+		::fsync(file);
+		::close(file);
+	}
+}
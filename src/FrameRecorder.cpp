@@ -0,0 +1,54 @@
+#include "FrameRecorder.hpp"
+
+FrameRecorder::FrameRecorder(sf::Vector2u size,
+							 const std::string& directory,
+							 unsigned int every,
+							 unsigned int threads,
+							 std::size_t queue)
+	: mWriter(threads, queue),
+	  mDirectory(directory),
+	  mEvery(std::max(every, 1u)),
+	  mCaptured(0)
+{
+	mTexture.create(size.x, size.y);
+
+	std::error_code err;
+	std::filesystem::create_directories(mDirectory, err);
+}
+
+bool FrameRecorder::capture(const sf::Drawable& scene, unsigned long long generation)
+{
+	if (generation % mEvery != 0)
+	{
+		return false;
+	}
+	Tracer::Span span("FrameRecorder::capture");
+
+	mTexture.clear(sf::Color::White);
+	mTexture.draw(scene);
+	mTexture.display();
+
+	//Reading the texture back has to happen here, on the rendering thread.
+	//Everything after that is left to the writer.
+	std::stringstream path;
+	path << mDirectory << "/frame_" << std::setw(8) << std::setfill('0') << generation << ".png";
+	mWriter.push(mTexture.getTexture().copyToImage(), path.str());
+
+	mCaptured++;
+	return true;
+}
+
+void FrameRecorder::finish()
+{
+	mWriter.finish();
+}
+
+std::size_t FrameRecorder::getCaptured()
+{
+	return mCaptured;
+}
+
+std::size_t FrameRecorder::getWritten()
+{
+	return mWriter.getWritten();
+}
@@ -0,0 +1,57 @@
+#include "FrameTimings.hpp"
+
+void FrameTimings::add(sf::Time time)
+{
+	mTimes.push_back(time);
+}
+
+void FrameTimings::report(std::ostream& out, std::size_t worst)
+{
+	if (mTimes.empty())
+	{
+		out << "No frames.\n";
+		return;
+	}
+
+	//Sort a copy for the percentiles, keeping the frame numbers.
+	std::vector<std::pair<sf::Time, std::size_t>> sorted;
+	sf::Time total;
+	for (std::size_t i = 0; i < mTimes.size(); ++i)
+	{
+		sorted.push_back({mTimes[i], i});
+		total += mTimes[i];
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	auto ms = [](sf::Time t) { return t.asMicroseconds() / 1000.0; };
+	auto percentile = [&](double p) { return ms(sorted[(std::size_t)(p * (sorted.size() - 1))].first); };
+
+	out << std::fixed << std::setprecision(3);
+	out << "Frames: " << mTimes.size() << "\n";
+	out << "Mean: " << ms(total) / mTimes.size() << "ms\n";
+	out << "p50: " << percentile(0.5) << "ms, p95: " << percentile(0.95)
+		<< "ms, p99: " << percentile(0.99) << "ms, max: " << ms(sorted.back().first) << "ms\n";
+	out << "Slowest frames:";
+	for (std::size_t i = 0; i < std::min(worst, sorted.size()); ++i)
+	{
+		auto& frame = sorted[sorted.size() - 1 - i];
+		out << " #" << frame.second << " (" << ms(frame.first) << "ms)";
+	}
+	out << "\n";
+}
+
+bool FrameTimings::save(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "frame,microseconds\n";
+	for (std::size_t i = 0; i < mTimes.size(); ++i)
+	{
+		file << i << "," << mTimes[i].asMicroseconds() << "\n";
+	}
+	return (bool)file;
+}
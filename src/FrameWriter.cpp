@@ -0,0 +1,98 @@
+#include "FrameWriter.hpp"
+
+FrameWriter::FrameWriter(unsigned int threads, std::size_t capacity)
+	: mCapacity(std::max<std::size_t>(capacity, 1)),
+	  mBusy(0),
+	  mStopping(false),
+	  mWritten(0),
+	  mFailed(0)
+{
+	for (unsigned int i = 0; i < std::max(threads, 1u); ++i)
+	{
+		mThreads.emplace_back(&FrameWriter::work, this);
+	}
+}
+
+FrameWriter::~FrameWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mQueued.notify_all();
+
+	for (auto& thread : mThreads)
+	{
+		thread.join();
+	}
+}
+
+void FrameWriter::push(sf::Image image, const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	//Backpressure, wait for a free slot.
+	mDone.wait(lock, [this]() { return mQueue.size() < mCapacity; });
+
+	mQueue.push_back({std::move(image), path});
+	lock.unlock();
+	mQueued.notify_one();
+}
+
+void FrameWriter::finish()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDone.wait(lock, [this]() { return mQueue.empty() && mBusy == 0; });
+}
+
+std::size_t FrameWriter::getWritten()
+{
+	return mWritten;
+}
+
+std::size_t FrameWriter::getFailed()
+{
+	return mFailed;
+}
+
+void FrameWriter::work()
+{
+	Tracer::setThreadName("frame writer");
+
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mQueued.wait(lock, [this]() { return !mQueue.empty() || mStopping; });
+			if (mQueue.empty())
+			{
+				return;
+			}
+			job = std::move(mQueue.front());
+			mQueue.pop_front();
+			mBusy++;
+		}
+		//A slot was freed.
+		mDone.notify_all();
+
+		//Encoding is the slow part, so it happens outside the lock.
+		{
+			Tracer::Span span("FrameWriter::encode");
+			if (job.image.saveToFile(job.path))
+			{
+				mWritten++;
+			}
+			else
+			{
+				mFailed++;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mBusy--;
+		}
+		mDone.notify_all();
+	}
+}
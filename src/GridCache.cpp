@@ -0,0 +1,282 @@
+#include "GridCache.hpp"
+
+GridCache::GridCache()
+	: mPool(std::make_unique<ThreadPool>(ThreadPool::getDefaultThreads(), "vertex builder")),
+	  mUseBuffer(sf::VertexBuffer::isAvailable()),
+	  mRevision(0)
+{
+}
+
+void GridCache::setCell(const Cell& c)
+{
+	setCells({c});
+}
+
+void GridCache::setCells(const std::vector<Cell>& cells)
+{
+	//Give every cell its slot first, growing the tiles, so the vertices can be filled in by tile in parallel.
+	mPlaced.clear();
+	mChanges.clear();
+	for (auto& c : cells)
+	{
+		Placed placed;
+		int from;
+		placed.key	= getTile(c.pos);
+		placed.tile = &reserveSlot(c, placed.slot, from);
+		mPlaced.push_back(placed);
+		mChanges.push_back({c.pos, from, mPyramid.getColorIndex(c.col)});
+	}
+
+	//Each slice fills in the vertices of its own tiles, and updates its own levels of the pyramid.
+	std::size_t slices = cells.size() < PARALLEL_CELLS ? 1 : std::min<std::size_t>(mPool->getConcurrency(), LodPyramid::LEVELS);
+	mPool->run(slices, [&](std::size_t slice) {
+		Tracer::Span span("GridCache::build");
+		::Cell::PositionHash hash;
+		for (auto& placed : mPlaced)
+		{
+			if (hash(placed.key) % slices == slice)
+			{
+				writeVertices(*placed.tile, placed.slot);
+			}
+		}
+		for (int level = 1 + slice; level <= LodPyramid::LEVELS; level += slices)
+		{
+			mPyramid.apply(mChanges, level);
+		}
+	});
+
+	//Only the upload has to happen on this thread.
+	flush();
+}
+
+void GridCache::clearCell(WorldPos pos)
+{
+	auto found = mSlots.find(pos);
+	if (found == mSlots.end())
+	{
+		return;
+	}
+
+	//Empty the slot, and keep it for the next new cell in the tile.
+	auto tile		 = mTiles.find(getTile(pos));
+	std::size_t slot = found->second;
+	mPyramid.remove(pos, tile->second.cells[slot].col);
+	writeVertices(tile->second, slot, true);
+	tile->second.freeSlots.push_back(slot);
+	mSlots.erase(found);
+
+	//Drop tiles once they're empty.
+	if (tile->second.freeSlots.size() == tile->second.cells.size())
+	{
+		mTiles.erase(tile);
+	}
+	else
+	{
+		mDirtyTiles.push_back(tile->first);
+	}
+	flush();
+}
+
+void GridCache::clear()
+{
+	mTiles.clear();
+	mSlots.clear();
+	mDirtyTiles.clear();
+	mPyramid.clear();
+	mRevision++;
+}
+
+bool GridCache::isCell(WorldPos pos) const
+{
+	return mSlots.count(pos) != 0;
+}
+
+GridCache::Cell GridCache::getCell(WorldPos pos) const
+{
+	auto found = mSlots.find(pos);
+	if (found == mSlots.end())
+	{
+		return {.pos = {0, 0}, .col = sf::Color::White};
+	}
+
+	return mTiles.at(getTile(pos)).cells[found->second];
+}
+
+void GridCache::draw(sf::RenderTarget& target, sf::RenderStates states, WorldRect visible, WorldPos origin) const
+{
+	//Only the tile's offset from the origin goes through floats, and it's small for tiles on screen.
+	auto drawTile = [&](WorldPos key, const Tile& tile) {
+		sf::RenderStates tileStates = states;
+		tileStates.transform.translate(key.x * TILE_SIZE - origin.x, key.y * TILE_SIZE - origin.y);
+		if (mUseBuffer)
+		{
+			target.draw(tile.buffer, 0, tile.vertices.getVertexCount(), tileStates);
+		}
+		else
+		{
+			target.draw(tile.vertices, tileStates);
+		}
+	};
+
+	//Walk whichever is smaller, the tiles on screen or all tiles.
+	WorldPos first = getTile({visible.left, visible.top});
+	WorldPos last  = getTile({visible.left + visible.width, visible.top + visible.height});
+	if ((long long)(last.x - first.x + 1) * (last.y - first.y + 1) < (long long)mTiles.size())
+	{
+		for (sf::Int64 y = first.y; y <= last.y; ++y)
+		{
+			for (sf::Int64 x = first.x; x <= last.x; ++x)
+			{
+				auto found = mTiles.find({x, y});
+				if (found != mTiles.end())
+				{
+					drawTile(found->first, found->second);
+				}
+			}
+		}
+	}
+	else
+	{
+		for (auto& tile : mTiles)
+		{
+			if (tile.first.x >= first.x && tile.first.x <= last.x &&
+				tile.first.y >= first.y && tile.first.y <= last.y)
+			{
+				drawTile(tile.first, tile.second);
+			}
+		}
+	}
+}
+
+const LodPyramid& GridCache::getPyramid() const
+{
+	return mPyramid;
+}
+
+unsigned long long GridCache::getRevision() const
+{
+	return mRevision;
+}
+
+ThreadPool& GridCache::getPool()
+{
+	return *mPool;
+}
+
+GridCache::Tile& GridCache::reserveSlot(const Cell& c, std::size_t& slot, int& from)
+{
+	WorldPos key = getTile(c.pos);
+	Tile& tile		 = mTiles[key];
+	auto found		 = mSlots.find(c.pos);
+	if (found != mSlots.end())
+	{
+		slot = found->second;
+		from = mPyramid.getColorIndex(tile.cells[slot].col);
+	}
+	else
+	{
+		//Reuse a free slot, or add one at the end.
+		from = LodPyramid::NO_COLOR;
+		if (!tile.freeSlots.empty())
+		{
+			slot = tile.freeSlots.back();
+			tile.freeSlots.pop_back();
+		}
+		else
+		{
+			slot = tile.cells.size();
+			tile.cells.push_back(c);
+			tile.vertices.setPrimitiveType(sf::Quads);
+			tile.vertices.resize(tile.vertices.getVertexCount() + 4);
+		}
+		mSlots[c.pos] = slot;
+	}
+	tile.cells[slot] = c;
+
+	//Changes tend to come in runs, so most repeats are caught here rather than in flush().
+	if (mDirtyTiles.empty() || mDirtyTiles.back() != key)
+	{
+		mDirtyTiles.push_back(key);
+	}
+	return tile;
+}
+
+void GridCache::writeVertices(Tile& tile, std::size_t slot, bool empty)
+{
+	//An empty slot is a zero-sized, transparent quad.
+	const Cell& c	 = tile.cells[slot];
+	WorldPos key	 = getTile(c.pos);
+	sf::Vector2f pos(c.pos.x - key.x * TILE_SIZE, c.pos.y - key.y * TILE_SIZE);
+	float size		 = empty ? 0 : 1;
+	sf::Color col	 = empty ? sf::Color::Transparent : c.col;
+	sf::Vertex* quad = &tile.vertices[slot * 4];
+	quad[0]			 = sf::Vertex(pos, col);
+	quad[1]			 = sf::Vertex({pos.x + size, pos.y}, col);
+	quad[2]			 = sf::Vertex({pos.x + size, pos.y + size}, col);
+	quad[3]			 = sf::Vertex({pos.x, pos.y + size}, col);
+
+	tile.dirtySlots.push_back(slot);
+}
+
+void GridCache::flush()
+{
+	Tracer::Span span("GridCache::flush");
+
+	mRevision++;
+
+	std::sort(mDirtyTiles.begin(), mDirtyTiles.end(), [](WorldPos a, WorldPos b) {
+		return a.y != b.y ? a.y < b.y : a.x < b.x;
+	});
+	mDirtyTiles.erase(std::unique(mDirtyTiles.begin(), mDirtyTiles.end()), mDirtyTiles.end());
+	for (auto& key : mDirtyTiles)
+	{
+		auto found = mTiles.find(key);
+		if (found == mTiles.end())
+		{
+			continue;
+		}
+		Tile& tile = found->second;
+		if (!mUseBuffer || tile.dirtySlots.empty())
+		{
+			tile.dirtySlots.clear();
+			continue;
+		}
+
+		std::size_t count = tile.vertices.getVertexCount();
+		if (tile.buffer.getVertexCount() < count)
+		{
+			//Out of room, so grow the buffer with some slack, and upload everything once.
+			tile.buffer.setPrimitiveType(sf::Quads);
+			tile.buffer.setUsage(sf::VertexBuffer::Dynamic);
+			tile.buffer.create(std::max(count, tile.buffer.getVertexCount() * 2));
+			tile.buffer.update(&tile.vertices[0], count, 0);
+		}
+		else
+		{
+			//Upload runs of neighboring changed slots in one go.
+			std::vector<std::size_t>& dirty = tile.dirtySlots;
+			std::sort(dirty.begin(), dirty.end());
+			std::size_t first = dirty.front(), last = first;
+			for (std::size_t i = 1; i <= dirty.size(); ++i)
+			{
+				if (i < dirty.size() && dirty[i] <= last + 1)
+				{
+					last = dirty[i];
+					continue;
+				}
+				tile.buffer.update(&tile.vertices[first * 4], (last - first + 1) * 4, first * 4);
+				if (i < dirty.size())
+				{
+					first = last = dirty[i];
+				}
+			}
+		}
+		tile.dirtySlots.clear();
+	}
+	mDirtyTiles.clear();
+}
+
+WorldPos GridCache::getTile(WorldPos pos)
+{
+	return floorDiv(pos, TILE_SIZE);
+}
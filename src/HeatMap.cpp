@@ -0,0 +1,166 @@
+#include "HeatMap.hpp"
+
+#include <algorithm>
+
+HeatMap::HeatMap(std::size_t window)
+	: mHistory(std::max<std::size_t>(std::min<std::size_t>(window, UINT16_MAX), 1)),
+	  mNext(0),
+	  mLength(0),
+	  mVersion(0),
+	  mHotCount(0),
+	  mHotShare(-1),
+	  mHotVersion(0),
+	  mLast(nullptr)
+{
+}
+
+void HeatMap::record(const std::vector<Cell>& changed)
+{
+	//Heads only last a generation, so every head in the changes just became one.
+	std::vector<WorldPos>& slot = mHistory[mNext];
+	for (auto& pos : slot)
+	{
+		count(pos, -1);
+	}
+	slot.clear();
+	for (auto& cell : changed)
+	{
+		if (cell.getType() == Cell::HEAD)
+		{
+			slot.push_back(cell.getPosition());
+			count(cell.getPosition(), 1);
+		}
+	}
+
+	mNext	= (mNext + 1) % mHistory.size();
+	mLength = std::min(mLength + 1, mHistory.size());
+}
+
+void HeatMap::clear()
+{
+	mChunks.clear();
+	mLast = nullptr;
+	for (auto& slot : mHistory)
+	{
+		slot.clear();
+		slot.shrink_to_fit();
+	}
+	mNext	= 0;
+	mLength = 0;
+	mVersion++;
+}
+
+std::size_t HeatMap::getWindow() const
+{
+	return mHistory.size();
+}
+
+std::size_t HeatMap::getLength() const
+{
+	return mLength;
+}
+
+unsigned int HeatMap::getCount(WorldPos pos) const
+{
+	auto found = mChunks.find(getChunkOf(pos));
+	return found != mChunks.end() ? found->second->counts[getOffsetOf(pos)] : 0;
+}
+
+float HeatMap::getHeat(unsigned int count) const
+{
+	return std::min(count * 3.f / mHistory.size(), 1.f);
+}
+
+const HeatMap::Chunks& HeatMap::getChunks() const
+{
+	return mChunks;
+}
+
+std::vector<WorldPos> HeatMap::getHotChunks(float share) const
+{
+	std::vector<std::pair<std::uint32_t, WorldPos>> chunks;
+	std::uint64_t total = 0;
+	for (auto& chunk : mChunks)
+	{
+		chunks.push_back({chunk.second->total, chunk.first});
+		total += chunk.second->total;
+	}
+	std::sort(chunks.begin(), chunks.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	std::vector<WorldPos> hot;
+	std::uint64_t covered = 0;
+	for (auto& chunk : chunks)
+	{
+		if (covered >= total * share)
+		{
+			break;
+		}
+		hot.push_back(chunk.second);
+		covered += chunk.first;
+	}
+	return hot;
+}
+
+std::size_t HeatMap::getHotChunkCount(float share) const
+{
+	if (share != mHotShare || mHotVersion != mVersion)
+	{
+		mHotCount	= getHotChunks(share).size();
+		mHotShare	= share;
+		mHotVersion = mVersion;
+	}
+	return mHotCount;
+}
+
+std::size_t HeatMap::getMemory() const
+{
+	std::size_t bytes = mChunks.size() * (sizeof(Chunk) + sizeof(Chunks::value_type));
+	for (auto& slot : mHistory)
+	{
+		bytes += slot.capacity() * sizeof(WorldPos);
+	}
+	return bytes;
+}
+
+WorldPos HeatMap::getChunkOf(WorldPos pos)
+{
+	return floorDiv(pos, CHUNK_SIZE);
+}
+
+std::size_t HeatMap::getOffsetOf(WorldPos pos)
+{
+	WorldPos chunk = getChunkOf(pos);
+	return (pos.y - chunk.y * CHUNK_SIZE) * CHUNK_SIZE + (pos.x - chunk.x * CHUNK_SIZE);
+}
+
+void HeatMap::count(WorldPos pos, int delta)
+{
+	//Heads come in runs along wires, so the chunk is usually the last one's.
+	WorldPos key = getChunkOf(pos);
+	if (!mLast || key != mLastKey)
+	{
+		auto found = mChunks.find(key);
+		if (found == mChunks.end())
+		{
+			if (delta < 0)
+			{
+				return;
+			}
+			found = mChunks.emplace(key, std::make_unique<Chunk>()).first;
+		}
+		mLast	 = found->second.get();
+		mLastKey = key;
+	}
+
+	Chunk& chunk = *mLast;
+	chunk.counts[getOffsetOf(pos)] += delta;
+	chunk.total += delta;
+	chunk.version = ++mVersion;
+
+	//A chunk that went quiet for a whole window is dropped.
+	if (chunk.total == 0)
+	{
+		mChunks.erase(key);
+		mLast = nullptr;
+	}
+}
@@ -0,0 +1,86 @@
+#include "HeatOverlay.hpp"
+
+HeatOverlay::HeatOverlay(const HeatMap& heat)
+	: mHeat(heat),
+	  mPixels(HeatMap::CHUNK_SIZE * HeatMap::CHUNK_SIZE * 4)
+{
+}
+
+void HeatOverlay::draw(sf::RenderTarget& target, sf::RenderStates states, WorldRect visible, WorldPos origin)
+{
+	Tracer::Span span("HeatOverlay::draw");
+
+	//Textures of chunks that went quiet.
+	const HeatMap::Chunks& chunks = mHeat.getChunks();
+	for (auto it = mEntries.begin(); it != mEntries.end();)
+	{
+		it = chunks.count(it->first) ? std::next(it) : mEntries.erase(it);
+	}
+
+	WorldPos first = HeatMap::getChunkOf({visible.left, visible.top});
+	WorldPos last  = HeatMap::getChunkOf({visible.left + visible.width - 1, visible.top + visible.height - 1});
+	float size		   = HeatMap::CHUNK_SIZE;
+	sf::VertexArray quad(sf::Quads, 4);
+	quad[0].texCoords = {0, 0};
+	quad[1].texCoords = {size, 0};
+	quad[2].texCoords = {size, size};
+	quad[3].texCoords = {0, size};
+
+	for (auto& chunk : chunks)
+	{
+		WorldPos key = chunk.first;
+		if (key.x < first.x || key.x > last.x || key.y < first.y || key.y > last.y)
+		{
+			continue;
+		}
+
+		std::unique_ptr<Entry>& entry = mEntries[key];
+		if (!entry)
+		{
+			entry = std::make_unique<Entry>();
+			entry->texture.create(HeatMap::CHUNK_SIZE, HeatMap::CHUNK_SIZE);
+		}
+		if (entry->version != chunk.second->version)
+		{
+			fill(*entry, *chunk.second);
+		}
+
+		sf::Vector2f pos(key.x * HeatMap::CHUNK_SIZE - origin.x, key.y * HeatMap::CHUNK_SIZE - origin.y);
+		quad[0].position = pos;
+		quad[1].position = pos + sf::Vector2f(size, 0);
+		quad[2].position = pos + sf::Vector2f(size, size);
+		quad[3].position = pos + sf::Vector2f(0, size);
+		sf::RenderStates chunkStates = states;
+		chunkStates.texture			 = &entry->texture;
+		target.draw(quad, chunkStates);
+	}
+}
+
+sf::Color HeatOverlay::getColor(float heat)
+{
+	//Blue, cyan, green, yellow, red, getting more opaque as it heats up.
+	static const sf::Color stops[] = {{0, 0, 255}, {0, 255, 255}, {0, 255, 0}, {255, 255, 0}, {255, 0, 0}};
+	float scaled	= std::min(std::max(heat, 0.f), 1.f) * 4;
+	int i			= std::min((int)scaled, 3);
+	float t			= scaled - i;
+	const sf::Color& a = stops[i];
+	const sf::Color& b = stops[i + 1];
+	return sf::Color(a.r + (b.r - a.r) * t,
+					 a.g + (b.g - a.g) * t,
+					 a.b + (b.b - a.b) * t,
+					 96 + 128 * heat);
+}
+
+void HeatOverlay::fill(Entry& entry, const HeatMap::Chunk& chunk)
+{
+	for (std::size_t i = 0; i < HeatMap::CHUNK_SIZE * HeatMap::CHUNK_SIZE; ++i)
+	{
+		sf::Color col = chunk.counts[i] ? getColor(mHeat.getHeat(chunk.counts[i])) : sf::Color::Transparent;
+		mPixels[i * 4]	   = col.r;
+		mPixels[i * 4 + 1] = col.g;
+		mPixels[i * 4 + 2] = col.b;
+		mPixels[i * 4 + 3] = col.a;
+	}
+	entry.texture.update(mPixels.data());
+	entry.version = chunk.version;
+}
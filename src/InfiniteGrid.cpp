@@ -1,18 +1,25 @@
 #include "InfiniteGrid.hpp"
 
-InfiniteGrid::InfiniteGrid(sf::Vector2u window_size)
+InfiniteGrid::InfiniteGrid(sf::Vector2u window_size, std::shared_ptr<GridCache> cache)
+	: mCache(cache ? cache : std::make_shared<GridCache>())
 {
 	//Init settings.
 	mWindowSize = window_size;
 	mCellSize   = 16;
-	mPosition   = {0, 0};
+	mOrigin		= {0, 0};
+	mOffset		= {0, 0};
+
+	mPriorityColor  = sf::Color::Transparent;
+	mMinimapVisible = false;
 
 	//Init constants.
 	mLineColor = sf::Color::Black;
 
 	//Init vertex arrays.
 	mGridLines.setPrimitiveType(sf::Lines);
-	mGridCells.setPrimitiveType(sf::Quads);
+	mLodCells.setPrimitiveType(sf::Quads);
+	mMinimap.setPrimitiveType(sf::Quads);
+	mCacheRevision = mCache->getRevision();
 
 	init();
 }
@@ -26,10 +33,41 @@ void InfiniteGrid::updateWindowSize(sf::Vector2u new_size)
 
 void InfiniteGrid::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
+	Tracer::Span span("InfiniteGrid::draw");
+
+	//Only the tiles on screen.
+	sf::RenderStates cellStates = states;
+	cellStates.transform *= mGridCellTransform;
+	WorldRect visible(mOrigin.x - 1,
+					  mOrigin.y - 1,
+					  (sf::Int64)(mWindowSize.x / mCellSize) + 3,
+					  (sf::Int64)(mWindowSize.y / mCellSize) + 3);
 
-	target.draw(mGridCells, states);
-	states.transform *= mGridLineTransform;
-	target.draw(mGridLines, states);
+	//Below 1px per cell, blocks are drawn instead, and the lines would cover everything.
+	if (mCellSize < 1)
+	{
+		target.draw(mLodCells, states);
+		if (mOverlay)
+		{
+			mOverlay->draw(target, cellStates, visible, mOrigin);
+		}
+	}
+	else
+	{
+		mCache->draw(target, cellStates, visible, mOrigin);
+		if (mOverlay)
+		{
+			mOverlay->draw(target, cellStates, visible, mOrigin);
+		}
+
+		sf::RenderStates lineStates = states;
+		lineStates.transform *= mGridLineTransform;
+		target.draw(mGridLines, lineStates);
+	}
+	if (mMinimapVisible)
+	{
+		target.draw(mMinimap, states);
+	}
 }
 
 void InfiniteGrid::init()
@@ -81,6 +119,7 @@ void InfiniteGrid::update()
 	//Update everything.
 	updateLines();
 	updateCells();
+	updateMinimap();
 }
 
 void InfiniteGrid::updateLines()
@@ -89,8 +128,8 @@ void InfiniteGrid::updateLines()
 
 	//Shift over by the position modulo the cell size, divided by the cell size.
 	mGridLineTransform.translate(
-		(int)(mPosition.x * mCellSize) % mCellSize,
-		(int)(mPosition.y * mCellSize) % mCellSize);
+		std::fmod(std::floor(-mOffset.x * mCellSize), mCellSize),
+		std::fmod(std::floor(-mOffset.y * mCellSize), mCellSize));
 
 	//Zoom in by the CellSize
 	mGridLineTransform.scale(mCellSize, mCellSize);
@@ -98,65 +137,191 @@ void InfiniteGrid::updateLines()
 
 void InfiniteGrid::updateCells()
 {
-	mGridCells.clear();
+	Tracer::Span span("InfiniteGrid::updateCells");
+
+	//The slots stay put, only the transform follows the view. Same rounding as the lines.
+	//It places cells relative to the origin; overlays use it at every zoom.
+	mGridCellTransform = sf::Transform::Identity;
+	mGridCellTransform.translate(std::floor(-mOffset.x * mCellSize), std::floor(-mOffset.y * mCellSize));
+	mGridCellTransform.scale(mCellSize, mCellSize);
+
+	if (mCellSize < 1)
+	{
+		updateLodCells();
+	}
+}
 
-	//Iterate over all cells.
-	for (auto& cell : mCells)
+void InfiniteGrid::updateLodCells()
+{
+	//Pick the level where one block covers at least a pixel.
+	int level		= std::min((int)std::ceil(std::log2(1 / mCellSize)), LodPyramid::LEVELS);
+	int blockCells  = 1 << level;
+	float blockSize = mCellSize * blockCells;
+
+	//The visible blocks. The offset is under a cell, so the margin covers it.
+	WorldRect visible((mOrigin.x >> level) - 1,
+					  (mOrigin.y >> level) - 1,
+					  (sf::Int64)(mWindowSize.x / blockSize) + 3,
+					  (sf::Int64)(mWindowSize.y / blockSize) + 3);
+
+	//Gather the visible blocks, walking whichever is smaller, the blocks of the level or the blocks on screen.
+	//Looking up the blocks on screen is the slow part, so it's split into bands of rows.
+	const LodPyramid& pyramid		= mCache->getPyramid();
+	const LodPyramid::Level& blocks = pyramid.getLevel(level);
+	ThreadPool& pool				= mCache->getPool();
+	auto getBands = [&](std::size_t work, std::size_t units) {
+		return work < GridCache::PARALLEL_CELLS ? 1 : std::min(units, pool.getConcurrency() * 4);
+	};
+	mVisibleBlocks.clear();
+	if ((long long)visible.width * visible.height < (long long)blocks.size())
+	{
+		std::size_t bands = getBands((std::size_t)visible.width * visible.height, visible.height);
+		mBands.resize(bands);
+		pool.run(bands, [&](std::size_t band) {
+			Tracer::Span span("InfiniteGrid::findBlocks");
+			mBands[band].clear();
+			sf::Int64 first = visible.top + (sf::Int64)(visible.height * band / bands);
+			sf::Int64 last	= visible.top + (sf::Int64)(visible.height * (band + 1) / bands);
+			for (sf::Int64 y = first; y < last; ++y)
+			{
+				for (sf::Int64 x = visible.left; x < visible.left + visible.width; ++x)
+				{
+					auto found = blocks.find({x, y});
+					if (found != blocks.end())
+					{
+						mBands[band].push_back(&*found);
+					}
+				}
+			}
+		});
+		for (auto& band : mBands)
+		{
+			mVisibleBlocks.insert(mVisibleBlocks.end(), band.begin(), band.end());
+		}
+	}
+	else
 	{
-		//The actual position of the cell is cell.pos + mPosition
-		sf::Vector2f pos = sf::Vector2f(cell.pos) + mPosition;
+		for (auto& block : blocks)
+		{
+			if (visible.contains(block.first))
+			{
+				mVisibleBlocks.push_back(&block);
+			}
+		}
+	}
 
-		//Ignore if we're out of bounds.
-		sf::FloatRect bounds(-5, -5, mWindowSize.x / mCellSize + 5, mWindowSize.y / mCellSize + 5);
-		if (!bounds.contains(pos))
+	//Every block has its own 4 vertices, so the bands fill in their own slices of the array.
+	mLodCells.resize(mVisibleBlocks.size() * 4);
+	std::size_t count = mVisibleBlocks.size();
+	std::size_t bands = getBands(count, count);
+	pool.run(bands, [&](std::size_t band) {
+		Tracer::Span span("InfiniteGrid::buildBlocks");
+		for (std::size_t i = count * band / bands; i < count * (band + 1) / bands; ++i)
 		{
-			continue;
+			WorldPos block	 = mVisibleBlocks[i]->first;
+			sf::Vector2f pos = (sf::Vector2f(block.x * blockCells - mOrigin.x, block.y * blockCells - mOrigin.y) - mOffset) * mCellSize;
+			setQuad(&mLodCells[i * 4],
+					{std::floor(pos.x), std::floor(pos.y)},
+					{std::max(blockSize, 1.f), std::max(blockSize, 1.f)},
+					pyramid.getColor(mVisibleBlocks[i]->second, level, mPriorityColor));
 		}
+	});
+}
 
-		pos.x *= mCellSize;
-		pos.y *= mCellSize;
+void InfiniteGrid::updateMinimap()
+{
+	mMinimap.clear();
 
-		pos.x = std::floor(pos.x);
-		pos.y = std::floor(pos.y);
+	WorldRect bounds;
+	if (!mMinimapVisible || !mCache->getPyramid().getBounds(bounds))
+	{
+		return;
+	}
+
+	//Fit the whole grid into the minimap, and summarize it at the matching level.
+	float scale = MINIMAP_SIZE / (float)std::max(bounds.width, bounds.height);
+	int level   = std::max(1, std::min((int)std::ceil(std::log2(1 / scale)), LodPyramid::LEVELS));
+	sf::Vector2f origin(mWindowSize.x - MINIMAP_SIZE - 5, 5);
 
-		//Create a quad at the given position
-		mGridCells.append(sf::Vertex(
-			pos,
-			cell.col));
-		mGridCells.append(sf::Vertex(
-			sf::Vector2f(pos.x + mCellSize, pos.y),
-			cell.col));
-		mGridCells.append(sf::Vertex(
-			sf::Vector2f(pos.x + mCellSize, pos.y + mCellSize),
-			cell.col));
-		mGridCells.append(sf::Vertex(
-			sf::Vector2f(pos.x, pos.y + mCellSize),
-			cell.col));
+	appendQuad(mMinimap, origin, {MINIMAP_SIZE, MINIMAP_SIZE}, sf::Color(255, 255, 255, 220));
+	for (auto& block : mCache->getPyramid().getLevel(level))
+	{
+		sf::Vector2f pos = sf::Vector2f(block.first.x * (1 << level) - bounds.left, block.first.y * (1 << level) - bounds.top) * scale;
+		appendQuad(mMinimap,
+				   origin + pos,
+				   {std::max(scale * (1 << level), 1.f), std::max(scale * (1 << level), 1.f)},
+				   mCache->getPyramid().getColor(block.second, level, mPriorityColor));
 	}
+
+	//Outline the part of the grid on screen.
+	sf::Vector2f view = (sf::Vector2f(mOrigin.x - bounds.left, mOrigin.y - bounds.top) + mOffset) * scale;
+	sf::Vector2f size = sf::Vector2f(mWindowSize) / mCellSize * scale;
+	sf::Color frame(255, 0, 0, 160);
+	appendQuad(mMinimap, origin + view, {size.x, 1}, frame);
+	appendQuad(mMinimap, origin + view + sf::Vector2f(0, size.y), {size.x, 1}, frame);
+	appendQuad(mMinimap, origin + view, {1, size.y}, frame);
+	appendQuad(mMinimap, origin + view + sf::Vector2f(size.x, 0), {1, size.y}, frame);
 }
 
-void InfiniteGrid::setPosition(sf::Vector2f newPos)
+void InfiniteGrid::appendQuad(sf::VertexArray& arr, sf::Vector2f pos, sf::Vector2f size, sf::Color col)
 {
-	mPosition = newPos;
+	arr.append(sf::Vertex(pos, col));
+	arr.append(sf::Vertex(sf::Vector2f(pos.x + size.x, pos.y), col));
+	arr.append(sf::Vertex(sf::Vector2f(pos.x + size.x, pos.y + size.y), col));
+	arr.append(sf::Vertex(sf::Vector2f(pos.x, pos.y + size.y), col));
+}
+
+void InfiniteGrid::setPosition(WorldPos origin, sf::Vector2f offset)
+{
+	//Keep only the fraction of a cell in the float.
+	sf::Vector2f whole(std::floor(offset.x), std::floor(offset.y));
+	mOrigin = origin + WorldPos((sf::Int64)whole.x, (sf::Int64)whole.y);
+	mOffset = offset - whole;
 
 	update();
 }
 
-sf::Vector2f InfiniteGrid::getPosition()
+void InfiniteGrid::move(sf::Vector2f delta)
+{
+	setPosition(mOrigin, mOffset + delta);
+}
+
+void InfiniteGrid::centerOn(WorldPos cell)
+{
+	setPosition(cell, sf::Vector2f(0.5f, 0.5f) - sf::Vector2f(mWindowSize) / (2.f * mCellSize));
+}
+
+WorldPos InfiniteGrid::getOrigin()
+{
+	return mOrigin;
+}
+
+sf::Vector2f InfiniteGrid::getOffset()
 {
-	return mPosition;
+	return mOffset;
+}
+
+WorldPos InfiniteGrid::getCellAt(sf::Vector2f point)
+{
+	sf::Vector2f cells = point / mCellSize + mOffset;
+	return mOrigin + WorldPos((sf::Int64)std::floor(cells.x), (sf::Int64)std::floor(cells.y));
+}
+
+WorldPos InfiniteGrid::getCenter()
+{
+	return getCellAt(sf::Vector2f(mWindowSize) / 2.f);
 }
 
 //CELL MANIP
 
-void InfiniteGrid::setCellSize(int newSize)
+void InfiniteGrid::setCellSize(float newSize)
 {
 	mCellSize = newSize;
 
-	//Constrain the cell size.
-	if (mCellSize < 1)
+	//Constrain the cell size, down to one pixel per block of the coarsest LOD level.
+	if (mCellSize < 1.f / (1 << LodPyramid::LEVELS))
 	{
-		mCellSize = 1;
+		mCellSize = 1.f / (1 << LodPyramid::LEVELS);
 	}
 	else if (mCellSize > 500)
 	{
@@ -166,73 +331,114 @@ void InfiniteGrid::setCellSize(int newSize)
 	update();
 }
 
-int InfiniteGrid::getCellSize()
+float InfiniteGrid::getCellSize()
 {
 	return mCellSize;
 }
 
-void InfiniteGrid::setCell(Cell c)
+void InfiniteGrid::zoom(int steps)
 {
-	//Check for a cell already at c.pos. If there is none, push to mCells.
-	if (!isCell(c.pos))
+	float size = mCellSize;
+	for (; steps > 0; --steps)
 	{
-		mCells.push_back(c);
+		size = (size < 1) ? size * 2 : size + 1;
 	}
-	else
+	for (; steps < 0; ++steps)
 	{
-		//If this boilerplate gets excessive i'll refactor it
-		//otherwise, shush. I don't wanna return a pointer from getCell().
-		*(std::find_if(mCells.begin(), mCells.end(), [c](Cell& x) {
-			return x.pos == c.pos;
-		})) = c;
+		size = (size <= 1) ? size / 2 : size - 1;
 	}
+	setCellSize(size);
+}
+
+void InfiniteGrid::setPriorityColor(sf::Color col)
+{
+	mPriorityColor = col;
 
 	update();
 }
 
-bool InfiniteGrid::isCell(sf::Vector2i pos)
+void InfiniteGrid::setMinimapVisible(bool visible)
 {
-	//Try to find the cell.
-	auto found = std::find_if(mCells.begin(), mCells.end(),
-							  [pos](Cell& c) {
-								  return c.pos == pos;
-							  });
+	mMinimapVisible = visible;
 
-	//Return if it was found or not.
-	return (found != mCells.end());
+	update();
 }
 
-InfiniteGrid::Cell InfiniteGrid::getCell(sf::Vector2i pos)
+bool InfiniteGrid::isMinimapVisible()
 {
-	//If there isn't a cell, return a white cell @ 0,0 as a placeholder.
-	if (!isCell(pos))
-	{
-		return {.pos = {0, 0}, .col = sf::Color::White};
-	}
+	return mMinimapVisible;
+}
+
+void InfiniteGrid::setOverlay(std::shared_ptr<HeatOverlay> overlay)
+{
+	mOverlay = overlay;
+}
+
+std::shared_ptr<HeatOverlay> InfiniteGrid::getOverlay()
+{
+	return mOverlay;
+}
 
-	return *(std::find_if(mCells.begin(), mCells.end(),
-						  [pos](Cell& x) {
-							  return x.pos == pos;
-						  }));
+std::shared_ptr<GridCache> InfiniteGrid::getCache()
+{
+	return mCache;
 }
 
-void InfiniteGrid::clearCell(sf::Vector2i pos)
+void InfiniteGrid::refresh()
 {
-	//Remove the cell with the given position.
-	for (auto i = mCells.begin(); i != mCells.end(); ++i)
+	if (mCacheRevision == mCache->getRevision())
 	{
-		if (i->pos == pos)
-		{
-			mCells.erase(i);
-			update();
-			return;
-		}
+		return;
 	}
+	mCacheRevision = mCache->getRevision();
+
+	//The zoomed out views are built from the pyramid, so they follow the cells.
+	if (mCellSize < 1)
+	{
+		updateLodCells();
+	}
+	updateMinimap();
 }
 
-void InfiniteGrid::clear()
+void InfiniteGrid::setCell(Cell c)
+{
+	mCache->setCell(c);
+	refresh();
+}
+
+void InfiniteGrid::setCells(const std::vector<Cell>& cells)
+{
+	mCache->setCells(cells);
+	refresh();
+}
+
+bool InfiniteGrid::isCell(WorldPos pos)
+{
+	return mCache->isCell(pos);
+}
+
+InfiniteGrid::Cell InfiniteGrid::getCell(WorldPos pos)
+{
+	return mCache->getCell(pos);
+}
+
+void InfiniteGrid::clearCell(WorldPos pos)
 {
-	mCells.clear();
+	mCache->clearCell(pos);
+	refresh();
+}
 
+void InfiniteGrid::clear()
+{
+	mCache->clear();
+	mCacheRevision = mCache->getRevision();
 	update();
-}
\ No newline at end of file
+}
+
+void InfiniteGrid::setQuad(sf::Vertex* quad, sf::Vector2f pos, sf::Vector2f size, sf::Color col)
+{
+	quad[0] = sf::Vertex(pos, col);
+	quad[1] = sf::Vertex(sf::Vector2f(pos.x + size.x, pos.y), col);
+	quad[2] = sf::Vertex(sf::Vector2f(pos.x + size.x, pos.y + size.y), col);
+	quad[3] = sf::Vertex(sf::Vector2f(pos.x, pos.y + size.y), col);
+}
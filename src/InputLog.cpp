@@ -0,0 +1,154 @@
+#include "InputLog.hpp"
+
+bool InputLog::openWrite(const std::string& path)
+{
+	mOut.open(path);
+	if (!mOut)
+	{
+		return false;
+	}
+
+	mOut << "# Wireworld input log\n";
+	mOut << "# F <dt us> <mouse x> <mouse y> <events>, then E <type> <fields...> per event\n";
+	return true;
+}
+
+bool InputLog::openRead(const std::string& path)
+{
+	mIn.open(path);
+	return (bool)mIn;
+}
+
+bool InputLog::isRecorded(const sf::Event& event)
+{
+	switch (event.type)
+	{
+	case sf::Event::Closed:
+	case sf::Event::Resized:
+	case sf::Event::MouseButtonPressed:
+	case sf::Event::MouseButtonReleased:
+	case sf::Event::MouseWheelScrolled:
+	case sf::Event::KeyPressed:
+	case sf::Event::KeyReleased:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void InputLog::write(const Frame& frame)
+{
+	std::size_t count = 0;
+	for (auto& event : frame.events)
+	{
+		count += isRecorded(event);
+	}
+
+	mOut << "F " << frame.dt.asMicroseconds() << " " << frame.mouse.x << " " << frame.mouse.y << " " << count << "\n";
+	for (auto& event : frame.events)
+	{
+		if (!isRecorded(event))
+		{
+			continue;
+		}
+
+		mOut << "E " << event.type;
+		switch (event.type)
+		{
+		default:
+			break;
+		case sf::Event::Resized:
+			mOut << " " << event.size.width << " " << event.size.height;
+			break;
+		case sf::Event::MouseButtonPressed:
+		case sf::Event::MouseButtonReleased:
+			mOut << " " << event.mouseButton.button << " " << event.mouseButton.x << " " << event.mouseButton.y;
+			break;
+		case sf::Event::MouseWheelScrolled:
+			mOut << " " << event.mouseWheelScroll.delta << " " << event.mouseWheelScroll.x << " " << event.mouseWheelScroll.y;
+			break;
+		case sf::Event::KeyPressed:
+		case sf::Event::KeyReleased:
+			mOut << " " << event.key.code << " " << event.key.shift << " " << event.key.control << " " << event.key.alt;
+			break;
+		}
+		mOut << "\n";
+	}
+
+	//Flush every frame, so a crash still leaves a usable log.
+	mOut.flush();
+}
+
+bool InputLog::read(Frame& frame)
+{
+	std::string line;
+	if (!nextLine(line))
+	{
+		return false;
+	}
+
+	long long dt;
+	int count;
+	if (std::sscanf(line.c_str(), "F %lld %d %d %d", &dt, &frame.mouse.x, &frame.mouse.y, &count) != 4)
+	{
+		return false;
+	}
+	frame.dt = sf::microseconds(dt);
+	frame.events.clear();
+
+	for (int i = 0; i < count; ++i)
+	{
+		if (!nextLine(line))
+		{
+			return false;
+		}
+
+		int type, a = 0, b = 0, c = 0, d = 0;
+		float delta = 0;
+		if (std::sscanf(line.c_str(), "E %d", &type) != 1)
+		{
+			return false;
+		}
+
+		sf::Event event;
+		event.type = (sf::Event::EventType)type;
+		switch (event.type)
+		{
+		default:
+			break;
+		case sf::Event::Resized:
+			std::sscanf(line.c_str(), "E %*d %d %d", &a, &b);
+			event.size = {(unsigned int)a, (unsigned int)b};
+			break;
+		case sf::Event::MouseButtonPressed:
+		case sf::Event::MouseButtonReleased:
+			std::sscanf(line.c_str(), "E %*d %d %d %d", &a, &b, &c);
+			event.mouseButton = {(sf::Mouse::Button)a, b, c};
+			break;
+		case sf::Event::MouseWheelScrolled:
+			std::sscanf(line.c_str(), "E %*d %f %d %d", &delta, &b, &c);
+			event.mouseWheelScroll = {sf::Mouse::VerticalWheel, delta, b, c};
+			break;
+		case sf::Event::KeyPressed:
+		case sf::Event::KeyReleased:
+			std::sscanf(line.c_str(), "E %*d %d %d %d %d", &a, &b, &c, &d);
+			event.key = {(sf::Keyboard::Key)a, d != 0, c != 0, b != 0, false};
+			break;
+		}
+		frame.events.push_back(event);
+	}
+
+	return true;
+}
+
+bool InputLog::nextLine(std::string& line)
+{
+	while (std::getline(mIn, line))
+	{
+		if (!line.empty() && line[0] != '#')
+		{
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,158 @@
+#include "LodPyramid.hpp"
+
+void LodPyramid::add(WorldPos pos, sf::Color col)
+{
+	int color = getColorIndex(col);
+	for (int level = 1; level <= LEVELS; ++level)
+	{
+		Summary& block = mLevels[level - 1][{pos.x >> level, pos.y >> level}];
+		block.total++;
+		block.counts[color]++;
+	}
+}
+
+void LodPyramid::remove(WorldPos pos, sf::Color col)
+{
+	int color = getColorIndex(col);
+	for (int level = 1; level <= LEVELS; ++level)
+	{
+		auto found = mLevels[level - 1].find({pos.x >> level, pos.y >> level});
+		if (found == mLevels[level - 1].end())
+		{
+			continue;
+		}
+
+		found->second.total--;
+		found->second.counts[color]--;
+		if (found->second.total == 0)
+		{
+			mLevels[level - 1].erase(found);
+		}
+	}
+}
+
+void LodPyramid::apply(const std::vector<Change>& changes, int level)
+{
+	//Neighboring cells mostly share blocks, more so the coarser the level, so the last block is kept at hand.
+	Level& blocks = mLevels[level - 1];
+	WorldPos lastKey;
+	Summary* last = nullptr;
+	for (auto& change : changes)
+	{
+		WorldPos key(change.pos.x >> level, change.pos.y >> level);
+		if (!last || key != lastKey)
+		{
+			if (change.from == NO_COLOR)
+			{
+				last = &blocks[key];
+			}
+			else
+			{
+				auto found = blocks.find(key);
+				last	   = found == blocks.end() ? nullptr : &found->second;
+			}
+			lastKey = key;
+		}
+		if (!last)
+		{
+			continue;
+		}
+
+		if (change.from != NO_COLOR)
+		{
+			last->counts[change.from]--;
+			last->total--;
+		}
+		if (change.to != NO_COLOR)
+		{
+			last->counts[change.to]++;
+			last->total++;
+		}
+		else if (last->total == 0)
+		{
+			blocks.erase(key);
+			last = nullptr;
+		}
+	}
+}
+
+void LodPyramid::clear()
+{
+	for (auto& level : mLevels)
+	{
+		level.clear();
+	}
+}
+
+const LodPyramid::Level& LodPyramid::getLevel(int level) const
+{
+	return mLevels[std::min(std::max(level, 1), LEVELS) - 1];
+}
+
+sf::Color LodPyramid::getColor(const Summary& summary, int level, sf::Color priority) const
+{
+	//The priority color wins if it's there at all, otherwise the most common color does.
+	int best = 0;
+	for (int i = 0; i < (int)mPalette.size(); ++i)
+	{
+		if (summary.counts[i] > 0 && mPalette[i] == priority)
+		{
+			best = i;
+			break;
+		}
+		if (summary.counts[i] > summary.counts[best])
+		{
+			best = i;
+		}
+	}
+
+	//Fade out sparse blocks, but never so far that they vanish.
+	float occupancy = summary.total / std::pow(4.f, level);
+	sf::Color col   = mPalette.empty() ? priority : mPalette[best];
+	col.a			= 96 + 159 * std::min(1.f, std::sqrt(occupancy));
+	return col;
+}
+
+bool LodPyramid::getBounds(WorldRect& bounds) const
+{
+	//Use the finest level that's small enough to scan quickly.
+	int level = 1;
+	while (level < LEVELS && mLevels[level - 1].size() > 4096)
+	{
+		level++;
+	}
+	if (mLevels[level - 1].empty())
+	{
+		return false;
+	}
+
+	WorldPos min = mLevels[level - 1].begin()->first;
+	WorldPos max = min;
+	for (auto& block : mLevels[level - 1])
+	{
+		min.x = std::min(min.x, block.first.x);
+		min.y = std::min(min.y, block.first.y);
+		max.x = std::max(max.x, block.first.x);
+		max.y = std::max(max.y, block.first.y);
+	}
+
+	sf::Int64 size = 1 << level;
+	bounds		   = WorldRect(min.x * size, min.y * size,
+							   (max.x - min.x + 1) * size, (max.y - min.y + 1) * size);
+	return true;
+}
+
+int LodPyramid::getColorIndex(sf::Color col)
+{
+	auto found = std::find(mPalette.begin(), mPalette.end(), col);
+	if (found != mPalette.end())
+	{
+		return found - mPalette.begin();
+	}
+	if (mPalette.size() < PALETTE_SIZE)
+	{
+		mPalette.push_back(col);
+		return mPalette.size() - 1;
+	}
+	return PALETTE_SIZE - 1;
+}
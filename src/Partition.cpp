@@ -0,0 +1,118 @@
+#include "Partition.hpp"
+
+Partition::Partition(sf::Int64 left, sf::Int64 right)
+	: mLeft(left),
+	  mRight(right)
+{
+}
+
+bool Partition::contains(WorldPos pos)
+{
+	return pos.x >= mLeft && pos.x < mRight;
+}
+
+void Partition::setCell(Cell c)
+{
+	auto found = mIndex.find(c.getPosition());
+	if (found != mIndex.end())
+	{
+		mCells[found->second] = c;
+		return;
+	}
+
+	//Remember if it's on either edge, so halos don't need a full scan.
+	if (c.getPosition().x == mLeft)
+	{
+		mLeftEdge.push_back(mCells.size());
+	}
+	if (c.getPosition().x == mRight - 1)
+	{
+		mRightEdge.push_back(mCells.size());
+	}
+
+	mIndex[c.getPosition()] = mCells.size();
+	mCells.push_back(c);
+}
+
+std::vector<sf::Int64> Partition::getEdgeHeads(bool leftEdge)
+{
+	std::vector<sf::Int64> rows;
+	for (auto& i : (leftEdge ? mLeftEdge : mRightEdge))
+	{
+		if (mCells[i].getType() == Cell::HEAD)
+		{
+			rows.push_back(mCells[i].getPosition().y);
+		}
+	}
+	return rows;
+}
+
+void Partition::setHalo(bool leftEdge, const std::vector<sf::Int64>& rows)
+{
+	sf::Int64 x = leftEdge ? mLeft - 1 : mRight;
+
+	//Clear the old halo on that side.
+	for (auto i = mHalo.begin(); i != mHalo.end();)
+	{
+		i = (i->first.x == x) ? mHalo.erase(i) : std::next(i);
+	}
+
+	for (auto& y : rows)
+	{
+		mHalo.emplace(WorldPos(x, y), Cell(Cell::HEAD, {x, y}));
+	}
+}
+
+void Partition::step()
+{
+	//Same as Wireworld::step(), but neighbors may come from the halo too.
+	std::vector<Cell> cells_cpy = mCells;
+	std::vector<Cell*> neighbors;
+	for (auto& cell : cells_cpy)
+	{
+		WorldPos pos = cell.getPosition();
+		neighbors.clear();
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				if (dx == 0 && dy == 0)
+				{
+					continue;
+				}
+
+				WorldPos cpos = pos + WorldPos(dx, dy);
+				auto found		  = mIndex.find(cpos);
+				if (found != mIndex.end())
+				{
+					neighbors.push_back(&mCells[found->second]);
+					continue;
+				}
+				auto halo = mHalo.find(cpos);
+				if (halo != mHalo.end())
+				{
+					neighbors.push_back(&halo->second);
+				}
+			}
+		}
+
+		cell.step(neighbors);
+	}
+
+	mCells = cells_cpy;
+}
+
+std::vector<Cell>& Partition::getCells()
+{
+	return mCells;
+}
+
+sf::Int64 Partition::getLeft()
+{
+	return mLeft;
+}
+
+sf::Int64 Partition::getRight()
+{
+	return mRight;
+}
@@ -0,0 +1,197 @@
+#include "Player.hpp"
+
+Player::Player()
+	: mWindow(sf::VideoMode(700, 700),
+			  "Wireworld Player",
+			  sf::Style::Titlebar | sf::Style::Close),
+	  mGrid(mWindow.getSize()),
+	  mSpeed(16),
+	  mPending(0),
+	  mPlaying(false),
+	  mBackwards(false)
+{
+	mWindow.setFramerateLimit(60);
+
+	mHUDFont.loadFromFile("resource/font.ttf");
+	mHUD.setFont(mHUDFont);
+	mHUD.setFillColor(sf::Color::Black);
+	mHUD.setCharacterSize(20);
+	mHUD.setPosition(5, 5);
+
+	mGrid.setPriorityColor(Wireworld::CELL_COLORS.at(Cell::HEAD));
+}
+
+bool Player::open(const std::string& path)
+{
+	if (!mReader.open(path))
+	{
+		return false;
+	}
+
+	std::vector<InfiniteGrid::Cell> colored;
+	for (auto& cell : mReader.getCells())
+	{
+		colored.push_back({.pos = cell.getPosition(), .col = Wireworld::CELL_COLORS.at(cell.getType())});
+	}
+	mGrid.clear();
+	mGrid.setCells(colored);
+	mPending = 0;
+	return true;
+}
+
+int Player::run()
+{
+	sf::Clock frame;
+	while (mWindow.isOpen())
+	{
+		sf::Event event;
+		while (mWindow.pollEvent(event))
+		{
+			handleEvent(event);
+		}
+
+		//Panning.
+		if (mMousePan.mouseHeld)
+		{
+			sf::Vector2f mouse = sf::Vector2f(sf::Mouse::getPosition(mWindow)) / mGrid.getCellSize();
+			mGrid.setPosition(mMousePan.initialOrigin, mMousePan.initialOffset - (mouse - mMousePan.initialMouse));
+		}
+
+		advance(frame.restart());
+		updateHUD();
+
+		mWindow.clear(sf::Color::White);
+		mWindow.draw(mGrid);
+		mWindow.draw(mHUD);
+		mWindow.display();
+	}
+
+	return 0;
+}
+
+void Player::handleEvent(const sf::Event& event)
+{
+	long long generation = mReader.getGeneration();
+	long long tenth		 = std::max(mReader.getGenerations() / 10, 1ull);
+	switch (event.type)
+	{
+	default:
+		break;
+	case sf::Event::Closed:
+		mWindow.close();
+		break;
+	case sf::Event::KeyPressed:
+		switch (event.key.code)
+		{
+		default:
+			break;
+		case sf::Keyboard::Space:
+			mPlaying = !mPlaying;
+			mPending = 0;
+			break;
+		case sf::Keyboard::Equal:
+			mSpeed = std::min(mSpeed * 2, MAX_SPEED);
+			break;
+		case sf::Keyboard::Hyphen:
+			mSpeed = std::max(mSpeed / 2, MIN_SPEED);
+			break;
+		case sf::Keyboard::B:
+			mBackwards = !mBackwards;
+			break;
+		case sf::Keyboard::Right:
+			mPlaying = false;
+			seek(generation + 1);
+			break;
+		case sf::Keyboard::Left:
+			mPlaying = false;
+			seek(generation - 1);
+			break;
+		case sf::Keyboard::PageDown:
+			seek(generation + tenth);
+			break;
+		case sf::Keyboard::PageUp:
+			seek(generation - tenth);
+			break;
+		case sf::Keyboard::Home:
+			seek(0);
+			break;
+		case sf::Keyboard::End:
+			seek(mReader.getGenerations());
+			break;
+		}
+		break;
+	case sf::Event::MouseButtonPressed:
+		if (event.mouseButton.button == sf::Mouse::Middle)
+		{
+			mMousePan.mouseHeld	= true;
+			mMousePan.initialMouse = sf::Vector2f(sf::Mouse::getPosition(mWindow)) / mGrid.getCellSize();
+			mMousePan.initialOrigin = mGrid.getOrigin();
+			mMousePan.initialOffset = mGrid.getOffset();
+		}
+		break;
+	case sf::Event::MouseButtonReleased:
+		if (event.mouseButton.button == sf::Mouse::Middle)
+		{
+			mMousePan.mouseHeld = false;
+		}
+		break;
+	case sf::Event::MouseWheelScrolled:
+		mGrid.zoom((event.mouseWheelScroll.delta > 0) ? 1 : -1);
+		break;
+	}
+}
+
+void Player::advance(sf::Time dt)
+{
+	if (!mPlaying)
+	{
+		return;
+	}
+
+	//However fast it plays, only the generation shown at the end of the frame is read.
+	mPending += dt.asSeconds() * mSpeed;
+	long long steps = (long long)mPending;
+	mPending -= steps;
+	if (steps == 0)
+	{
+		return;
+	}
+
+	long long generation = mReader.getGeneration();
+	seek(mBackwards ? generation - steps : generation + steps);
+
+	//Stop at either end.
+	if (mReader.getGeneration() == (mBackwards ? 0 : mReader.getGenerations()))
+	{
+		mPlaying = false;
+	}
+}
+
+void Player::seek(long long generation)
+{
+	if (!mReader.seek(std::max(generation, 0ll)))
+	{
+		mPlaying = false;
+		return;
+	}
+
+	std::vector<InfiniteGrid::Cell> changed;
+	changed.reserve(mReader.getChanged().size());
+	for (auto& cell : mReader.getChanged())
+	{
+		changed.push_back({.pos = cell.getPosition(), .col = Wireworld::CELL_COLORS.at(cell.getType())});
+	}
+	mGrid.setCells(changed);
+}
+
+void Player::updateHUD()
+{
+	std::stringstream ss;
+	ss << "Generation - " << mReader.getGeneration() << " / " << mReader.getGenerations()
+	   << (mReader.isIncomplete() ? " (cut short)" : "") << "\n";
+	ss << "Speed - " << (mBackwards ? "-" : "") << mSpeed << " gen/s" << (mPlaying ? "" : ", paused") << "\n";
+	ss << std::fixed << std::setprecision(1) << "Recording - " << mReader.getBytes() / 1024.f << "KB, "
+	   << mReader.getBytes() * 8.f / std::max(mReader.getGenerations(), 1ull) / 1024.f << "Kbit/gen\n";
+
+	mHUD.setString(ss.str());
+}
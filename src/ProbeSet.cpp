@@ -0,0 +1,166 @@
+#include "ProbeSet.hpp"
+
+#include "WorldFile.hpp"
+
+ProbeSet::ProbeSet()
+	: mHead(0),
+	  mRecorded(0),
+	  mLastGeneration(0),
+	  mNextName(0)
+{
+}
+
+void ProbeSet::add(const std::string& name, WorldPos pos)
+{
+	remove(pos);
+	mProbes.push_back({name, pos, std::vector<std::uint8_t>(HISTORY, Cell::NONE)});
+}
+
+bool ProbeSet::remove(WorldPos pos)
+{
+	for (auto i = mProbes.begin(); i != mProbes.end(); ++i)
+	{
+		if (i->pos == pos)
+		{
+			mProbes.erase(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ProbeSet::toggle(WorldPos pos)
+{
+	if (!remove(pos))
+	{
+		add("p" + std::to_string(mNextName++), pos);
+	}
+}
+
+void ProbeSet::clear()
+{
+	mProbes.clear();
+	mHead	  = 0;
+	mRecorded = 0;
+	mNextName = 0;
+}
+
+void ProbeSet::record(unsigned long long generation, const std::function<Cell::Type(WorldPos)>& lookup)
+{
+	for (auto& probe : mProbes)
+	{
+		probe.ring[mHead] = lookup(probe.pos);
+	}
+	mHead			= (mHead + 1) % HISTORY;
+	mLastGeneration = generation;
+	mRecorded++;
+}
+
+const std::vector<ProbeSet::Probe>& ProbeSet::getProbes() const
+{
+	return mProbes;
+}
+
+std::size_t ProbeSet::getLength() const
+{
+	return mRecorded < HISTORY ? mRecorded : HISTORY;
+}
+
+unsigned long long ProbeSet::getFirstGeneration() const
+{
+	return mLastGeneration + 1 - getLength();
+}
+
+Cell::Type ProbeSet::getSample(std::size_t probe, std::size_t i) const
+{
+	//The oldest kept sample sits right where the next one will be written, once the ring is full.
+	std::size_t oldest = (mHead + HISTORY - getLength()) % HISTORY;
+	return (Cell::Type)mProbes[probe].ring[(oldest + i) % HISTORY];
+}
+
+bool ProbeSet::saveCsv(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "generation";
+	for (auto& probe : mProbes)
+	{
+		file << "," << probe.name << " (" << probe.pos.x << " " << probe.pos.y << ")";
+	}
+	file << "\n";
+
+	for (std::size_t i = 0; i < getLength(); ++i)
+	{
+		file << getFirstGeneration() + i;
+		for (std::size_t p = 0; p < mProbes.size(); ++p)
+		{
+			Cell::Type type = getSample(p, i);
+			file << "," << (type == Cell::NONE ? '.' : WorldFile::typeToChar(type));
+		}
+		file << "\n";
+	}
+
+	return bool(file);
+}
+
+bool ProbeSet::saveVcd(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	//VCD identifiers are strings of printable characters, '!' to '~'.
+	auto id = [](std::size_t n) {
+		std::string s;
+		do
+		{
+			s += (char)('!' + n % 94);
+			n /= 94;
+		} while (n);
+		return s;
+	};
+
+	file << "$comment Wireworld probes, 1 time unit per generation $end\n";
+	file << "$timescale 1 ns $end\n";
+	file << "$scope module wireworld $end\n";
+	for (std::size_t p = 0; p < mProbes.size(); ++p)
+	{
+		file << "$var wire 1 " << id(p) << " " << mProbes[p].name << " $end\n";
+	}
+	file << "$upscope $end\n";
+	file << "$enddefinitions $end\n";
+
+	//Only write values that changed since the last generation.
+	std::vector<int> last(mProbes.size(), -1);
+	for (std::size_t i = 0; i < getLength(); ++i)
+	{
+		bool stamped = false;
+		for (std::size_t p = 0; p < mProbes.size(); ++p)
+		{
+			int value = getSample(p, i) == Cell::HEAD;
+			if (value == last[p])
+			{
+				continue;
+			}
+			if (!stamped)
+			{
+				file << "#" << getFirstGeneration() + i << "\n";
+				stamped = true;
+			}
+			file << value << id(p) << "\n";
+			last[p] = value;
+		}
+	}
+	if (getLength())
+	{
+		file << "#" << mLastGeneration + 1 << "\n";
+	}
+
+	return bool(file);
+}
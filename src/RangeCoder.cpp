@@ -0,0 +1,232 @@
+#include "RangeCoder.hpp"
+
+//Odds are out of 2^11, and move 1/32 of the way towards each coded bit.
+static const unsigned int PROB_BITS	   = 11;
+static const std::uint16_t PROB_HALF   = 1 << (PROB_BITS - 1);
+static const unsigned int ADAPT_SHIFT  = 5;
+static const std::uint32_t RANGE_LOWEST = 1 << 24;
+
+//How many bits below the top one are coded with adaptive odds.
+static const unsigned int HIGH_BITS = 3;
+
+RangeCoder::IntModel::IntModel()
+{
+	for (auto& odds : length)
+	{
+		for (auto& prob : odds)
+		{
+			prob = PROB_HALF;
+		}
+	}
+	for (auto& odds : high)
+	{
+		for (auto& prob : odds)
+		{
+			prob = PROB_HALF;
+		}
+	}
+}
+
+RangeCoder::Encoder::Encoder()
+	: mLow(0),
+	  mRange(0xFFFFFFFF),
+	  mCache(0),
+	  mCacheSize(1)
+{
+}
+
+void RangeCoder::Encoder::encodeBit(std::uint16_t& prob, unsigned int bit)
+{
+	std::uint32_t bound = (mRange >> PROB_BITS) * prob;
+	if (bit == 0)
+	{
+		mRange = bound;
+		prob += ((1 << PROB_BITS) - prob) >> ADAPT_SHIFT;
+	}
+	else
+	{
+		mLow += bound;
+		mRange -= bound;
+		prob -= prob >> ADAPT_SHIFT;
+	}
+	while (mRange < RANGE_LOWEST)
+	{
+		mRange <<= 8;
+		shiftLow();
+	}
+}
+
+void RangeCoder::Encoder::encodeDirect(std::uint64_t value, unsigned int bits)
+{
+	while (bits-- > 0)
+	{
+		mRange >>= 1;
+		if ((value >> bits) & 1)
+		{
+			mLow += mRange;
+		}
+		while (mRange < RANGE_LOWEST)
+		{
+			mRange <<= 8;
+			shiftLow();
+		}
+	}
+}
+
+void RangeCoder::Encoder::encode(IntModel& model, std::uint64_t value, std::size_t context)
+{
+	//Values are coded off by one, so 0 has a length too.
+	std::uint64_t v		= value + 1;
+	unsigned int length = 0;
+	while (length < 64 && (v >> length) > 1)
+	{
+		length++;
+	}
+
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		encodeBit(model.length[context][i], 1);
+	}
+	if (length < 64)
+	{
+		encodeBit(model.length[context][length], 0);
+	}
+
+	//The bits right below the top one, as a small tree, then the rest as they are.
+	unsigned int tree = 1;
+	unsigned int bit  = length;
+	for (; bit > 0 && length - bit < HIGH_BITS; --bit)
+	{
+		unsigned int b = (v >> (bit - 1)) & 1;
+		encodeBit(model.high[length][tree], b);
+		tree = (tree << 1) | b;
+	}
+	encodeDirect(v, bit);
+}
+
+const std::string& RangeCoder::Encoder::finish()
+{
+	for (int i = 0; i < 5; ++i)
+	{
+		shiftLow();
+	}
+	return mOut;
+}
+
+void RangeCoder::Encoder::shiftLow()
+{
+	//A byte is held back while a carry could still ripple into it.
+	if ((std::uint32_t)mLow < 0xFF000000u || (mLow >> 32) != 0)
+	{
+		std::uint8_t carry = mLow >> 32;
+		std::uint8_t temp  = mCache;
+		do
+		{
+			mOut.push_back((char)(std::uint8_t)(temp + carry));
+			temp = 0xFF;
+		} while (--mCacheSize != 0);
+		mCache = (mLow >> 24) & 0xFF;
+	}
+	mCacheSize++;
+	mLow = (mLow & 0x00FFFFFF) << 8;
+}
+
+RangeCoder::Decoder::Decoder(const char* data, std::size_t size)
+	: mData((const unsigned char*)data),
+	  mSize(size),
+	  mPos(0),
+	  mRange(0xFFFFFFFF),
+	  mCode(0)
+{
+	for (int i = 0; i < 5; ++i)
+	{
+		mCode = (mCode << 8) | next();
+	}
+}
+
+unsigned int RangeCoder::Decoder::decodeBit(std::uint16_t& prob)
+{
+	std::uint32_t bound = (mRange >> PROB_BITS) * prob;
+	unsigned int bit;
+	if (mCode < bound)
+	{
+		mRange = bound;
+		prob += ((1 << PROB_BITS) - prob) >> ADAPT_SHIFT;
+		bit = 0;
+	}
+	else
+	{
+		mCode -= bound;
+		mRange -= bound;
+		prob -= prob >> ADAPT_SHIFT;
+		bit = 1;
+	}
+	normalize();
+	return bit;
+}
+
+std::uint64_t RangeCoder::Decoder::decodeDirect(unsigned int bits)
+{
+	std::uint64_t value = 0;
+	while (bits-- > 0)
+	{
+		mRange >>= 1;
+		unsigned int bit = mCode >= mRange;
+		if (bit)
+		{
+			mCode -= mRange;
+		}
+		value = (value << 1) | bit;
+		normalize();
+	}
+	return value;
+}
+
+std::uint64_t RangeCoder::Decoder::decode(IntModel& model, std::size_t context)
+{
+	unsigned int length = 0;
+	while (length < 64 && decodeBit(model.length[context][length]))
+	{
+		length++;
+	}
+
+	std::uint64_t v	= 1;
+	unsigned int tree = 1;
+	unsigned int bit  = length;
+	for (; bit > 0 && length - bit < HIGH_BITS; --bit)
+	{
+		unsigned int b = decodeBit(model.high[length][tree]);
+		tree		   = (tree << 1) | b;
+		v			   = (v << 1) | b;
+	}
+	if (bit > 0)
+	{
+		v = (v << bit) | decodeDirect(bit);
+	}
+	return v - 1;
+}
+
+bool RangeCoder::Decoder::isOverrun() const
+{
+	return mPos > mSize;
+}
+
+std::uint8_t RangeCoder::Decoder::next()
+{
+	//Past the end reads zeros, and is reported by isOverrun().
+	if (mPos >= mSize)
+	{
+		mPos++;
+		return 0;
+	}
+	return mData[mPos++];
+}
+
+void RangeCoder::Decoder::normalize()
+{
+	while (mRange < RANGE_LOWEST)
+	{
+		mRange <<= 8;
+		mCode = (mCode << 8) | next();
+	}
+}
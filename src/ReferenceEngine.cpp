@@ -0,0 +1,59 @@
+#include "ReferenceEngine.hpp"
+
+std::string ReferenceEngine::getName() const
+{
+	return "reference";
+}
+
+void ReferenceEngine::step(CellStore& cells, std::vector<Cell>& changed)
+{
+	changed.clear();
+
+	//Index the cells by position, so finding neighbors doesn't need a search.
+	std::unordered_map<WorldPos, std::size_t, Cell::PositionHash> index;
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		index[cells[i].getPosition()] = i;
+	}
+
+	//Copy the cells twice: one to read neighbors from, one to step.
+	std::vector<Cell> cells_old = cells.toVector();
+	std::vector<Cell> cells_cpy = cells_old;
+	//Iterate over all cells.
+	for (std::size_t i = 0; i < cells_cpy.size(); ++i)
+	{
+		Cell& cell = cells_cpy[i];
+		//Get it's position.
+		WorldPos pos = cell.getPosition();
+		//Get all neighbors of the cell.
+		std::vector<Cell*> neighbors;
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				//As long as it's not the active cell...
+				if (!(dx == 0 && dy == 0))
+				{
+					//Get the cell at the position + {dx, dy}.
+					auto found = index.find(pos + WorldPos(dx, dy));
+					//If there is a cell..
+					if (found != index.end())
+					{
+						//Append it.
+						neighbors.push_back(&cells_old[found->second]);
+					}
+				}
+			}
+		}
+
+		//Update the cell in the original cell vector with the new neighbors.
+		Cell::Type old = cell.getType();
+		cell.step(neighbors);
+		//Only write back the cells that changed, so unchanged chunks stay shared.
+		if (cell.getType() != old)
+		{
+			cells.set(i, cell);
+			changed.push_back(cell);
+		}
+	}
+}
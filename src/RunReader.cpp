@@ -0,0 +1,346 @@
+#include "RunReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static std::int64_t unzigzag(std::uint64_t value)
+{
+	return (std::int64_t)(value >> 1) ^ -(std::int64_t)(value & 1);
+}
+
+RunReader::RunReader()
+	: mBytes(0),
+	  mSeekInterval(RunWriter::SEEK_INTERVAL),
+	  mRecords(0),
+	  mGeneration(0),
+	  mIncomplete(false),
+	  mCursor(0),
+	  mCursorOffset(0)
+{
+}
+
+bool RunReader::open(const std::string& path)
+{
+	mFile.close();
+	mFile.clear();
+	mFile.open(path, std::ios::binary);
+	RunWriter::Header header;
+	if (!mFile.read((char*)&header, sizeof(header)) || std::memcmp(header.magic, "WWR1", 4) != 0 ||
+		header.seekInterval == 0)
+	{
+		return false;
+	}
+	mFile.seekg(0, std::ios::end);
+	mBytes		  = mFile.tellg();
+	mSeekInterval = header.seekInterval;
+	mCursorOffset = 0;
+	if (!readLayout(header))
+	{
+		return false;
+	}
+
+	std::uint64_t start = sizeof(header) + header.layoutBytes;
+	mIncomplete			= header.seeks == 0;
+	if (mIncomplete)
+	{
+		scanRecords(start);
+	}
+	else
+	{
+		mRecords = header.records;
+		mSeeks.resize((mRecords + mSeekInterval - 1) / mSeekInterval);
+		mFile.seekg(header.seeks);
+		if (!mFile.read((char*)mSeeks.data(), mSeeks.size() * sizeof(std::uint64_t)))
+		{
+			return false;
+		}
+	}
+
+	//Generation 0's tails & heads.
+	if (mRecords < 2 || !readRecord(0, mTails) || !readRecord(1, mHeads))
+	{
+		return false;
+	}
+	mTypes.assign(mPositions.size(), Cell::WIRE);
+	for (auto cell : mTails)
+	{
+		mTypes[cell] = Cell::TAIL;
+	}
+	for (auto cell : mHeads)
+	{
+		mTypes[cell] = Cell::HEAD;
+	}
+	mGeneration = 0;
+	mChanged.clear();
+	return true;
+}
+
+bool RunReader::seek(unsigned long long generation)
+{
+	generation = std::min(generation, getGenerations());
+	mChanged.clear();
+	if (generation == mGeneration)
+	{
+		return true;
+	}
+
+	//Next to the current generation, one side is already known.
+	std::vector<std::uint32_t> heads, tails;
+	bool read;
+	if (generation == mGeneration + 1)
+	{
+		read  = readRecord(generation + 1, heads);
+		tails = mHeads;
+	}
+	else if (generation + 1 == mGeneration)
+	{
+		heads = mTails;
+		read  = readRecord(generation, tails);
+	}
+	else
+	{
+		read = readRecord(generation + 1, heads) && readRecord(generation, tails);
+	}
+	if (!read)
+	{
+		return false;
+	}
+
+	//The signals that are new or moved, then the old ones that went back to wire.
+	for (auto cell : tails)
+	{
+		if (mTypes[cell] != Cell::TAIL)
+		{
+			mChanged.emplace_back(Cell::TAIL, mPositions[cell]);
+		}
+	}
+	for (auto cell : heads)
+	{
+		if (mTypes[cell] != Cell::HEAD)
+		{
+			mChanged.emplace_back(Cell::HEAD, mPositions[cell]);
+		}
+	}
+	for (auto& old : {&mHeads, &mTails})
+	{
+		for (auto cell : *old)
+		{
+			mTypes[cell] = Cell::WIRE;
+		}
+	}
+	for (auto cell : tails)
+	{
+		mTypes[cell] = Cell::TAIL;
+	}
+	for (auto cell : heads)
+	{
+		mTypes[cell] = Cell::HEAD;
+	}
+	for (auto& old : {&mHeads, &mTails})
+	{
+		for (auto cell : *old)
+		{
+			if (mTypes[cell] == Cell::WIRE)
+			{
+				mChanged.emplace_back(Cell::WIRE, mPositions[cell]);
+			}
+		}
+	}
+
+	mHeads.swap(heads);
+	mTails.swap(tails);
+	mGeneration = generation;
+	return true;
+}
+
+const std::vector<Cell>& RunReader::getChanged() const
+{
+	return mChanged;
+}
+
+std::vector<Cell> RunReader::getCells() const
+{
+	std::vector<Cell> cells;
+	cells.reserve(mPositions.size());
+	for (std::size_t i = 0; i < mPositions.size(); ++i)
+	{
+		cells.emplace_back(mTypes[i], mPositions[i]);
+	}
+	return cells;
+}
+
+unsigned long long RunReader::getGeneration() const
+{
+	return mGeneration;
+}
+
+unsigned long long RunReader::getGenerations() const
+{
+	return mRecords < 2 ? 0 : mRecords - 2;
+}
+
+bool RunReader::isIncomplete() const
+{
+	return mIncomplete;
+}
+
+std::uint64_t RunReader::getBytes() const
+{
+	return mBytes;
+}
+
+bool RunReader::readLayout(const RunWriter::Header& header)
+{
+	if (header.layoutBytes > mBytes)
+	{
+		return false;
+	}
+	std::string data(header.layoutBytes, '\0');
+	mFile.seekg(sizeof(header));
+	if (!mFile.read(&data[0], data.size()))
+	{
+		return false;
+	}
+
+	RangeCoder::Decoder layout(data.data(), data.size());
+	RangeCoder::IntModel counts, rows, columns;
+	std::uint64_t count = layout.decode(counts);
+	if (count != header.cells || count > UINT32_MAX)
+	{
+		return false;
+	}
+	mPositions.resize(count);
+	WorldPos last, rowStart;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		WorldPos pos;
+		if (i == 0)
+		{
+			pos.y	 = unzigzag(layout.decode(rows, 1));
+			pos.x	 = unzigzag(layout.decode(columns, 1));
+			rowStart = pos;
+		}
+		else
+		{
+			std::uint64_t rowsSkipped = layout.decode(rows);
+			if (rowsSkipped == 0)
+			{
+				pos = {(sf::Int64)(last.x + layout.decode(columns, 0) + 1), last.y};
+			}
+			else
+			{
+				pos		 = {rowStart.x + unzigzag(layout.decode(columns, 1)), (sf::Int64)(last.y + rowsSkipped)};
+				rowStart = pos;
+			}
+		}
+		mPositions[i] = pos;
+		last		  = pos;
+	}
+	return !layout.isOverrun();
+}
+
+void RunReader::scanRecords(std::uint64_t start)
+{
+	//A record only counts if both of its lengths made it to the file.
+	mSeeks.clear();
+	mRecords			 = 0;
+	std::uint64_t offset = start;
+	std::uint32_t length, trailer;
+	while (readLength(offset, length) && offset + 2 * sizeof(length) + length <= mBytes &&
+		   readLength(offset + sizeof(length) + length, trailer) && trailer == length)
+	{
+		if (mRecords % mSeekInterval == 0)
+		{
+			mSeeks.push_back(offset);
+		}
+		mRecords++;
+		offset += 2 * sizeof(length) + length;
+	}
+}
+
+bool RunReader::readRecord(std::uint64_t record, std::vector<std::uint32_t>& cells)
+{
+	std::uint64_t offset = locate(record);
+	std::uint32_t length, trailer;
+	if (offset == 0 || !readLength(offset, length) || offset + 2 * sizeof(length) + length > mBytes)
+	{
+		return false;
+	}
+	std::string data(length, '\0');
+	if (!mFile.read(&data[0], length) || !mFile.read((char*)&trailer, sizeof(trailer)) || trailer != length)
+	{
+		return false;
+	}
+	mCursor		  = record;
+	mCursorOffset = offset;
+
+	RangeCoder::Decoder decoder(data.data(), data.size());
+	RangeCoder::IntModel counts, gaps;
+	std::uint64_t count = decoder.decode(counts);
+	if (count > mPositions.size())
+	{
+		return false;
+	}
+	cells.resize(count);
+	std::uint64_t gap = 0, next = 0;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		gap	 = decoder.decode(gaps, RunWriter::getGapContext(gap));
+		next += gap;
+		if (next >= mPositions.size())
+		{
+			return false;
+		}
+		cells[i] = next++;
+	}
+	return !decoder.isOverrun();
+}
+
+std::uint64_t RunReader::locate(std::uint64_t record)
+{
+	if (record >= mRecords)
+	{
+		return 0;
+	}
+
+	//Stepping backwards walks back from the last record read, using the length at the end of each record.
+	std::uint32_t length;
+	if (mCursorOffset != 0 && mCursor > record && mCursor - record <= 2)
+	{
+		std::uint64_t offset = mCursorOffset;
+		for (std::uint64_t current = mCursor; current > record; --current)
+		{
+			if (!readLength(offset - sizeof(length), length))
+			{
+				return 0;
+			}
+			offset -= 2 * sizeof(length) + length;
+		}
+		return offset;
+	}
+
+	//Otherwise forwards, from the last record read or the seek position before, whichever is closer.
+	std::uint64_t current = record / mSeekInterval * mSeekInterval;
+	std::uint64_t offset  = mSeeks[record / mSeekInterval];
+	if (mCursorOffset != 0 && mCursor <= record && mCursor > current)
+	{
+		current = mCursor;
+		offset	= mCursorOffset;
+	}
+	for (; current < record; ++current)
+	{
+		if (!readLength(offset, length))
+		{
+			return 0;
+		}
+		offset += 2 * sizeof(length) + length;
+	}
+	return offset;
+}
+
+bool RunReader::readLength(std::uint64_t offset, std::uint32_t& length)
+{
+	mFile.clear();
+	mFile.seekg(offset);
+	return (bool)mFile.read((char*)&length, sizeof(length));
+}
@@ -0,0 +1,208 @@
+#include "RunWriter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+static std::uint64_t zigzag(std::int64_t value)
+{
+	return ((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63);
+}
+
+RunWriter::RunWriter()
+	: mRecords(0),
+	  mBytes(0),
+	  mFinished(true)
+{
+}
+
+RunWriter::~RunWriter()
+{
+	finish();
+}
+
+bool RunWriter::open(const std::string& path, const std::vector<Cell>& cells)
+{
+	finish();
+	mFile.clear();
+	mFile.open(path, std::ios::binary | std::ios::trunc);
+	if (!mFile)
+	{
+		return false;
+	}
+
+	//Cells are numbered row by row, so neighbors along a row get close numbers.
+	std::vector<WorldPos> positions;
+	positions.reserve(cells.size());
+	for (auto& cell : cells)
+	{
+		positions.push_back(cell.getPosition());
+	}
+	std::sort(positions.begin(), positions.end(), [](const WorldPos& a, const WorldPos& b) {
+		return a.y != b.y ? a.y < b.y : a.x < b.x;
+	});
+	positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+	mNumbers.clear();
+	mNumbers.reserve(positions.size());
+	for (std::size_t i = 0; i < positions.size(); ++i)
+	{
+		mNumbers[positions[i]] = i;
+	}
+
+	//Each cell as the rows skipped since the last one, then the columns skipped along the row,
+	//or its column relative to the start of the row before.
+	RangeCoder::Encoder layout;
+	RangeCoder::IntModel counts, rows, columns;
+	layout.encode(counts, positions.size());
+	WorldPos last, rowStart;
+	for (std::size_t i = 0; i < positions.size(); ++i)
+	{
+		WorldPos pos = positions[i];
+		if (i == 0)
+		{
+			layout.encode(rows, zigzag(pos.y), 1);
+			layout.encode(columns, zigzag(pos.x), 1);
+			rowStart = pos;
+		}
+		else if (pos.y == last.y)
+		{
+			layout.encode(rows, 0);
+			layout.encode(columns, (std::int64_t)pos.x - last.x - 1, 0);
+		}
+		else
+		{
+			layout.encode(rows, (std::int64_t)pos.y - last.y);
+			layout.encode(columns, zigzag((std::int64_t)pos.x - rowStart.x), 1);
+			rowStart = pos;
+		}
+		last = pos;
+	}
+	const std::string& data = layout.finish();
+
+	Header header;
+	std::memcpy(header.magic, "WWR1", 4);
+	header.seekInterval = SEEK_INTERVAL;
+	header.cells		= positions.size();
+	header.records		= 0;
+	header.seeks		= 0;
+	header.layoutBytes	= data.size();
+	mFile.write((const char*)&header, sizeof(header));
+	mFile.write(data.data(), data.size());
+	mBytes	  = sizeof(header) + data.size();
+	mRecords  = 0;
+	mFinished = false;
+	mSeeks.clear();
+
+	//Generation 0 is the tails, then the heads, as if it had been stepped into.
+	std::vector<std::uint32_t> tails;
+	mHeads.clear();
+	for (auto& cell : cells)
+	{
+		if (cell.getType() == Cell::TAIL)
+		{
+			tails.push_back(mNumbers[cell.getPosition()]);
+		}
+		else if (cell.getType() == Cell::HEAD)
+		{
+			mHeads.push_back(mNumbers[cell.getPosition()]);
+		}
+	}
+	std::sort(tails.begin(), tails.end());
+	std::sort(mHeads.begin(), mHeads.end());
+	writeRecord(tails);
+	writeRecord(mHeads);
+	return (bool)mFile;
+}
+
+void RunWriter::write(const std::vector<Cell>& changed)
+{
+	if (mFinished)
+	{
+		return;
+	}
+
+	mHeads.clear();
+	for (auto& cell : changed)
+	{
+		if (cell.getType() == Cell::HEAD)
+		{
+			auto it = mNumbers.find(cell.getPosition());
+			if (it != mNumbers.end())
+			{
+				mHeads.push_back(it->second);
+			}
+		}
+	}
+	std::sort(mHeads.begin(), mHeads.end());
+	writeRecord(mHeads);
+}
+
+bool RunWriter::finish()
+{
+	if (mFinished)
+	{
+		return true;
+	}
+	mFinished = true;
+
+	std::uint64_t seeks = mBytes;
+	mFile.write((const char*)mSeeks.data(), mSeeks.size() * sizeof(std::uint64_t));
+	mBytes += mSeeks.size() * sizeof(std::uint64_t);
+
+	//Only now is the file complete, until then a reader has to find the records itself.
+	mFile.seekp(offsetof(Header, records));
+	mFile.write((const char*)&mRecords, sizeof(mRecords));
+	mFile.write((const char*)&seeks, sizeof(seeks));
+	mFile.close();
+	return !mFile.fail();
+}
+
+unsigned long long RunWriter::getGenerations() const
+{
+	//The first 2 records are generation 0.
+	return mRecords < 2 ? 0 : mRecords - 2;
+}
+
+std::uint64_t RunWriter::getBytes() const
+{
+	return mBytes;
+}
+
+std::size_t RunWriter::getGapContext(std::uint64_t previous)
+{
+	std::size_t length = 0;
+	while (previous > 0 && length + 1 < RangeCoder::CONTEXTS)
+	{
+		previous >>= 2;
+		length++;
+	}
+	return length;
+}
+
+void RunWriter::writeRecord(const std::vector<std::uint32_t>& cells)
+{
+	if (mRecords % SEEK_INTERVAL == 0)
+	{
+		mSeeks.push_back(mBytes);
+	}
+
+	//Every record starts from fresh odds, so it can be decoded on its own.
+	RangeCoder::Encoder encoder;
+	RangeCoder::IntModel counts, gaps;
+	encoder.encode(counts, cells.size());
+	std::uint64_t gap = 0;
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		std::size_t context = getGapContext(gap);
+		gap					= i == 0 ? cells[i] : cells[i] - cells[i - 1] - 1;
+		encoder.encode(gaps, gap, context);
+	}
+	const std::string& data = encoder.finish();
+
+	std::uint32_t length = data.size();
+	mFile.write((const char*)&length, sizeof(length));
+	mFile.write(data.data(), data.size());
+	mFile.write((const char*)&length, sizeof(length));
+	mBytes += data.size() + 2 * sizeof(length);
+	mRecords++;
+}
@@ -0,0 +1,321 @@
+#include "Simulation.hpp"
+
+Simulation::Simulation(const std::string& engine)
+	: mLayout(CellLayout::HILBERT),
+	  mDisordered(0),
+	  mGeneration(0)
+{
+	//Pick the engine, falling back to the default one.
+	setEngine(engine);
+}
+
+bool Simulation::setEngine(const std::string& name)
+{
+	std::unique_ptr<SimulationEngine> engine = SimulationEngine::create(name);
+	if (!engine)
+	{
+		if (!mEngine)
+		{
+			mEngine = SimulationEngine::create(DEFAULT_ENGINE);
+		}
+		return false;
+	}
+
+	mEngine = std::move(engine);
+	mEngine->setCache(mCache);
+	return true;
+}
+
+std::string Simulation::getEngine()
+{
+	return mEngine->getName();
+}
+
+const std::vector<Cell>& Simulation::step()
+{
+	Tracer::Span span("Simulation::step");
+
+	reorderIfDue();
+
+	{
+		Tracer::Span engineSpan("SimulationEngine::step");
+		mEngine->step(mCells, mChanged);
+	}
+	mGeneration++;
+
+	//Sample the probes, looking up only the probed cells.
+	if (!mProbes.getProbes().empty())
+	{
+		mProbes.record(mGeneration, [this](WorldPos pos) { return getCell(pos).getType(); });
+	}
+
+	//Only the changed cells are counted.
+	if (mHeat)
+	{
+		mHeat->record(mChanged);
+	}
+
+	return mChanged;
+}
+
+const std::vector<Cell>& Simulation::advance(std::size_t generations)
+{
+	//Probes & the heat map sample every generation.
+	if (generations <= 1 || !mProbes.getProbes().empty() || mHeat)
+	{
+		std::vector<Cell> changed;
+		for (std::size_t gen = 0; gen < generations; ++gen)
+		{
+			step();
+			changed.insert(changed.end(), mChanged.begin(), mChanged.end());
+		}
+		mChanged.swap(changed);
+		return mChanged;
+	}
+
+	Tracer::Span span("Simulation::advance");
+
+	reorderIfDue();
+
+	{
+		Tracer::Span engineSpan("SimulationEngine::advance");
+		mEngine->advance(mCells, generations, mChanged);
+	}
+	mGeneration += generations;
+	return mChanged;
+}
+
+void Simulation::setCell(Cell c)
+{
+	put(c);
+	mEngine->invalidate();
+}
+
+void Simulation::setCells(const std::vector<Cell>& cells)
+{
+	for (auto& cell : cells)
+	{
+		put(cell);
+	}
+	mEngine->invalidate();
+}
+
+void Simulation::clearCell(WorldPos pos)
+{
+	auto found = mIndex.find(pos);
+	if (found == mIndex.end())
+	{
+		return;
+	}
+
+	//The last cell gets moved into the hole.
+	std::size_t i = found->second;
+	mIndex[mCells[mCells.size() - 1].getPosition()] = i;
+	mIndex.erase(pos);
+	mCells.erase(i);
+	mDisordered++;
+	mEngine->invalidate();
+}
+
+void Simulation::clear()
+{
+	mCells.clear();
+	mIndex.clear();
+	mDisordered = 0;
+	mEngine->invalidate();
+	if (mHeat)
+	{
+		mHeat->clear();
+	}
+}
+
+bool Simulation::isCell(WorldPos pos)
+{
+	return mIndex.count(pos) != 0;
+}
+
+Cell Simulation::getCell(WorldPos pos)
+{
+	auto found = mIndex.find(pos);
+	return found != mIndex.end() ? mCells[found->second] : Cell(Cell::NONE, WorldPos(0, 0));
+}
+
+std::vector<Cell> Simulation::getCellsIn(WorldRect region)
+{
+	std::vector<Cell> found;
+
+	//Small regions are cheaper to look up position by position than to scan for.
+	if ((long long)region.width * region.height < (long long)mCells.size())
+	{
+		for (sf::Int64 y = region.top; y < region.top + region.height; ++y)
+		{
+			for (sf::Int64 x = region.left; x < region.left + region.width; ++x)
+			{
+				auto i = mIndex.find({x, y});
+				if (i != mIndex.end())
+				{
+					found.push_back(mCells[i->second]);
+				}
+			}
+		}
+		return found;
+	}
+
+	for (std::size_t i = 0; i < mCells.size(); ++i)
+	{
+		if (region.contains(mCells[i].getPosition()))
+		{
+			found.push_back(mCells[i]);
+		}
+	}
+	return found;
+}
+
+const CellStore& Simulation::getCells()
+{
+	return mCells;
+}
+
+std::size_t Simulation::getPrunedCells()
+{
+	return mEngine->getPrunedCells();
+}
+
+std::size_t Simulation::getNativeCells()
+{
+	return mEngine->getNativeCells();
+}
+
+void Simulation::setLayout(CellLayout::Curve curve)
+{
+	mLayout = curve;
+	reorder();
+}
+
+CellLayout::Curve Simulation::getLayout()
+{
+	return mLayout;
+}
+
+void Simulation::reorder()
+{
+	Tracer::Span span("Simulation::reorder");
+
+	mDisordered = 0;
+	if (mLayout == CellLayout::INSERTION)
+	{
+		return;
+	}
+
+	//Read everything once, in store order, and only write back the cells that moved. The engine's
+	//neighbor lists are by index, so it renumbers them when it recompiles.
+	std::vector<Cell> cells		   = mCells.toVector();
+	std::vector<std::size_t> order = CellLayout::getOrder(cells, mLayout);
+	bool moved					   = false;
+	for (std::size_t i = 0; i < order.size(); ++i)
+	{
+		if (order[i] != i)
+		{
+			const Cell& cell = cells[order[i]];
+			mCells.set(i, cell);
+			mIndex[cell.getPosition()] = i;
+			moved					   = true;
+		}
+	}
+	if (moved)
+	{
+		mEngine->invalidate();
+	}
+}
+
+void Simulation::reorderIfDue()
+{
+	//The edits already made the engine recompile, so reordering only costs the sort. Reordering now
+	//would copy the chunks a snapshot shares, or page in & dirty the whole world.
+	if (mDisordered * REORDER_SHARE > mCells.size() && !mCells.getPager() && !mCells.isShared())
+	{
+		reorder();
+	}
+}
+
+bool Simulation::setPaging(const std::string& path, std::size_t maxResidentBytes)
+{
+	if (path.empty())
+	{
+		mCells.setPaging(nullptr, 0);
+		return true;
+	}
+
+	auto pager = ChunkPager::create(path, CellStore::CHUNK_SIZE);
+	if (!pager)
+	{
+		return false;
+	}
+	mCells.setPaging(pager, maxResidentBytes / (CellStore::CHUNK_SIZE * sizeof(Cell)));
+	return true;
+}
+
+bool Simulation::setCache(const std::string& directory, std::uintmax_t maxBytes)
+{
+	mCache = directory.empty() ? nullptr : CompileCache::create(directory, maxBytes);
+	mEngine->setCache(mCache);
+	return directory.empty() || mCache;
+}
+
+const CompileCache* Simulation::getCache()
+{
+	return mCache.get();
+}
+
+unsigned long long Simulation::getGeneration()
+{
+	return mGeneration;
+}
+
+ProbeSet& Simulation::getProbes()
+{
+	return mProbes;
+}
+
+void Simulation::setHeatMap(std::size_t window)
+{
+	mHeat = window ? std::make_unique<HeatMap>(window) : nullptr;
+}
+
+const HeatMap* Simulation::getHeatMap()
+{
+	return mHeat.get();
+}
+
+bool Simulation::load(const std::string& path)
+{
+	std::vector<Cell> cells;
+	if (!WorldFile::load(path, cells))
+	{
+		return false;
+	}
+
+	clear();
+	setCells(cells);
+	return true;
+}
+
+bool Simulation::save(const std::string& path)
+{
+	return WorldFile::save(path, mCells);
+}
+
+void Simulation::put(const Cell& c)
+{
+	auto found = mIndex.find(c.getPosition());
+	if (found != mIndex.end())
+	{
+		mCells.set(found->second, c);
+	}
+	else
+	{
+		mIndex[c.getPosition()] = mCells.size();
+		mCells.push_back(c);
+		mDisordered++;
+	}
+}
@@ -0,0 +1,58 @@
+#include "SimulationEngine.hpp"
+
+#include "CircuitEngine.hpp"
+#include "CompiledEngine.hpp"
+#include "ReferenceEngine.hpp"
+
+void SimulationEngine::invalidate()
+{
+}
+
+void SimulationEngine::advance(CellStore& cells, std::size_t generations, std::vector<Cell>& changed)
+{
+	//Cells stepped one by one are written every generation anyway.
+	changed.clear();
+	std::vector<Cell> stepped;
+	for (std::size_t gen = 0; gen < generations; ++gen)
+	{
+		step(cells, stepped);
+		changed.insert(changed.end(), stepped.begin(), stepped.end());
+	}
+}
+
+std::size_t SimulationEngine::getPrunedCells() const
+{
+	return 0;
+}
+
+std::size_t SimulationEngine::getNativeCells() const
+{
+	return 0;
+}
+
+void SimulationEngine::setCache(std::shared_ptr<CompileCache> cache)
+{
+	mCache = cache;
+}
+
+std::unique_ptr<SimulationEngine> SimulationEngine::create(const std::string& name)
+{
+	if (name == "reference")
+	{
+		return std::make_unique<ReferenceEngine>();
+	}
+	else if (name == "compiled")
+	{
+		return std::make_unique<CompiledEngine>();
+	}
+	else if (name == "circuit")
+	{
+		return std::make_unique<CircuitEngine>();
+	}
+	return nullptr;
+}
+
+std::vector<std::string> SimulationEngine::getNames()
+{
+	return {"reference", "compiled", "circuit"};
+}
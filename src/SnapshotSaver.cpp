@@ -0,0 +1,46 @@
+#include "SnapshotSaver.hpp"
+
+SnapshotSaver::SnapshotSaver(const CellStore& snapshot, const std::string& path)
+	: mSnapshot(snapshot),
+	  mPath(path),
+	  mTotal(snapshot.size()),
+	  mWritten(0),
+	  mDone(false),
+	  mFailed(false)
+{
+	mThread = std::thread([this]() {
+		Tracer::setThreadName("snapshot saver");
+		Tracer::Span span("SnapshotSaver::save");
+
+		mFailed = !WorldFile::save(mPath, mSnapshot, &mWritten);
+
+		//Stop sharing chunks with the live world, so it stops copying them.
+		mSnapshot.clear();
+		mDone = true;
+	});
+}
+
+SnapshotSaver::~SnapshotSaver()
+{
+	mThread.join();
+}
+
+float SnapshotSaver::getProgress()
+{
+	return mTotal ? (float)mWritten / mTotal : 1.f;
+}
+
+bool SnapshotSaver::isDone()
+{
+	return mDone;
+}
+
+bool SnapshotSaver::hasFailed()
+{
+	return mFailed;
+}
+
+std::string SnapshotSaver::getPath()
+{
+	return mPath;
+}
@@ -0,0 +1,162 @@
+#include "StreamServer.hpp"
+
+StreamServer::StreamServer(unsigned short port, unsigned int keyframeInterval)
+	: mKeyframeInterval(std::max(keyframeInterval, 1u)),
+	  mGeneration(0)
+{
+	if (mListener.listen(port) != sf::Socket::Done)
+	{
+		std::cerr << "StreamServer: could not listen on port " << port << "\n";
+	}
+	mSelector.add(mListener);
+}
+
+void StreamServer::poll(Simulation& world, sf::Time timeout)
+{
+	//Whatever didn't fit in the sockets last time goes out first.
+	for (auto i = mViewers.begin(); i != mViewers.end();)
+	{
+		i = flush(**i) ? std::next(i) : remove(i);
+	}
+
+	if (!mSelector.wait(timeout))
+	{
+		return;
+	}
+
+	//New viewers.
+	if (mSelector.isReady(mListener))
+	{
+		auto viewer = std::make_unique<Viewer>();
+		if (mListener.accept(viewer->socket) == sf::Socket::Done)
+		{
+			viewer->socket.setBlocking(false);
+			mSelector.add(viewer->socket);
+			mViewers.push_back(std::move(viewer));
+		}
+	}
+
+	//Subscription changes & disconnects.
+	for (auto i = mViewers.begin(); i != mViewers.end();)
+	{
+		Viewer& viewer = **i;
+		if (!mSelector.isReady(viewer.socket))
+		{
+			++i;
+			continue;
+		}
+
+		//Read every packet that's arrived. A packet only partly there is kept by the socket until the rest comes.
+		DeltaPacket packet;
+		sf::Socket::Status status;
+		while ((status = viewer.socket.receive(packet)) == sf::Socket::Done)
+		{
+			sf::Uint8 type;
+			sf::Int64 left, top, width, height;
+			if (packet >> type >> left >> top >> width >> height && type == DeltaPacket::SUBSCRIBE)
+			{
+				//Resync the viewer right away with the new region.
+				viewer.subscribed = true;
+				viewer.region	  = WorldRect(left, top, width, height);
+				queueKeyframe(viewer, world);
+			}
+		}
+		bool connected = status == sf::Socket::NotReady || status == sf::Socket::Partial;
+		i			   = connected && flush(viewer) ? std::next(i) : remove(i);
+	}
+}
+
+void StreamServer::publish(Simulation& world, const std::vector<Cell>& changed, sf::Uint64 generation)
+{
+	mGeneration = generation;
+
+	for (auto i = mViewers.begin(); i != mViewers.end();)
+	{
+		Viewer& viewer = **i;
+		if (viewer.subscribed)
+		{
+			if (++viewer.sinceKeyframe >= mKeyframeInterval)
+			{
+				queueKeyframe(viewer, world);
+			}
+			else
+			{
+				queueDelta(viewer, world, changed);
+			}
+		}
+		i = flush(viewer) ? std::next(i) : remove(i);
+	}
+}
+
+std::size_t StreamServer::getViewerCount()
+{
+	return mViewers.size();
+}
+
+void StreamServer::queueKeyframe(Viewer& viewer, Simulation& world)
+{
+	viewer.sinceKeyframe = 0;
+
+	//The keyframe supersedes everything still waiting, except a packet already partly on the wire.
+	viewer.queue.resize(viewer.sending ? 1 : 0);
+
+	viewer.queue.emplace_back();
+	DeltaPacket& packet = viewer.queue.back();
+	packet << (sf::Uint8)DeltaPacket::KEYFRAME << mGeneration
+		   << (sf::Int64)viewer.region.left << (sf::Int64)viewer.region.top
+		   << (sf::Int64)viewer.region.width << (sf::Int64)viewer.region.height;
+	packet.writeCells(world.getCellsIn(viewer.region));
+}
+
+void StreamServer::queueDelta(Viewer& viewer, Simulation& world, const std::vector<Cell>& changed)
+{
+	//A viewer this far behind is quicker to resync than to catch up.
+	if (viewer.queue.size() >= MAX_QUEUED)
+	{
+		queueKeyframe(viewer, world);
+		return;
+	}
+
+	//Only the changes the viewer can actually see.
+	std::vector<Cell> visible;
+	for (auto& cell : changed)
+	{
+		if (viewer.region.contains(cell.getPosition()))
+		{
+			visible.push_back(cell);
+		}
+	}
+
+	viewer.queue.emplace_back();
+	DeltaPacket& packet = viewer.queue.back();
+	packet << (sf::Uint8)DeltaPacket::DELTA << mGeneration;
+	packet.writeCells(visible);
+}
+
+bool StreamServer::flush(Viewer& viewer)
+{
+	while (!viewer.queue.empty())
+	{
+		sf::Socket::Status status = viewer.socket.send(viewer.queue.front());
+		if (status == sf::Socket::Partial || status == sf::Socket::NotReady)
+		{
+			//The socket's buffer is full. SFML remembers how much of the packet went out, for the next try.
+			viewer.sending = viewer.sending || status == sf::Socket::Partial;
+			return true;
+		}
+		if (status != sf::Socket::Done)
+		{
+			return false;
+		}
+		viewer.queue.pop_front();
+		viewer.sending = false;
+	}
+	return true;
+}
+
+std::vector<std::unique_ptr<StreamServer::Viewer>>::iterator StreamServer::remove(
+	std::vector<std::unique_ptr<Viewer>>::iterator viewer)
+{
+	mSelector.remove((*viewer)->socket);
+	return mViewers.erase(viewer);
+}
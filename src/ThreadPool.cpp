@@ -0,0 +1,107 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threads, const std::string& name)
+	: mJob(nullptr),
+	  mCount(0),
+	  mNext(0),
+	  mActive(0),
+	  mBatch(0),
+	  mStopping(false),
+	  mName(name)
+{
+	for (unsigned int i = 0; i < threads; ++i)
+	{
+		mThreads.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mStarted.notify_all();
+
+	for (auto& thread : mThreads)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::run(std::size_t count, const std::function<void(std::size_t)>& job)
+{
+	//Not worth waking anyone for.
+	if (mThreads.empty() || count <= 1)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			job(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJob	= &job;
+		mCount	= count;
+		mNext	= 0;
+		mActive = mThreads.size();
+		mBatch++;
+	}
+	mStarted.notify_all();
+
+	//The caller helps out, rather than just waiting.
+	claim();
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDone.wait(lock, [this]() { return mActive == 0; });
+	mJob = nullptr;
+}
+
+std::size_t ThreadPool::getConcurrency() const
+{
+	return mThreads.size() + 1;
+}
+
+unsigned int ThreadPool::getDefaultThreads()
+{
+	return std::max(std::thread::hardware_concurrency(), 1u) - 1;
+}
+
+void ThreadPool::claim()
+{
+	for (std::size_t i = mNext++; i < mCount; i = mNext++)
+	{
+		(*mJob)(i);
+	}
+}
+
+void ThreadPool::work()
+{
+	Tracer::setThreadName(mName);
+
+	unsigned long long seen = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mStarted.wait(lock, [&]() { return mBatch != seen || mStopping; });
+			if (mStopping)
+			{
+				return;
+			}
+			seen = mBatch;
+		}
+
+		claim();
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mActive--;
+		}
+		mDone.notify_one();
+	}
+}
@@ -0,0 +1,91 @@
+#include "Tracer.hpp"
+
+void Tracer::start(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (auto& thread : mThreads)
+	{
+		std::lock_guard<std::mutex> threadLock(thread->mutex);
+		thread->events.clear();
+	}
+	mPath  = path;
+	mStart = now();
+	mEnabled.store(true, std::memory_order_relaxed);
+}
+
+bool Tracer::stop()
+{
+	mEnabled.store(false, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	std::ofstream file(mPath);
+	if (!file)
+	{
+		return false;
+	}
+
+	//Spans still open now are recorded when they end, and dropped by the next start().
+	file << "{\"traceEvents\":[\n";
+	bool first = true;
+	for (auto& thread : mThreads)
+	{
+		std::lock_guard<std::mutex> threadLock(thread->mutex);
+		if (!thread->name.empty())
+		{
+			file << (first ? "" : ",\n")
+				 << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id
+				 << ",\"args\":{\"name\":\"" << thread->name << "\"}}";
+			first = false;
+		}
+		for (auto& event : thread->events)
+		{
+			file << (first ? "" : ",\n")
+				 << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+				 << ",\"ts\":" << event.start - mStart << ",\"dur\":" << event.end - event.start << "}";
+			first = false;
+		}
+		thread->events.clear();
+	}
+	file << "\n]}\n";
+
+	//Forget threads that have exited.
+	mThreads.erase(std::remove_if(mThreads.begin(), mThreads.end(),
+								  [](const std::shared_ptr<Thread>& thread) { return thread.use_count() == 1; }),
+				   mThreads.end());
+
+	return bool(file);
+}
+
+void Tracer::setThreadName(const std::string& name)
+{
+	Thread& thread = getThread();
+	std::lock_guard<std::mutex> lock(thread.mutex);
+	thread.name = name;
+}
+
+std::string Tracer::getPath()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mPath;
+}
+
+void Tracer::record(const char* name, std::int64_t start, std::int64_t end)
+{
+	Thread& thread = getThread();
+	std::lock_guard<std::mutex> lock(thread.mutex);
+	thread.events.push_back({name, start, end});
+}
+
+Tracer::Thread& Tracer::getThread()
+{
+	//The registry keeps the spans alive after the thread exits, until they're written.
+	thread_local std::shared_ptr<Thread> local;
+	if (!local)
+	{
+		local = std::make_shared<Thread>();
+		std::lock_guard<std::mutex> lock(mMutex);
+		local->id = mNextThread++;
+		mThreads.push_back(local);
+	}
+	return *local;
+}
@@ -0,0 +1,180 @@
+#include "Viewer.hpp"
+
+Viewer::Viewer(sf::IpAddress host, unsigned short port)
+	: mWindow(sf::VideoMode(700, 700),
+			  "Wireworld Viewer",
+			  sf::Style::Titlebar | sf::Style::Close),
+	  mGrid(mWindow.getSize()),
+	  mGeneration(0),
+	  mBytesReceived(0)
+{
+	if (mSocket.connect(host, port) != sf::Socket::Done)
+	{
+		mWindow.close();
+	}
+	//Never stall rendering while waiting on the server.
+	mSocket.setBlocking(false);
+
+	mHUDFont.loadFromFile("resource/font.ttf");
+	mHUD.setFont(mHUDFont);
+	mHUD.setFillColor(sf::Color::Black);
+	mHUD.setCharacterSize(20);
+	mHUD.setPosition(5, 5);
+
+	mGrid.setPriorityColor(Wireworld::CELL_COLORS.at(Cell::HEAD));
+}
+
+int Viewer::run()
+{
+	while (mWindow.isOpen())
+	{
+		sf::Event event;
+		while (mWindow.pollEvent(event))
+		{
+			handleEvent(event);
+		}
+
+		//Panning.
+		if (mMousePan.mouseHeld)
+		{
+			sf::Vector2f mouse = sf::Vector2f(sf::Mouse::getPosition(mWindow)) / mGrid.getCellSize();
+			mGrid.setPosition(mMousePan.initialOrigin, mMousePan.initialOffset - (mouse - mMousePan.initialMouse));
+		}
+
+		subscribe();
+		if (!receive())
+		{
+			mWindow.close();
+			break;
+		}
+		updateHUD();
+
+		mWindow.clear(sf::Color::White);
+		mWindow.draw(mGrid);
+		mWindow.draw(mHUD);
+		mWindow.display();
+	}
+
+	return 0;
+}
+
+void Viewer::handleEvent(const sf::Event& event)
+{
+	switch (event.type)
+	{
+	default:
+		break;
+	case sf::Event::Closed:
+		mWindow.close();
+		break;
+	case sf::Event::MouseButtonPressed:
+		if (event.mouseButton.button == sf::Mouse::Middle)
+		{
+			mMousePan.mouseHeld	= true;
+			mMousePan.initialMouse = sf::Vector2f(sf::Mouse::getPosition(mWindow)) / mGrid.getCellSize();
+			mMousePan.initialOrigin = mGrid.getOrigin();
+			mMousePan.initialOffset = mGrid.getOffset();
+		}
+		break;
+	case sf::Event::MouseButtonReleased:
+		if (event.mouseButton.button == sf::Mouse::Middle)
+		{
+			mMousePan.mouseHeld = false;
+		}
+		break;
+	case sf::Event::MouseWheelScrolled:
+		mGrid.zoom((event.mouseWheelScroll.delta > 0) ? 1 : -1);
+		break;
+	}
+}
+
+bool Viewer::receive()
+{
+	DeltaPacket packet;
+	sf::Socket::Status status;
+	while ((status = mSocket.receive(packet)) == sf::Socket::Done)
+	{
+		mBytesReceived += packet.getDataSize();
+
+		sf::Uint8 type;
+		std::vector<Cell> cells;
+		packet >> type >> mGeneration;
+		if (type == DeltaPacket::KEYFRAME)
+		{
+			//A keyframe replaces everything we had.
+			sf::Int64 left, top, width, height;
+			packet >> left >> top >> width >> height;
+			packet.readCells(cells);
+			mGrid.clear();
+		}
+		else if (type == DeltaPacket::DELTA)
+		{
+			packet.readCells(cells);
+		}
+
+		std::vector<InfiniteGrid::Cell> changed;
+		for (auto& cell : cells)
+		{
+			if (cell.getType() == Cell::NONE)
+			{
+				mGrid.clearCell(cell.getPosition());
+			}
+			else
+			{
+				changed.push_back({.pos = cell.getPosition(),
+								   .col = Wireworld::CELL_COLORS.at(cell.getType())});
+			}
+		}
+		mGrid.setCells(changed);
+
+		packet.clear();
+	}
+
+	return status == sf::Socket::NotReady;
+}
+
+void Viewer::subscribe()
+{
+	WorldRect visible = getVisibleRegion();
+
+	//Still covered by the current subscription?
+	if (mRegion.contains(visible.left, visible.top) &&
+		mRegion.contains(visible.left + visible.width - 1, visible.top + visible.height - 1))
+	{
+		return;
+	}
+
+	//Subscribe with a margin of half a screen, so small pans don't resubscribe.
+	mRegion = WorldRect(visible.left - visible.width / 2,
+						  visible.top - visible.height / 2,
+						  visible.width * 2,
+						  visible.height * 2);
+
+	DeltaPacket packet;
+	packet << (sf::Uint8)DeltaPacket::SUBSCRIBE
+		   << (sf::Int64)mRegion.left << (sf::Int64)mRegion.top
+		   << (sf::Int64)mRegion.width << (sf::Int64)mRegion.height;
+	while (mSocket.send(packet) == sf::Socket::Partial)
+	{
+	}
+}
+
+void Viewer::updateHUD()
+{
+	std::stringstream ss;
+	ss << "Generation - " << mGeneration << "\n";
+	ss << std::fixed << std::setprecision(1) << "Received - " << mBytesReceived / 1024.f << "KB\n";
+
+	mHUD.setString(ss.str());
+}
+
+WorldRect Viewer::getVisibleRegion()
+{
+	//Cells on screen are within [origin, origin + window size / cell size], counting the offset.
+	WorldPos origin = mGrid.getOrigin();
+	float cellSize	= mGrid.getCellSize();
+	return WorldRect(origin.x,
+					 origin.y,
+					 (sf::Int64)(mWindow.getSize().x / cellSize) + 2,
+					 (sf::Int64)(mWindow.getSize().y / cellSize) + 2);
+}
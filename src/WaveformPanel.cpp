@@ -0,0 +1,67 @@
+#include "WaveformPanel.hpp"
+
+WaveformPanel::WaveformPanel(const sf::Font& font)
+	: mFont(font),
+	  mVertices(sf::Quads)
+{
+}
+
+void WaveformPanel::update(const ProbeSet& probes, sf::Vector2u windowSize, const std::unordered_map<Cell::Type, sf::Color>& colors)
+{
+	mVertices.clear();
+	mLabels.clear();
+	if (probes.getProbes().empty())
+	{
+		return;
+	}
+
+	auto quad = [&](float x, float y, float w, float h, sf::Color col) {
+		mVertices.append(sf::Vertex({x, y}, col));
+		mVertices.append(sf::Vertex({x + w, y}, col));
+		mVertices.append(sf::Vertex({x + w, y + h}, col));
+		mVertices.append(sf::Vertex({x, y + h}, col));
+	};
+
+	//The panel sits at the bottom of the window, one row per probe.
+	float height = probes.getProbes().size() * ROW_HEIGHT;
+	float top	 = windowSize.y - height;
+	quad(0, top, windowSize.x, height, sf::Color(255, 255, 255, 230));
+
+	//Only the newest generations that fit are shown, newest on the right.
+	std::size_t fit	   = (windowSize.x - LABEL_WIDTH) / SAMPLE_WIDTH;
+	std::size_t length = probes.getLength();
+	std::size_t first  = length > fit ? length - fit : 0;
+
+	for (std::size_t p = 0; p < probes.getProbes().size(); ++p)
+	{
+		float y = top + p * ROW_HEIGHT;
+		quad(0, y + ROW_HEIGHT - 1, windowSize.x, 1, sf::Color(200, 200, 200));
+
+		sf::Text label(probes.getProbes()[p].name, mFont, 14);
+		label.setFillColor(sf::Color::Black);
+		label.setPosition(4, y + 2);
+		mLabels.push_back(label);
+
+		//Heads are high, tails halfway, wire low, and empty cells aren't drawn.
+		for (std::size_t i = first; i < length; ++i)
+		{
+			Cell::Type type = probes.getSample(p, i);
+			if (type == Cell::NONE)
+			{
+				continue;
+			}
+			float level = type == Cell::HEAD ? 1.f : type == Cell::TAIL ? 0.5f : 0.1f;
+			float h		= level * (ROW_HEIGHT - 6);
+			quad(LABEL_WIDTH + (i - first) * SAMPLE_WIDTH, y + ROW_HEIGHT - 3 - h, SAMPLE_WIDTH, h, colors.at(type));
+		}
+	}
+}
+
+void WaveformPanel::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+	target.draw(mVertices, states);
+	for (auto& label : mLabels)
+	{
+		target.draw(label, states);
+	}
+}
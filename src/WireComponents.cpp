@@ -0,0 +1,167 @@
+#include "WireComponents.hpp"
+
+void WireComponents::analyze(const CellStore& cells)
+{
+	mIndex.clear();
+	mIndex.reserve(cells.size());
+	mParents.resize(cells.size());
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		mIndex[cells[i].getPosition()] = i;
+		mParents[i]					   = i;
+	}
+
+	//Merge every cell with its neighbors. Looking one way is enough, the neighbor looks back.
+	const WorldPos forward[] = {{1, -1}, {1, 0}, {1, 1}, {0, 1}};
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+	std::vector<std::uint32_t> counts(cells.size() + 1, 0);
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		for (auto& offset : forward)
+		{
+			auto found = mIndex.find(cells[i].getPosition() + offset);
+			if (found != mIndex.end())
+			{
+				pairs.push_back({i, found->second});
+				counts[i + 1]++;
+				counts[found->second + 1]++;
+				std::uint32_t a = find(i), b = find(found->second);
+				if (a != b)
+				{
+					mParents[std::max(a, b)] = std::min(a, b);
+				}
+			}
+		}
+	}
+
+	//Both ways round, every pair is a neighbor of each cell.
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		counts[i + 1] += counts[i];
+	}
+	mOffsets = counts;
+	mNeighbors.resize(mOffsets.back());
+	for (auto& pair : pairs)
+	{
+		mNeighbors[counts[pair.first]++]  = pair.second;
+		mNeighbors[counts[pair.second]++] = pair.first;
+	}
+
+	//Flatten the trees, so what's saved needs no more merging.
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		find(i);
+	}
+	mark(cells);
+}
+
+void WireComponents::save(CompileCache::Writer& out) const
+{
+	out.write(mParents);
+	out.write(mOffsets);
+	out.write(mNeighbors);
+}
+
+bool WireComponents::load(CompileCache::Reader& in, const CellStore& cells)
+{
+	mIndex.clear();
+	if (!in.read(mParents) || !in.read(mOffsets) || !in.read(mNeighbors) || mParents.size() != cells.size() ||
+		mOffsets.size() != cells.size() + 1 || mOffsets.back() != mNeighbors.size())
+	{
+		return false;
+	}
+
+	//Every root is the smallest index in its component, and every neighbor is a cell.
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		if (mParents[i] > i || mParents[mParents[i]] != mParents[i])
+		{
+			return false;
+		}
+	}
+	for (auto& n : mNeighbors)
+	{
+		if (n >= cells.size())
+		{
+			return false;
+		}
+	}
+	mark(cells);
+	return true;
+}
+
+bool WireComponents::isLive(std::size_t i) const
+{
+	return mLive[i];
+}
+
+const WireComponents::Index& WireComponents::getIndex() const
+{
+	return mIndex;
+}
+
+const std::vector<std::uint32_t>& WireComponents::getOffsets() const
+{
+	return mOffsets;
+}
+
+const std::vector<std::uint32_t>& WireComponents::getNeighbors() const
+{
+	return mNeighbors;
+}
+
+std::size_t WireComponents::getComponents() const
+{
+	return mComponents;
+}
+
+std::size_t WireComponents::getDeadCells() const
+{
+	return mDeadCells;
+}
+
+std::size_t WireComponents::getDeadComponents() const
+{
+	return mDeadComponents;
+}
+
+std::uint32_t WireComponents::find(std::uint32_t i)
+{
+	while (mParents[i] != i)
+	{
+		mParents[i] = mParents[mParents[i]];
+		i			= mParents[i];
+	}
+	return i;
+}
+
+void WireComponents::mark(const CellStore& cells)
+{
+	//A component is live if any of its cells carries a signal.
+	std::vector<bool> liveRoots(cells.size(), false);
+	mComponents = 0;
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		if (find(i) == i)
+		{
+			mComponents++;
+		}
+		if (cells[i].getType() == Cell::HEAD || cells[i].getType() == Cell::TAIL)
+		{
+			liveRoots[find(i)] = true;
+		}
+	}
+
+	mLive.resize(cells.size());
+	mDeadCells		= 0;
+	mDeadComponents = 0;
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		mLive[i] = liveRoots[find(i)];
+		if (!mLive[i])
+		{
+			mDeadCells++;
+			mDeadComponents += find(i) == i;
+		}
+	}
+}
@@ -1,10 +1,20 @@
 #include "Wireworld.hpp"
 
-Wireworld::Wireworld(sf::RenderWindow* window)
+const std::unordered_map<Cell::Type, sf::Color> Wireworld::CELL_COLORS = {
+	{Cell::NONE, sf::Color::White},
+	{Cell::HEAD, sf::Color::Blue},
+	{Cell::TAIL, sf::Color::Red},
+	{Cell::WIRE, sf::Color::Yellow}};
+
+Wireworld::Wireworld(sf::RenderWindow* window, const std::string& engine)
 	: mWindow(window),
 	  mGrid(mWindow->getSize()),
+	  mSimulation(engine),
 	  mSpeed(sf::seconds(1)),
-	  mRunning(false)
+	  mRunning(false),
+	  mSaveCopiedChunks(0),
+	  mWaveforms(mHUDFont),
+	  mRedraw(true)
 {
 	//Init the HUD.
 	mHUDFont.loadFromFile("resource/font.ttf");
@@ -14,16 +24,29 @@ Wireworld::Wireworld(sf::RenderWindow* window)
 	mHUD.setCharacterSize(20);
 	mHUD.setPosition(5, 5);
 	updateHUD();
+
+	//Keep signals visible when zoomed far out.
+	mGrid.setPriorityColor(CELL_COLORS.at(Cell::HEAD));
+
+	//Panes are pointed to while panning, so they must not move.
+	mPanes.reserve(MAX_PANES);
 }
 
 void Wireworld::updateWindowSize(sf::Vector2u new_size)
 {
 	mGrid.updateWindowSize(new_size);
+	for (std::size_t i = 0; i < mPanes.size(); ++i)
+	{
+		mPanes[i].updateWindowSize(sf::Vector2u(getPaneRect(i).width, getPaneRect(i).height));
+	}
+	updateWaveforms();
+	mRedraw = true;
 }
 
 void Wireworld::toggleRunning()
 {
-	mRunning = !mRunning;
+	//The world isn't complete until it's loaded.
+	mRunning = !mRunning && !isLoading();
 }
 
 bool Wireworld::isRunning()
@@ -50,30 +73,104 @@ sf::Time Wireworld::getSpeed()
 	return mSpeed;
 }
 
-void Wireworld::update()
+bool Wireworld::setEngine(const std::string& name)
+{
+	return mSimulation.setEngine(name);
+}
+
+std::string Wireworld::getEngine()
+{
+	return mSimulation.getEngine();
+}
+
+void Wireworld::update(sf::Time dt)
 {
+	Tracer::Span span("Wireworld::update");
+
+	//Time steps by frame deltas, so replayed input steps identically.
+	mElapsed += dt;
+
 	//Update mouse input handlers.
 	updateMouse();
 
+	//Add the next loaded cells, around the middle of the view.
+	if (mLoader)
+	{
+		std::vector<Cell> loaded;
+		mLoader->take(mGrid.getCenter(), LOAD_BATCH, loaded);
+		addLoaded(loaded);
+		if (mLoader->isDone())
+		{
+			mLoadEdits.clear();
+		}
+	}
+
+	//Get this frame's edits to the journal, and fold it into a snapshot once the world is complete.
+	if (mJournal)
+	{
+		mJournal->flush();
+		if (!isLoading() && mJournal->needsCompaction())
+		{
+			mJournal->compact(mSimulation.getCells());
+		}
+	}
+
 	//Update the HUD.
 	updateHUD();
 
+	//Edits & loaded cells went through mGrid, so the panes catch up.
+	for (auto& pane : mPanes)
+	{
+		pane.refresh();
+	}
+
 	//If we're not running, break.
 	if (!mRunning)
 	{
 		return;
 	}
 
-	//If it's time to step the simulation...
-	if (mClock.getElapsedTime() > mSpeed)
+	//If it's time to step the simulation, catch up on every generation due since the last frame, up to a cap,
+	//and only draw where that ends up. Recordings capture every generation, so they get one per frame.
+	if (mElapsed > mSpeed)
 	{
-		step();
-		mClock.restart();
+		std::size_t due = mSpeed > sf::Time::Zero ? mElapsed.asMicroseconds() / mSpeed.asMicroseconds()
+												  : MAX_FRAME_GENERATIONS;
+		step(mRecorder ? 1 : std::min(std::max<std::size_t>(due, 1), MAX_FRAME_GENERATIONS));
+		mElapsed = sf::Time::Zero;
 	}
 }
 
+void Wireworld::setMousePosition(sf::Vector2i pos)
+{
+	mMouse = pos;
+}
+
+bool Wireworld::needsRedraw()
+{
+	return mRedraw;
+}
+
+void Wireworld::setDrawn()
+{
+	mRedraw = false;
+}
+
+bool Wireworld::isIdle()
+{
+	return !mRunning && !mRecorder && !(mSaver && !mSaver->isDone()) && !isLoading() &&
+		   !(mJournal && !mJournal->isSettled());
+}
+
+sf::Time Wireworld::getTimeToNextStep()
+{
+	return mElapsed > mSpeed ? sf::Time::Zero : mSpeed - mElapsed;
+}
+
 void Wireworld::updateHUD()
 {
+	Tracer::Span span("Wireworld::updateHUD");
+
 	//The HUD's output.
 	std::stringstream ss;
 
@@ -81,29 +178,97 @@ void Wireworld::updateHUD()
 	ss << std::boolalpha << "Paused - " << !isRunning() << "\n";
 	//Update speed.
 	ss << "Interval - " << getSpeed().asSeconds() << "s\n";
-	ss << "Active Cells - " << mCells.size() << "\n";
-	ss << "Hovering: (" << getFlooredMousePos().x << ", " << getFlooredMousePos().y << ")\n";
-	ss << std::fixed << std::setprecision(1) << "Grid: (" << -mGrid.getPosition().x << ", " << -mGrid.getPosition().y << ")\n";
+	ss << "Active Cells - " << mSimulation.getCells().size() << "\n";
+	ss << "Pruned Cells - " << mSimulation.getPrunedCells() << "\n";
+	ss << "Native Cells - " << mSimulation.getNativeCells() << "\n";
+	ss << "Engine - " << getEngine() << "\n";
+	ss << "Hovering: (" << getMouseCell().x << ", " << getMouseCell().y << ")\n";
+	ss << std::fixed << std::setprecision(1) << "Grid: (" << mGrid.getOrigin().x + (long double)mGrid.getOffset().x << ", "
+	   << mGrid.getOrigin().y + (long double)mGrid.getOffset().y << ")\n";
+	if (mRecorder)
+	{
+		ss << "Recording - " << mRecorder->getWritten() << "/" << mRecorder->getCaptured() << " frames\n";
+	}
+	if (mSaver && !mSaver->isDone())
+	{
+		ss << "Saving - " << (int)(mSaver->getProgress() * 100) << "%, "
+		   << mSimulation.getCells().getCopiedChunks() - mSaveCopiedChunks << " chunks copied\n";
+	}
+	else if (mSaver)
+	{
+		ss << (mSaver->hasFailed() ? "Save failed - " : "Saved - ") << mSaver->getPath() << "\n";
+	}
+	if (!mSimulation.getProbes().getProbes().empty())
+	{
+		ss << "Probes - " << mSimulation.getProbes().getProbes().size() << ", " << mSimulation.getProbes().getLength() << " generations\n";
+	}
+	if (const HeatMap* heat = mSimulation.getHeatMap())
+	{
+		ss << "Heat Map - " << heat->getLength() << " generations, " << heat->getChunks().size() << " chunks ("
+		   << heat->getMemory() / 1024 << "KB), " << heat->getHotChunkCount(0.9f) << " hold 90% of the heads\n";
+	}
+	if (mSimulation.getCells().getPager())
+	{
+		ss << "Paging - " << mSimulation.getCells().getResidentChunks() << "/" << mSimulation.getCells().getChunks()
+		   << " chunks in memory\n";
+	}
+	if (mSimulation.getCache())
+	{
+		ss << "Compile Cache - " << mSimulation.getCache()->getHits() << " hits, "
+		   << mSimulation.getCache()->getMisses() << " misses, " << mSimulation.getCache()->getBytes() / 1024 << "KB\n";
+	}
+	if (mJournal)
+	{
+		ss << "Autosave - " << mJournal->getEdits() << " edits in journal " << mJournal->getEpoch()
+		   << (mJournal->isCompacting() ? ", compacting" : "") << "\n";
+	}
+	if (Tracer::isEnabled())
+	{
+		ss << "Tracing - " << Tracer::getPath() << "\n";
+	}
+	if (isLoading())
+	{
+		ss << "Loading - " << (int)(mLoader->getProgress() * 100) << "% parsed, "
+		   << mLoader->getTaken() << " cells shown\n";
+	}
+	else if (mLoader && mLoader->hasFailed())
+	{
+		ss << "Load failed - " << mLoader->getPath() << "\n";
+	}
 
-	mHUD.setString(ss.str());
+	//Only re-layout the text when it actually changed.
+	if (ss.str() != mHUDString)
+	{
+		mHUDString = ss.str();
+		mHUD.setString(mHUDString);
+		mRedraw = true;
+	}
 }
 
 void Wireworld::updateMouse()
 {
+	Tracer::Span span("Wireworld::updateMouse");
+
 	//First, mouse panning.
 	if (mMousePan.mouseHeld)
 	{
-		//Get the current displacement from the clicked pos.
-		sf::Vector2f cpos = getMousePos(false) - mMousePan.initialMouse;
+		//Get the current displacement from the clicked pos, in the panned grid's cells.
+		InfiniteGrid& grid = *mMousePan.grid;
+		sf::Vector2f cpos  = sf::Vector2f(mMouse) / grid.getCellSize() - mMousePan.initialMouse;
 		//Set the grid's position to that.
-		mGrid.setPosition(mMousePan.initialGrid + cpos);
+		if (cpos != mMousePan.moved)
+		{
+			grid.setPosition(mMousePan.initialOrigin, mMousePan.initialOffset - cpos);
+			mMousePan.moved = cpos;
+			mRedraw			= true;
+		}
 	}
 
 	//Next, mouse cell placement.
 	if (mCellPlacement.mouseHeld)
 	{
 		//Current mouse position.
-		sf::Vector2i cpos = sf::Vector2i(getFlooredMousePos());
+		WorldPos cpos = getMouseCell();
 
 		//If it's not already logged...
 		if (std::find(mCellPlacement.log.begin(),
@@ -167,45 +332,40 @@ void Wireworld::updateMouse()
 	}
 }
 
-void Wireworld::step()
+void Wireworld::step(std::size_t generations)
 {
-	//Copy the vector of cells.
-	std::vector<Cell> cells_cpy = mCells;
-	//Iterate over all cells.
-	for (auto& cell : cells_cpy)
+	Tracer::Span span("Wireworld::step");
+
+	//The world isn't complete until it's loaded.
+	if (isLoading())
 	{
-		//Get it's position.
-		sf::Vector2i pos = cell.getPosition();
-		//Get all neighbors of the cell.
-		std::vector<Cell*> neighbors;
-		for (int dx = -1; dx <= 1; ++dx)
-		{
-			for (int dy = -1; dy <= 1; ++dy)
-			{
-				//As long as it's not the active cell...
-				if (!(dx == 0 && dy == 0))
-				{
-					//Get the cell at the position + {dx, dy}.
-					sf::Vector2i cpos = pos + sf::Vector2i(dx, dy);
-					//If there is a cell..
-					if (isCell(cpos))
-					{
-						//Append it.
-						neighbors.push_back(getCellPtr(cpos));
-					}
-				}
-			}
-		}
+		return;
+	}
 
-		//Update the cell in the original cell vector with the new neighbors.
-		cell.step(neighbors);
-		//Update the grid.
-		mGrid.setCell({.pos = cell.getPosition(),
-					   .col = CELL_COLORS.at(cell.getType())});
+	//Step the world, and only redraw the cells that changed.
+	std::vector<InfiniteGrid::Cell> colored;
+	for (auto& cell : mSimulation.advance(generations))
+	{
+		colored.push_back({.pos = cell.getPosition(),
+						   .col = CELL_COLORS.at(cell.getType())});
 	}
+	mGrid.setCells(colored);
+	for (auto& pane : mPanes)
+	{
+		pane.refresh();
+	}
+
+	mRedraw = true;
 
-	//Copy cells_cpy back.
-	mCells = cells_cpy;
+	if (!mSimulation.getProbes().getProbes().empty())
+	{
+		updateWaveforms();
+	}
+
+	if (mRecorder)
+	{
+		mRecorder->capture(*this, mSimulation.getGeneration());
+	}
 }
 
 void Wireworld::onMousePress(sf::Mouse::Button btn)
@@ -216,15 +376,18 @@ void Wireworld::onMousePress(sf::Mouse::Button btn)
 		return;
 	}
 
-	//If it's the middle mouse...
+	//If it's the middle mouse, pan whichever view is under it...
 	if (btn == sf::Mouse::Middle)
 	{
+		mMousePan.grid		   = &getGridAt(mMouse);
 		mMousePan.mouseHeld	= true;
-		mMousePan.initialMouse = getMousePos(false);
-		mMousePan.initialGrid  = mGrid.getPosition();
+		mMousePan.initialMouse = sf::Vector2f(mMouse) / mMousePan.grid->getCellSize();
+		mMousePan.initialOrigin = mMousePan.grid->getOrigin();
+		mMousePan.initialOffset = mMousePan.grid->getOffset();
+		mMousePan.moved		   = {0, 0};
 	}
-	//Otherwise..
-	else
+	//Otherwise, edit cells, but only in the main view.
+	else if (&getGridAt(mMouse) == &mGrid)
 	{
 		//Reset n toggle cell placement.
 		mCellPlacement.mouseHeld = true;
@@ -249,13 +412,17 @@ void Wireworld::onMouseRelease(sf::Mouse::Button btn)
 
 void Wireworld::onMouseScroll(int delta)
 {
-	//Zoom the grid in/out.
-	mGrid.setCellSize(mGrid.getCellSize() + ((delta > 0) ? 1
-														 : -1));
+	//Zoom the view under the mouse in/out.
+	getGridAt(mMouse).zoom((delta > 0) ? 1 : -1);
+	mRedraw = true;
 }
 
-void Wireworld::onKeyPress(sf::Keyboard::Key key)
+void Wireworld::onKeyPress(sf::Keyboard::Key key, bool shift)
 {
+	//Keys toggle what's shown, so always redraw after one.
+	mRedraw = true;
+
+
 	//Space pauses the application.
 	if (key == sf::Keyboard::Space)
 	{
@@ -273,27 +440,114 @@ void Wireworld::onKeyPress(sf::Keyboard::Key key)
 	//R- reset the grid.
 	else if (key == sf::Keyboard::R)
 	{
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift))
+		if (shift)
 		{
 			//Hard reset.
-			mCells.clear();
+			mLoader.reset();
+			mSimulation.clear();
 			mGrid.clear();
+			if (mJournal)
+			{
+				mJournal->reset();
+			}
 		}
 		else   //Soft reset
 		{
-			for (auto& cell : mCells)
+			const CellStore& cells = mSimulation.getCells();
+			for (std::size_t i = 0; i < cells.size(); ++i)
 			{
-				if (cell.getType() != Cell::WIRE)
+				if (cells[i].getType() != Cell::WIRE)
 				{
-					setCell(Cell(Cell::WIRE, cell.getPosition()));
+					setCell(Cell(Cell::WIRE, cells[i].getPosition()));
 				}
 			}
 		}
 	}
-	//S - step forward one iteration.
+	//Shift+S - save the world, S - step forward one iteration.
 	else if (key == sf::Keyboard::S)
 	{
-		step();
+		if (shift)
+		{
+			save(SAVE_PATH);
+		}
+		else
+		{
+			step();
+		}
+	}
+	//E - switch to the next engine.
+	else if (key == sf::Keyboard::E)
+	{
+		std::vector<std::string> names = SimulationEngine::getNames();
+		auto current				   = std::find(names.begin(), names.end(), getEngine());
+		setEngine((current == names.end() || current + 1 == names.end()) ? names.front()
+																			 : *(current + 1));
+	}
+	//M - show/hide the minimap.
+	else if (key == sf::Keyboard::M)
+	{
+		mGrid.setMinimapVisible(!mGrid.isMinimapVisible());
+	}
+	//F - start/stop recording frames.
+	else if (key == sf::Keyboard::F)
+	{
+		if (mRecorder)
+		{
+			//Destroying the recorder writes out the remaining frames.
+			mRecorder.reset();
+		}
+		else
+		{
+			mRecorder = std::make_unique<FrameRecorder>(mWindow->getSize(), "frames");
+		}
+	}
+	//P - add/remove a probe on the hovered cell, Shift+P - export the probes' history.
+	else if (key == sf::Keyboard::P)
+	{
+		if (shift)
+		{
+			mSimulation.getProbes().saveCsv("probes.csv");
+			mSimulation.getProbes().saveVcd("probes.vcd");
+		}
+		else
+		{
+			mSimulation.getProbes().toggle(getMouseCell());
+			updateWaveforms();
+		}
+	}
+	//L - load the last saved world.
+	else if (key == sf::Keyboard::L)
+	{
+		load(SAVE_PATH);
+	}
+	//V - add a pane zoomed in on the hovered cell, Shift+V - remove the last one.
+	else if (key == sf::Keyboard::V)
+	{
+		if (shift)
+		{
+			removePane();
+		}
+		else
+		{
+			addPane();
+		}
+	}
+	//H - show/hide the heat map.
+	else if (key == sf::Keyboard::H)
+	{
+		toggleHeatMap();
+	}
+	//T - start/stop tracing.
+	else if (key == sf::Keyboard::T)
+	{
+		if (!Tracer::isEnabled())
+		{
+			Tracer::start(TRACE_PATH);
+		}
+		else if (!Tracer::stop())
+		{
+			std::cerr << "Couldn't write " << TRACE_PATH << "\n";
+		}
 	}
 }
 
@@ -303,91 +557,156 @@ void Wireworld::onKeyRelease(sf::Keyboard::Key key)
 
 void Wireworld::setCell(Cell c)
 {
-	if (isCell(c.getPosition()))
+	mSimulation.setCell(c);
+	if (mJournal)
 	{
-		*(getCellPtr(c.getPosition())) = c;
+		mJournal->set(c);
 	}
-	else
+	if (isLoading())
 	{
-		mCells.push_back(c);
+		mLoadEdits.insert(c.getPosition());
 	}
 
 	mGrid.setCell({.pos = c.getPosition(), .col = CELL_COLORS.at(c.getType())});
+	mRedraw = true;
 }
 
-bool Wireworld::isCell(sf::Vector2i pos)
+bool Wireworld::isCell(WorldPos pos)
 {
-	//Simple search for pos in mCells.
-	for (auto& cell : mCells)
-	{
-		if (cell.getPosition() == pos)
-		{
-			return true;
-		}
-	}
-	return false;
+	return mSimulation.isCell(pos);
 }
 
-Cell Wireworld::getCell(sf::Vector2i pos)
+Cell Wireworld::getCell(WorldPos pos)
 {
-	if (!isCell(pos))
+	return mSimulation.getCell(pos);
+}
+
+void Wireworld::clearCell(WorldPos pos)
+{
+	if (isLoading())
 	{
-		return Cell(Cell::NONE, sf::Vector2i(0, 0));
+		mLoadEdits.insert(pos);
 	}
-	else
+
+	if (mJournal && (isLoading() || isCell(pos)))
+	{
+		mJournal->clear(pos);
+	}
+
+	if (isCell(pos))
+	{
+		mSimulation.clearCell(pos);
+		mGrid.clearCell(pos);
+		mRedraw = true;
+	}
+}
+
+bool Wireworld::save(const std::string& path)
+{
+	if (mSaver && !mSaver->isDone())
 	{
-		return *(getCellPtr(pos));
+		return false;
 	}
+
+	//Copying the store only shares its chunks, so this doesn't stall the simulation.
+	mSaveCopiedChunks = mSimulation.getCells().getCopiedChunks();
+	mSaver			  = std::make_unique<SnapshotSaver>(mSimulation.getCells(), path);
+	return true;
+}
+
+void Wireworld::updateWaveforms()
+{
+	mWaveforms.update(mSimulation.getProbes(), mWindow->getSize(), CELL_COLORS);
 }
 
-Cell* Wireworld::getCellPtr(sf::Vector2i pos)
+void Wireworld::load(const std::string& path)
 {
-	if (!isCell(pos))
+	//Start from an empty world.
+	mRunning = false;
+	mSimulation.clear();
+	mGrid.clear();
+	mLoadEdits.clear();
+	mLoader = std::make_unique<WorldLoader>(path);
+	mRedraw = true;
+	if (mJournal)
 	{
-		return nullptr;
+		mJournal->reset();
 	}
-	return std::find_if(mCells.begin(), mCells.end(),
-						[pos](Cell& c) {
-							return c.getPosition() == pos;
-						})
-		.base();
 }
 
-void Wireworld::clearCell(sf::Vector2i pos)
+bool Wireworld::setPaging(const std::string& path, std::size_t maxResidentBytes)
+{
+	return mSimulation.setPaging(path, maxResidentBytes);
+}
+
+bool Wireworld::setCache(const std::string& directory, std::uintmax_t maxBytes)
 {
-	for (auto i = mCells.begin(); i != mCells.end(); ++i)
+	return mSimulation.setCache(directory, maxBytes);
+}
+
+bool Wireworld::setAutosave(const std::string& directory)
+{
+	std::unique_ptr<EditJournal> journal = EditJournal::open(directory);
+	if (!journal)
+	{
+		return false;
+	}
+
+	//Put back the last snapshot & the edits since, which are journaled already.
+	mJournal.reset();
+	if (!journal->getSnapshot().empty())
 	{
-		if (i->getPosition() == pos)
+		load(journal->getSnapshot());
+	}
+	for (auto& edit : journal->getRecovered())
+	{
+		if (edit.op == EditJournal::SET)
+		{
+			setCell(Cell(edit.type, edit.pos));
+		}
+		else
 		{
-			mCells.erase(i);
-			mGrid.clearCell(pos);
-			return;
+			clearCell(edit.pos);
 		}
 	}
+	mJournal = std::move(journal);
+	return true;
 }
 
-sf::Vector2f Wireworld::getMousePos(bool translate)
+bool Wireworld::isLoading()
 {
-	sf::Vector2f pos = (sf::Vector2f)sf::Mouse::getPosition(*mWindow);
+	return mLoader && !mLoader->isDone();
+}
 
-	//Move the mouse into cell coords.
-	pos.x /= mGrid.getCellSize();
-	pos.y /= mGrid.getCellSize();
+void Wireworld::addLoaded(const std::vector<Cell>& cells)
+{
+	if (cells.empty())
+	{
+		return;
+	}
 
-	if (translate)
+	std::vector<Cell> kept;
+	std::vector<InfiniteGrid::Cell> colored;
+	kept.reserve(cells.size());
+	colored.reserve(cells.size());
+	for (auto& cell : cells)
 	{
-		//Translate it by the grid's position.
-		pos -= mGrid.getPosition();
+		if (!mLoadEdits.count(cell.getPosition()))
+		{
+			kept.push_back(cell);
+			colored.push_back({.pos = cell.getPosition(), .col = CELL_COLORS.at(cell.getType())});
+		}
 	}
 
-	//Return it.
-	return pos;
+	mSimulation.setCells(kept);
+	mGrid.setCells(colored);
+	mRedraw = true;
 }
 
-sf::Vector2f Wireworld::getFlooredMousePos(bool translate)
+WorldPos Wireworld::getMouseCell()
 {
-	//Return it.
-	return sf::Vector2f(std::floor(getMousePos().x), std::floor(getMousePos().y));
+	//The grid moves the mouse into cell coords, and translates it by its position.
+	return mGrid.getCellAt(sf::Vector2f(mMouse));
 }
 
 bool Wireworld::isMouseValid()
@@ -397,11 +716,110 @@ bool Wireworld::isMouseValid()
 		0, 0, mWindow->getSize().x, mWindow->getSize().y);
 
 	//Return if the window contains the mouse pos.
-	return window_bounds.contains(sf::Mouse::getPosition(*mWindow));
+	return window_bounds.contains(mMouse);
+}
+
+void Wireworld::addPane()
+{
+	if (mPanes.size() >= MAX_PANES)
+	{
+		return;
+	}
+
+	//Zoom in on the hovered cell, drawing from the same cache as the main view.
+	sf::FloatRect rect = getPaneRect(mPanes.size());
+	mPanes.emplace_back(sf::Vector2u(rect.width, rect.height), mGrid.getCache());
+	InfiniteGrid& pane = mPanes.back();
+	pane.setPriorityColor(CELL_COLORS.at(Cell::HEAD));
+	pane.setOverlay(mGrid.getOverlay());
+	pane.setCellSize(std::max(mGrid.getCellSize() * 2, 8.f));
+	pane.centerOn(getMouseCell());
+}
+
+void Wireworld::toggleHeatMap()
+{
+	//The counts start with the overlay, and only go away once no grid draws them.
+	std::shared_ptr<HeatOverlay> overlay;
+	bool show = !mSimulation.getHeatMap();
+	if (show)
+	{
+		mSimulation.setHeatMap(HeatMap::DEFAULT_WINDOW);
+		overlay = std::make_shared<HeatOverlay>(*mSimulation.getHeatMap());
+	}
+	mGrid.setOverlay(overlay);
+	for (auto& pane : mPanes)
+	{
+		pane.setOverlay(overlay);
+	}
+	if (!show)
+	{
+		mSimulation.setHeatMap(0);
+	}
+	mRedraw = true;
+}
+
+void Wireworld::removePane()
+{
+	if (mPanes.empty())
+	{
+		return;
+	}
+
+	if (mMousePan.grid == &mPanes.back())
+	{
+		mMousePan.mouseHeld = false;
+		mMousePan.grid		= nullptr;
+	}
+	mPanes.pop_back();
+}
+
+sf::FloatRect Wireworld::getPaneRect(std::size_t i) const
+{
+	//Stacked down the right third of the window.
+	sf::Vector2f size(mWindow->getSize().x / 3.f, mWindow->getSize().y / (float)MAX_PANES);
+	return sf::FloatRect(mWindow->getSize().x - size.x, size.y * i, size.x, size.y);
+}
+
+InfiniteGrid& Wireworld::getGridAt(sf::Vector2i pos)
+{
+	for (std::size_t i = 0; i < mPanes.size(); ++i)
+	{
+		if (getPaneRect(i).contains(sf::Vector2f(pos)))
+		{
+			return mPanes[i];
+		}
+	}
+	return mGrid;
 }
 
 void Wireworld::draw(sf::RenderTarget& target, sf::RenderStates states) const
 {
+	Tracer::Span span("Wireworld::draw");
+
 	target.draw(mGrid, states);
+
+	//Each pane gets its own view, mapped onto its part of the target.
+	sf::View view = target.getView();
+	for (std::size_t i = 0; i < mPanes.size(); ++i)
+	{
+		sf::FloatRect rect = getPaneRect(i);
+		sf::Vector2f size(target.getSize());
+		sf::View paneView(sf::FloatRect(0, 0, rect.width, rect.height));
+		paneView.setViewport(sf::FloatRect(rect.left / size.x, rect.top / size.y,
+										   rect.width / size.x, rect.height / size.y));
+		target.setView(paneView);
+
+		sf::RectangleShape frame({rect.width, rect.height});
+		frame.setFillColor(sf::Color::White);
+		target.draw(frame, states);
+		target.draw(mPanes[i], states);
+		frame.setFillColor(sf::Color::Transparent);
+		frame.setOutlineColor(sf::Color::Black);
+		frame.setOutlineThickness(-2);
+		target.draw(frame, states);
+	}
+	target.setView(view);
+
+	target.draw(mWaveforms, states);
 	target.draw(mHUD, states);
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "Worker.hpp"
+
+Worker::Worker(sf::IpAddress host, unsigned short port)
+	: mHost(host),
+	  mPort(port),
+	  mHasLeft(false),
+	  mHasRight(false),
+	  mIndex(0)
+{
+}
+
+int Worker::run()
+{
+	if (!setup())
+	{
+		std::cerr << "Worker: setup failed\n";
+		return 1;
+	}
+
+	//Handle coordinator requests until told to quit.
+	while (true)
+	{
+		sf::Packet packet;
+		sf::Uint8 type;
+		if (mCoordinator.receive(packet) != sf::Socket::Done || !(packet >> type))
+		{
+			std::cerr << "Worker " << mIndex << ": lost the coordinator\n";
+			return 1;
+		}
+
+		if (type == Coordinator::GO)
+		{
+			sf::Uint32 gen;
+			packet >> gen;
+			if (!step())
+			{
+				std::cerr << "Worker " << mIndex << ": halo exchange failed\n";
+				return 1;
+			}
+
+			sf::Packet done;
+			done << (sf::Uint8)Coordinator::DONE << gen;
+			mCoordinator.send(done);
+		}
+		else if (type == Coordinator::GATHER)
+		{
+			sf::Packet reply;
+			reply << (sf::Uint8)Coordinator::CELLS << (sf::Uint32)mPartition.getCells().size();
+			for (auto& cell : mPartition.getCells())
+			{
+				reply << (sf::Int64)cell.getPosition().x
+					  << (sf::Int64)cell.getPosition().y
+					  << (sf::Uint8)cell.getType();
+			}
+			mCoordinator.send(reply);
+		}
+		else if (type == Coordinator::QUIT)
+		{
+			return 0;
+		}
+	}
+}
+
+bool Worker::setup()
+{
+	//Listen for the left neighbor before saying hello, so it can never connect too early.
+	if (mListener.listen(sf::Socket::AnyPort) != sf::Socket::Done ||
+		mCoordinator.connect(mHost, mPort) != sf::Socket::Done)
+	{
+		return false;
+	}
+
+	sf::Packet hello;
+	hello << (sf::Uint8)Coordinator::HELLO << (sf::Uint16)mListener.getLocalPort();
+	if (mCoordinator.send(hello) != sf::Socket::Done)
+	{
+		return false;
+	}
+
+	//Read the assignment.
+	sf::Packet assign;
+	sf::Uint8 type;
+	sf::Int64 left, right;
+	if (mCoordinator.receive(assign) != sf::Socket::Done ||
+		!(assign >> type >> mIndex >> left >> right >> mHasLeft >> mHasRight) ||
+		type != Coordinator::ASSIGN)
+	{
+		return false;
+	}
+
+	std::string rightHost;
+	sf::Uint16 rightPort = 0;
+	if (mHasRight)
+	{
+		assign >> rightHost >> rightPort;
+	}
+
+	mPartition = Partition(left, right);
+	sf::Uint32 count;
+	assign >> count;
+	for (sf::Uint32 i = 0; i < count; ++i)
+	{
+		sf::Int64 x, y;
+		sf::Uint8 cellType;
+		assign >> x >> y >> cellType;
+		mPartition.setCell(Cell((Cell::Type)cellType, {x, y}));
+	}
+	if (!assign)
+	{
+		return false;
+	}
+
+	//Connect right first, then accept from the left. The right neighbor's listener
+	//is already open, so this can't deadlock.
+	if (mHasRight && mRight.connect(rightHost, rightPort) != sf::Socket::Done)
+	{
+		return false;
+	}
+	if (mHasLeft && mListener.accept(mLeft) != sf::Socket::Done)
+	{
+		return false;
+	}
+	mListener.close();
+
+	sf::Packet ready;
+	ready << (sf::Uint8)Coordinator::READY;
+	return mCoordinator.send(ready) == sf::Socket::Done;
+}
+
+bool Worker::step()
+{
+	//Alternate which side goes first by index, so that every link has one
+	//worker sending while the other receives, and no pair waits on each other.
+	bool leftFirst = mIndex % 2 == 1;
+	if (!exchange(leftFirst) || !exchange(!leftFirst))
+	{
+		return false;
+	}
+
+	mPartition.step();
+	return true;
+}
+
+bool Worker::exchange(bool leftSide)
+{
+	if (leftSide ? !mHasLeft : !mHasRight)
+	{
+		return true;
+	}
+
+	sf::TcpSocket& socket = leftSide ? mLeft : mRight;
+
+	sf::Packet out;
+	std::vector<sf::Int64> rows = mPartition.getEdgeHeads(leftSide);
+	out << (sf::Uint8)Coordinator::HALO << (sf::Uint32)rows.size();
+	for (auto& y : rows)
+	{
+		out << (sf::Int64)y;
+	}
+
+	//The left worker of a pair sends first.
+	sf::Packet in;
+	if (!leftSide && socket.send(out) != sf::Socket::Done)
+	{
+		return false;
+	}
+	if (socket.receive(in) != sf::Socket::Done)
+	{
+		return false;
+	}
+	if (leftSide && socket.send(out) != sf::Socket::Done)
+	{
+		return false;
+	}
+
+	sf::Uint8 type;
+	sf::Uint32 count;
+	if (!(in >> type >> count) || type != Coordinator::HALO)
+	{
+		return false;
+	}
+	rows.clear();
+	for (sf::Uint32 i = 0; i < count; ++i)
+	{
+		sf::Int64 y;
+		in >> y;
+		rows.push_back(y);
+	}
+
+	mPartition.setHalo(leftSide, rows);
+	return bool(in);
+}
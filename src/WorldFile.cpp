@@ -0,0 +1,120 @@
+#include "WorldFile.hpp"
+
+bool WorldFile::load(const std::string& path, std::vector<Cell>& cells)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (!parseLine(line, cells))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool WorldFile::parseLine(const std::string& line, std::vector<Cell>& cells)
+{
+	//Skip comments & blank lines.
+	if (line.empty() || line[0] == '#')
+	{
+		return true;
+	}
+
+	//Parse the type & position.
+	char type;
+	long long x, y;
+	if (std::sscanf(line.c_str(), " %c %lld %lld", &type, &x, &y) != 3 ||
+		charToType(type) == Cell::NONE)
+	{
+		return false;
+	}
+
+	cells.push_back(Cell(charToType(type), {x, y}));
+	return true;
+}
+
+bool WorldFile::save(const std::string& path, const std::vector<Cell>& cells)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "# Wireworld pattern, " << cells.size() << " cells.\n";
+	for (auto& cell : cells)
+	{
+		file << typeToChar(cell.getType()) << " "
+			 << cell.getPosition().x << " "
+			 << cell.getPosition().y << "\n";
+	}
+
+	return bool(file);
+}
+
+bool WorldFile::save(const std::string& path, const CellStore& cells, std::atomic<std::size_t>* written)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "# Wireworld pattern, " << cells.size() << " cells.\n";
+	for (std::size_t i = 0; i < cells.size(); ++i)
+	{
+		file << typeToChar(cells[i].getType()) << " "
+			 << cells[i].getPosition().x << " "
+			 << cells[i].getPosition().y << "\n";
+
+		//Report progress once per chunk.
+		if (written && (i + 1) % CellStore::CHUNK_SIZE == 0)
+		{
+			*written = i + 1;
+		}
+	}
+	if (written)
+	{
+		*written = cells.size();
+	}
+
+	return bool(file);
+}
+
+char WorldFile::typeToChar(Cell::Type type)
+{
+	switch (type)
+	{
+	case Cell::WIRE:
+		return 'W';
+	case Cell::HEAD:
+		return 'H';
+	case Cell::TAIL:
+		return 'T';
+	default:
+		return '?';
+	}
+}
+
+Cell::Type WorldFile::charToType(char c)
+{
+	switch (c)
+	{
+	case 'W':
+		return Cell::WIRE;
+	case 'H':
+		return Cell::HEAD;
+	case 'T':
+		return Cell::TAIL;
+	default:
+		return Cell::NONE;
+	}
+}
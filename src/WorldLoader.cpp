@@ -0,0 +1,142 @@
+#include "WorldLoader.hpp"
+
+WorldLoader::WorldLoader(const std::string& path)
+	: mPath(path),
+	  mParsedBytes(0),
+	  mTotalBytes(0),
+	  mTaken(0),
+	  mParsed(false),
+	  mFailed(false),
+	  mStop(false)
+{
+	mThread = std::thread(&WorldLoader::parse, this);
+}
+
+WorldLoader::~WorldLoader()
+{
+	mStop = true;
+	mThread.join();
+}
+
+void WorldLoader::parse()
+{
+	Tracer::setThreadName("world loader");
+	Tracer::Span span("WorldLoader::parse");
+
+	std::ifstream file(mPath, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		mFailed = true;
+		mParsed = true;
+		return;
+	}
+	mTotalBytes = file.tellg();
+	file.seekg(0);
+
+	//Parse in batches, so the lock is taken once per batch instead of once per cell.
+	const std::size_t BATCH = 16384;
+	std::vector<Cell> batch;
+	std::string line;
+	std::size_t bytes = 0;
+	while (!mStop)
+	{
+		bool more = (bool)std::getline(file, line);
+		if (more)
+		{
+			bytes += line.size() + 1;
+			if (!WorldFile::parseLine(line, batch))
+			{
+				mFailed = true;
+				break;
+			}
+		}
+
+		if (batch.size() >= BATCH || !more)
+		{
+			Tracer::Span batchSpan("WorldLoader::publish");
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (auto& cell : batch)
+			{
+				mPending[getBlock(cell.getPosition())].push_back(cell);
+			}
+			batch.clear();
+			mParsedBytes = bytes;
+		}
+
+		if (!more)
+		{
+			break;
+		}
+	}
+
+	mParsed = true;
+}
+
+void WorldLoader::take(WorldPos focus, std::size_t max, std::vector<Cell>& cells)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mPending.empty())
+	{
+		return;
+	}
+
+	//Order the pending blocks by distance from the focus' block.
+	WorldPos center = getBlock(focus);
+	std::vector<std::pair<double, WorldPos>> blocks;
+	blocks.reserve(mPending.size());
+	for (auto& block : mPending)
+	{
+		double dx = block.first.x - center.x, dy = block.first.y - center.y;
+		blocks.push_back({dx * dx + dy * dy, block.first});
+	}
+	std::sort(blocks.begin(), blocks.end(), [](auto& a, auto& b) { return a.first < b.first; });
+
+	std::size_t taken = 0;
+	for (auto& block : blocks)
+	{
+		if (taken >= max)
+		{
+			break;
+		}
+		auto found = mPending.find(block.second);
+		cells.insert(cells.end(), found->second.begin(), found->second.end());
+		taken += found->second.size();
+		mPending.erase(found);
+	}
+	mTaken += taken;
+}
+
+float WorldLoader::getProgress()
+{
+	return mTotalBytes ? (float)mParsedBytes / mTotalBytes : (mParsed ? 1.f : 0.f);
+}
+
+std::size_t WorldLoader::getTaken()
+{
+	return mTaken;
+}
+
+bool WorldLoader::isDone()
+{
+	if (!mParsed)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mPending.empty();
+}
+
+bool WorldLoader::hasFailed()
+{
+	return mFailed;
+}
+
+std::string WorldLoader::getPath()
+{
+	return mPath;
+}
+
+WorldPos WorldLoader::getBlock(WorldPos pos)
+{
+	return floorDiv(pos, BLOCK_SIZE);
+}
@@ -1,7 +1,561 @@
 #include "Application.hpp"
+#include "Coordinator.hpp"
+#include "FrameRecorder.hpp"
+#include "Partition.hpp"
+#include "Player.hpp"
+#include "ReferenceEngine.hpp"
+#include "RunWriter.hpp"
+#include "Simulation.hpp"
+#include "StreamServer.hpp"
+#include "Viewer.hpp"
+#include "Worker.hpp"
+#include "WorldFile.hpp"
 
-int main()
+/**
+ * @brief Sort cells by position, so two worlds can be compared cell by cell.
+ * 
+ */
+static void sortCells(std::vector<Cell>& cells)
 {
-	Application app;
+	std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+		return a.getPosition().x != b.getPosition().x
+				   ? a.getPosition().x < b.getPosition().x
+				   : a.getPosition().y < b.getPosition().y;
+	});
+}
+
+/**
+ * @brief Run a distributed simulation of a pattern file.
+ * 
+ * Usage: --coordinator <pattern> <generations> [--workers N] [--port P] [--spawn] [--verify] [--out file]
+ */
+static int runCoordinator(const std::vector<std::string>& args, const std::string& exe)
+{
+	if (args.size() < 3)
+	{
+		std::cerr << "Usage: --coordinator <pattern> <generations> [--workers N] [--port P] [--spawn] [--verify] [--out file]\n";
+		return 1;
+	}
+
+	unsigned int workers	 = 2;
+	unsigned short port		 = 0;
+	bool spawn				 = false;
+	bool verify				 = false;
+	std::string out;
+	for (std::size_t i = 3; i < args.size(); ++i)
+	{
+		if (args[i] == "--workers" && i + 1 < args.size())
+		{
+			workers = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--port" && i + 1 < args.size())
+		{
+			port = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--spawn")
+		{
+			spawn = true;
+		}
+		else if (args[i] == "--verify")
+		{
+			verify = true;
+		}
+		else if (args[i] == "--out" && i + 1 < args.size())
+		{
+			out = args[++i];
+		}
+	}
+
+	std::vector<Cell> cells;
+	if (!WorldFile::load(args[1], cells))
+	{
+		std::cerr << "Could not load " << args[1] << "\n";
+		return 1;
+	}
+	unsigned int generations = std::stoi(args[2]);
+	std::vector<Cell> initial = cells;
+
+	Coordinator coordinator(port, workers);
+	if (spawn && !coordinator.spawnLocalWorkers(exe))
+	{
+		std::cerr << "Could not start local workers\n";
+		return 1;
+	}
+	if (!coordinator.run(cells, generations))
+	{
+		return 1;
+	}
+	std::cout << "Simulated " << cells.size() << " cells for " << generations
+			  << " generations on " << workers << " workers.\n";
+
+	if (verify)
+	{
+		//Run the same world in this process with the reference engine, and compare.
+		CellStore world(initial);
+		std::vector<Cell> changed;
+		ReferenceEngine reference;
+		for (unsigned int i = 0; i < generations; ++i)
+		{
+			reference.step(world, changed);
+		}
+		std::vector<Cell> expected = world.toVector();
+
+		sortCells(expected);
+		sortCells(cells);
+		for (std::size_t i = 0; i < std::max(expected.size(), cells.size()); ++i)
+		{
+			if (i >= expected.size() || i >= cells.size() ||
+				expected[i].getPosition() != cells[i].getPosition() ||
+				expected[i].getType() != cells[i].getType())
+			{
+				std::cerr << "Mismatch with the single-process result at cell " << i << "\n";
+				return 1;
+			}
+		}
+		std::cout << "Matches the single-process result.\n";
+	}
+
+	if (!out.empty() && !WorldFile::save(out, cells))
+	{
+		std::cerr << "Could not save " << out << "\n";
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Simulate a pattern file headless, publishing it to remote viewers.
+ * 
+ * Usage: --serve <pattern> [--port P] [--interval ms] [--keyframe N] [--generations N] [--engine name] [--cache dir MB] [--page file MB]
+ */
+static int runServer(const std::vector<std::string>& args)
+{
+	if (args.size() < 2)
+	{
+		std::cerr << "Usage: --serve <pattern> [--port P] [--interval ms] [--keyframe N] [--generations N] [--engine name] [--cache dir MB] [--page file MB]\n";
+		return 1;
+	}
+
+	unsigned short port			 = 5001;
+	sf::Time interval			 = sf::milliseconds(100);
+	unsigned int keyframe		 = 100;
+	unsigned long long generations = 0;
+	std::string engine			   = Simulation::DEFAULT_ENGINE;
+	std::string cachePath, pagePath;
+	std::size_t cacheMb = 0, residentMb = 0;
+	for (std::size_t i = 2; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "--port")
+		{
+			port = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--interval")
+		{
+			interval = sf::milliseconds(std::stoi(args[++i]));
+		}
+		else if (args[i] == "--keyframe")
+		{
+			keyframe = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--generations")
+		{
+			generations = std::stoull(args[++i]);
+		}
+		else if (args[i] == "--engine")
+		{
+			engine = args[++i];
+		}
+		else if (args[i] == "--cache" && i + 2 < args.size())
+		{
+			cachePath = args[++i];
+			cacheMb	  = std::stoul(args[++i]);
+		}
+		else if (args[i] == "--page" && i + 2 < args.size())
+		{
+			pagePath   = args[++i];
+			residentMb = std::stoul(args[++i]);
+		}
+	}
+
+	std::vector<Cell> cells;
+	if (!WorldFile::load(args[1], cells))
+	{
+		std::cerr << "Could not load " << args[1] << "\n";
+		return 1;
+	}
+	Simulation world;
+	if (!world.setEngine(engine))
+	{
+		std::cerr << "Unknown engine " << engine << "\n";
+		return 1;
+	}
+	if (!cachePath.empty() && !world.setCache(cachePath, cacheMb * 1024 * 1024))
+	{
+		std::cerr << "Couldn't create " << cachePath << "\n";
+		return 1;
+	}
+	if (!pagePath.empty() && !world.setPaging(pagePath, residentMb * 1024 * 1024))
+	{
+		std::cerr << "Couldn't create " << pagePath << "\n";
+		return 1;
+	}
+	world.setCells(cells);
+
+	StreamServer server(port, keyframe);
+	sf::Clock clock;
+	for (sf::Uint64 gen = 1; generations == 0 || gen <= generations;)
+	{
+		//Serve viewers until the next generation is due,
+		//but always check on them, even when stepping is slower than the interval.
+		sf::Time remaining = interval - clock.getElapsedTime();
+		server.poll(world, std::max(remaining, sf::microseconds(1)));
+		if (clock.getElapsedTime() < interval)
+		{
+			continue;
+		}
+
+		//Deltas are built from the cells the step changed, rather than by comparing the world.
+		clock.restart();
+		const std::vector<Cell>& changed = world.step();
+		server.publish(world, changed, gen++);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Render a pattern file's run to a PNG sequence, without opening a window.
+ * 
+ * Usage: --record <pattern> <directory> <generations> [--every N] [--size W H] [--cell px] [--origin X Y] [--threads N] [--queue N] [--trace file] [--cache dir MB]
+ */
+static int runRecorder(const std::vector<std::string>& args)
+{
+	if (args.size() < 4)
+	{
+		std::cerr << "Usage: --record <pattern> <directory> <generations> [--every N] [--size W H] [--cell px] [--origin X Y] [--threads N] [--queue N] [--trace file] [--cache dir MB]\n";
+		return 1;
+	}
+
+	unsigned int every	 = 1;
+	sf::Vector2u size	  = {700, 700};
+	float cellSize		   = 4;
+	long double originX = 0, originY = 0;
+	unsigned int threads   = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	std::size_t queue	  = 16;
+	std::string tracePath, cachePath;
+	std::size_t cacheMb = 0;
+	for (std::size_t i = 4; i < args.size(); ++i)
+	{
+		if (args[i] == "--every" && i + 1 < args.size())
+		{
+			every = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--size" && i + 2 < args.size())
+		{
+			size.x = std::stoi(args[++i]);
+			size.y = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--cell" && i + 1 < args.size())
+		{
+			cellSize = std::stof(args[++i]);
+		}
+		else if (args[i] == "--origin" && i + 2 < args.size())
+		{
+			originX = std::stold(args[++i]);
+			originY = std::stold(args[++i]);
+		}
+		else if (args[i] == "--threads" && i + 1 < args.size())
+		{
+			threads = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--queue" && i + 1 < args.size())
+		{
+			queue = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--trace" && i + 1 < args.size())
+		{
+			tracePath = args[++i];
+		}
+		else if (args[i] == "--cache" && i + 2 < args.size())
+		{
+			cachePath = args[++i];
+			cacheMb	  = std::stoul(args[++i]);
+		}
+	}
+
+	std::vector<Cell> cells;
+	if (!WorldFile::load(args[1], cells))
+	{
+		std::cerr << "Could not load " << args[1] << "\n";
+		return 1;
+	}
+	unsigned long long generations = std::stoull(args[3]);
+
+	//The world is stepped headless, and the grid only follows the changes.
+	Simulation world;
+	if (!cachePath.empty() && !world.setCache(cachePath, cacheMb * 1024 * 1024))
+	{
+		std::cerr << "Couldn't create " << cachePath << "\n";
+		return 1;
+	}
+	world.setCells(cells);
+	std::vector<InfiniteGrid::Cell> colored;
+	for (auto& cell : cells)
+	{
+		colored.push_back({.pos = cell.getPosition(), .col = Wireworld::CELL_COLORS.at(cell.getType())});
+	}
+
+	//A fixed viewport, with `origin` in the top-left corner.
+	InfiniteGrid grid(size);
+	grid.setCellSize(cellSize);
+	grid.setPriorityColor(Wireworld::CELL_COLORS.at(Cell::HEAD));
+	grid.setPosition({(sf::Int64)std::floor(originX), (sf::Int64)std::floor(originY)},
+					 {(float)(originX - std::floor(originX)), (float)(originY - std::floor(originY))});
+	grid.setCells(colored);
+
+	if (!tracePath.empty())
+	{
+		Tracer::setThreadName("main");
+		Tracer::start(tracePath);
+	}
+
+	FrameRecorder recorder(size, args[2], every, threads, queue);
+	recorder.capture(grid, 0);
+	//Only every Nth generation is drawn, so the ones between are advanced in one go.
+	unsigned long long stride = std::max(every, 1u);
+	for (unsigned long long gen = 0; gen < generations;)
+	{
+		Tracer::Span span("generation");
+		unsigned long long batch = std::min(stride - gen % stride, generations - gen);
+		colored.clear();
+		for (auto& cell : world.advance(batch))
+		{
+			colored.push_back({.pos = cell.getPosition(), .col = Wireworld::CELL_COLORS.at(cell.getType())});
+		}
+		grid.setCells(colored);
+		gen += batch;
+
+		recorder.capture(grid, gen);
+	}
+
+	recorder.finish();
+	if (!tracePath.empty() && !Tracer::stop())
+	{
+		std::cerr << "Couldn't write " << tracePath << "\n";
+	}
+	std::cout << "Wrote " << recorder.getWritten() << " frames to " << args[2] << ".\n";
+	return recorder.getWritten() == recorder.getCaptured() ? 0 : 1;
+}
+
+/**
+ * @brief Record a pattern file's run to a file that can be played back, without opening a window.
+ * 
+ * Usage: --record-run <pattern> <file> <generations> [--engine name] [--cache dir MB]
+ */
+static int runRunRecorder(const std::vector<std::string>& args)
+{
+	if (args.size() < 4)
+	{
+		std::cerr << "Usage: --record-run <pattern> <file> <generations> [--engine name] [--cache dir MB]\n";
+		return 1;
+	}
+
+	std::string engine = Simulation::DEFAULT_ENGINE;
+	std::string cachePath;
+	std::size_t cacheMb = 0;
+	for (std::size_t i = 4; i < args.size(); ++i)
+	{
+		if (args[i] == "--engine" && i + 1 < args.size())
+		{
+			engine = args[++i];
+		}
+		else if (args[i] == "--cache" && i + 2 < args.size())
+		{
+			cachePath = args[++i];
+			cacheMb	  = std::stoul(args[++i]);
+		}
+	}
+
+	std::vector<Cell> cells;
+	if (!WorldFile::load(args[1], cells))
+	{
+		std::cerr << "Could not load " << args[1] << "\n";
+		return 1;
+	}
+	unsigned long long generations = std::stoull(args[3]);
+
+	Simulation world;
+	if (!world.setEngine(engine))
+	{
+		std::cerr << "Unknown engine " << engine << "\n";
+		return 1;
+	}
+	if (!cachePath.empty() && !world.setCache(cachePath, cacheMb * 1024 * 1024))
+	{
+		std::cerr << "Couldn't create " << cachePath << "\n";
+		return 1;
+	}
+	world.setCells(cells);
+
+	RunWriter writer;
+	if (!writer.open(args[2], cells))
+	{
+		std::cerr << "Couldn't create " << args[2] << "\n";
+		return 1;
+	}
+	for (unsigned long long gen = 1; gen <= generations; ++gen)
+	{
+		writer.write(world.step());
+	}
+	if (!writer.finish())
+	{
+		std::cerr << "Couldn't write " << args[2] << "\n";
+		return 1;
+	}
+
+	std::cout << "Wrote " << writer.getGenerations() << " generations to " << args[2] << ", "
+			  << writer.getBytes() / 1024 << "KB.\n";
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+
+	//Headless distributed modes.
+	if (!args.empty() && args[0] == "--worker" && args.size() >= 3)
+	{
+		Worker worker(args[1], std::stoi(args[2]));
+		return worker.run();
+	}
+	if (!args.empty() && args[0] == "--coordinator")
+	{
+		return runCoordinator(args, argv[0]);
+	}
+	if (!args.empty() && args[0] == "--serve")
+	{
+		return runServer(args);
+	}
+	if (!args.empty() && args[0] == "--record")
+	{
+		return runRecorder(args);
+	}
+	if (!args.empty() && args[0] == "--record-run")
+	{
+		return runRunRecorder(args);
+	}
+
+	//Remote viewer.
+	if (!args.empty() && args[0] == "--view" && args.size() >= 3)
+	{
+		Viewer viewer(args[1], std::stoi(args[2]));
+		return viewer.run();
+	}
+
+	//Playback of a recorded run.
+	if (!args.empty() && args[0] == "--play" && args.size() >= 2)
+	{
+		Player player;
+		if (!player.open(args[1]))
+		{
+			std::cerr << "Couldn't read " << args[1] << "\n";
+			return 1;
+		}
+		return player.run();
+	}
+
+	//The GUI, optionally with an engine picked, and input recorded or replayed.
+	std::string engine = Wireworld::DEFAULT_ENGINE;
+	std::string recordPath, replayPath, timingsPath, loadPath, pagePath, tracePath, cachePath, autosavePath;
+	unsigned int fps		 = Application::DEFAULT_FRAME_LIMIT;
+	std::size_t residentMb = 0, cacheMb = 0;
+	for (std::size_t i = 0; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "--engine")
+		{
+			engine = args[++i];
+		}
+		else if (args[i] == "--record-input")
+		{
+			recordPath = args[++i];
+		}
+		else if (args[i] == "--replay-input")
+		{
+			replayPath = args[++i];
+		}
+		else if (args[i] == "--timings")
+		{
+			timingsPath = args[++i];
+		}
+		else if (args[i] == "--load")
+		{
+			loadPath = args[++i];
+		}
+		else if (args[i] == "--fps")
+		{
+			fps = std::stoul(args[++i]);
+		}
+		else if (args[i] == "--page" && i + 2 < args.size())
+		{
+			pagePath   = args[++i];
+			residentMb = std::stoul(args[++i]);
+		}
+		else if (args[i] == "--trace")
+		{
+			tracePath = args[++i];
+		}
+		else if (args[i] == "--cache" && i + 2 < args.size())
+		{
+			cachePath = args[++i];
+			cacheMb	  = std::stoul(args[++i]);
+		}
+		else if (args[i] == "--autosave")
+		{
+			autosavePath = args[++i];
+		}
+	}
+	if (!SimulationEngine::create(engine))
+	{
+		std::cerr << "Unknown engine " << engine << "\n";
+		return 1;
+	}
+
+	Application app(engine);
+	app.setFrameLimit(fps);
+	if (!pagePath.empty() && !app.setPaging(pagePath, residentMb * 1024 * 1024))
+	{
+		std::cerr << "Couldn't create " << pagePath << "\n";
+		return 1;
+	}
+	if (!cachePath.empty() && !app.setCache(cachePath, cacheMb * 1024 * 1024))
+	{
+		std::cerr << "Couldn't create " << cachePath << "\n";
+		return 1;
+	}
+	//Recover the autosaved world first, so a world loaded on top of it replaces it.
+	if (!autosavePath.empty() && !app.setAutosave(autosavePath))
+	{
+		std::cerr << "Couldn't open " << autosavePath << "\n";
+		return 1;
+	}
+	if (!loadPath.empty())
+	{
+		app.load(loadPath);
+	}
+	if (!recordPath.empty() && !app.recordInput(recordPath))
+	{
+		std::cerr << "Couldn't create " << recordPath << "\n";
+		return 1;
+	}
+	if (!replayPath.empty() && !app.replayInput(replayPath, timingsPath))
+	{
+		std::cerr << "Couldn't open " << replayPath << "\n";
+		return 1;
+	}
+	if (!tracePath.empty())
+	{
+		Tracer::start(tracePath);
+	}
 	return app.run();
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <SFML/System.hpp>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BatchEngine.hpp"
+#include "Simulation.hpp"
+#include "WorldFile.hpp"
+
+/**
+ * @brief Benchmarks & checks the batch engine against separate runs of the compiled engine.
+ * Every instance gets random heads on the same few input wires, and the results of every
+ * instance must match a separate run with the same inputs.
+ * 
+ * Usage: WireworldBatch <pattern> [--generations G] [--inputs N] [--seed S]
+ */
+
+template <class Engine>
+static int bench(const std::vector<Cell>& cells, unsigned int generations, std::size_t inputs, unsigned int seed)
+{
+	//Pick the input wires, and each instance's random inputs.
+	std::mt19937 rng(seed);
+	std::vector<WorldPos> wires;
+	for (auto& cell : cells)
+	{
+		if (cell.getType() == Cell::WIRE)
+		{
+			wires.push_back(cell.getPosition());
+		}
+	}
+	std::shuffle(wires.begin(), wires.end(), rng);
+	wires.resize(std::min(inputs, wires.size()));
+
+	std::vector<std::vector<bool>> heads(Engine::LANES, std::vector<bool>(wires.size()));
+	for (auto& instance : heads)
+	{
+		for (std::size_t i = 0; i < wires.size(); ++i)
+		{
+			instance[i] = rng() & 1;
+		}
+	}
+
+	//All instances at once.
+	sf::Clock clock;
+	Engine batch(cells);
+	for (std::size_t lane = 0; lane < Engine::LANES; ++lane)
+	{
+		for (std::size_t i = 0; i < wires.size(); ++i)
+		{
+			batch.setCell(lane, wires[i], heads[lane][i] ? Cell::HEAD : Cell::WIRE);
+		}
+	}
+	for (unsigned int gen = 0; gen < generations; ++gen)
+	{
+		batch.step();
+	}
+	sf::Time batchTime = clock.restart();
+
+	//One instance at a time.
+	std::vector<std::vector<Cell>> results;
+	for (std::size_t lane = 0; lane < Engine::LANES; ++lane)
+	{
+		Simulation single;
+		single.setCells(cells);
+		for (std::size_t i = 0; i < wires.size(); ++i)
+		{
+			single.setCell(Cell(heads[lane][i] ? Cell::HEAD : Cell::WIRE, wires[i]));
+		}
+		for (unsigned int gen = 0; gen < generations; ++gen)
+		{
+			single.step();
+		}
+		results.push_back(single.getCells().toVector());
+	}
+	sf::Time singleTime = clock.restart();
+
+	for (std::size_t lane = 0; lane < Engine::LANES; ++lane)
+	{
+		for (auto& cell : results[lane])
+		{
+			if (batch.getCell(lane, cell.getPosition()) != cell.getType())
+			{
+				std::cout << "MISMATCH: instance " << lane << ", cell (" << cell.getPosition().x << ", "
+						  << cell.getPosition().y << ")\n";
+				return 1;
+			}
+		}
+	}
+
+	std::cout << Engine::LANES << " instances, " << generations << " generations: batch "
+			  << batchTime.asMilliseconds() << "ms, separate " << singleTime.asMilliseconds() << "ms ("
+			  << singleTime.asSeconds() / std::max(batchTime.asSeconds(), 1e-6f) << "x), results match.\n";
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+	std::vector<Cell> cells;
+	if (args.empty() || !WorldFile::load(args[0], cells))
+	{
+		std::cerr << "Usage: WireworldBatch <pattern> [--generations G] [--inputs N] [--seed S]\n";
+		return 1;
+	}
+
+	unsigned int generations = 1000;
+	std::size_t inputs		 = 8;
+	unsigned int seed		 = 1;
+	for (std::size_t i = 1; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "--generations")
+		{
+			generations = std::stoul(args[++i]);
+		}
+		else if (args[i] == "--inputs")
+		{
+			inputs = std::stoul(args[++i]);
+		}
+		else if (args[i] == "--seed")
+		{
+			seed = std::stoul(args[++i]);
+		}
+	}
+
+	return bench<BatchEngine64>(cells, generations, inputs, seed) ||
+		   bench<BatchEngine256>(cells, generations, inputs, seed);
+}
@@ -0,0 +1,146 @@
+#include <SFML/System.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Simulation.hpp"
+
+/**
+ * @brief Benchmarks the compiled & circuit engines on a world of clocks driving long wires through diodes,
+ * advancing a batch of generations at a time, and checks both end up the same.
+ * With a batch of 1 every changed cell is written out each generation, as when probing or drawing every one;
+ * bigger batches are what the circuit engine keeps native, as when the GUI catches up on several at once.
+ *
+ * Usage: WireworldCircuit [--clocks N] [--length L] [--generations G] [--batch B]...
+ */
+
+static std::vector<Cell> buildWorld(unsigned int clocks, unsigned int length)
+{
+	std::map<std::pair<sf::Int64, sf::Int64>, Cell::Type> world;
+	for (unsigned int k = 0; k < clocks; ++k)
+	{
+		sf::Int64 ox = (k % 40) * (length + 30), oy = (k / 40) * 12;
+
+		//A loop of 18 cells with one signal in it, so a new one leaves it every 18 generations.
+		for (sf::Int64 x = 1; x <= 8; ++x)
+		{
+			world[{ox + x, oy}]		= Cell::WIRE;
+			world[{ox + x, oy + 5}] = Cell::WIRE;
+		}
+		for (sf::Int64 y = 1; y <= 4; ++y)
+		{
+			world[{ox, oy + y}]		= Cell::WIRE;
+			world[{ox + 9, oy + y}] = Cell::WIRE;
+		}
+		world[{ox + 3, oy}] = Cell::HEAD;
+		world[{ox + 2, oy}] = Cell::TAIL;
+
+		//The wire it drives, with a diode a little way along.
+		for (sf::Int64 x = 10; x < 10 + length; ++x)
+		{
+			world[{ox + x, oy + 2}] = Cell::WIRE;
+		}
+		world.erase({ox + 13, oy + 2});
+		world[{ox + 12, oy + 1}] = Cell::WIRE;
+		world[{ox + 13, oy + 1}] = Cell::WIRE;
+		world[{ox + 12, oy + 3}] = Cell::WIRE;
+		world[{ox + 13, oy + 3}] = Cell::WIRE;
+	}
+
+	std::vector<Cell> cells;
+	for (auto& cell : world)
+	{
+		cells.push_back(Cell(cell.second, WorldPos(cell.first.first, cell.first.second)));
+	}
+	return cells;
+}
+
+static std::vector<Cell> sorted(std::vector<Cell> cells)
+{
+	std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+		WorldPos pa = a.getPosition(), pb = b.getPosition();
+		return pa.y != pb.y ? pa.y < pb.y : pa.x < pb.x;
+	});
+	return cells;
+}
+
+static sf::Time bench(const std::string& engine, const std::vector<Cell>& cells, unsigned int generations,
+					  unsigned int batch, std::vector<Cell>& result)
+{
+	Simulation sim(engine);
+	sim.setCells(cells);
+
+	//The first step reorders the cells & compiles the engine, so it's left out.
+	sim.step();
+	sf::Clock clock;
+	for (unsigned int gen = 0; gen < generations; gen += batch)
+	{
+		sim.advance(std::min(batch, generations - gen));
+	}
+	sf::Time time = clock.getElapsedTime();
+
+	result = sorted(sim.getCells().toVector());
+	return time;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+	unsigned int clocks		 = 1000;
+	unsigned int length		 = 400;
+	unsigned int generations = 640;
+	std::vector<unsigned int> batches;
+	for (std::size_t i = 0; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "--clocks")
+		{
+			clocks = std::max(std::stoul(args[++i]), 1ul);
+		}
+		else if (args[i] == "--length")
+		{
+			length = std::max(std::stoul(args[++i]), 8ul);
+		}
+		else if (args[i] == "--generations")
+		{
+			generations = std::max(std::stoul(args[++i]), 1ul);
+		}
+		else if (args[i] == "--batch")
+		{
+			batches.push_back(std::max(std::stoul(args[++i]), 1ul));
+		}
+	}
+	if (batches.empty())
+	{
+		batches = {1, 8, 64};
+	}
+
+	std::vector<Cell> cells = buildWorld(clocks, length);
+	std::cout << cells.size() << " cells, " << generations << " generations:\n";
+	for (auto batch : batches)
+	{
+		std::vector<Cell> expected, result;
+		sf::Time compiled = bench("compiled", cells, generations, batch, expected);
+		sf::Time circuit  = bench("circuit", cells, generations, batch, result);
+		for (std::size_t i = 0; i < result.size(); ++i)
+		{
+			if (result[i].getType() != expected[i].getType())
+			{
+				std::cout << "MISMATCH: batch " << batch << ", cell (" << result[i].getPosition().x << ", "
+						  << result[i].getPosition().y << ")\n";
+				return 1;
+			}
+		}
+
+		float compiledRate = generations / std::max(compiled.asSeconds(), 1e-6f);
+		float circuitRate  = generations / std::max(circuit.asSeconds(), 1e-6f);
+		std::cout << "batch " << std::left << std::setw(4) << batch << std::fixed << std::setprecision(0)
+				  << "compiled " << std::setw(8) << compiledRate << "gen/s, circuit " << std::setw(8) << circuitRate
+				  << "gen/s, " << std::setprecision(1) << circuitRate / compiledRate << "x\n";
+	}
+	std::cout << "Both engines match.\n";
+	return 0;
+}
@@ -0,0 +1,511 @@
+#include <SFML/System.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Cell.hpp"
+#include "CellStore.hpp"
+#include "ChunkPager.hpp"
+#include "CircuitEngine.hpp"
+#include "SimulationEngine.hpp"
+
+/**
+ * @brief Differential correctness harness for simulation engines.
+ * Runs every engine side by side on random circuits & random edits, a few generations at a time, and reports the
+ * first generation & cell where any engine differs from the reference engine, or leaves a changed cell out of its list.
+ * Then edits a paged cell store while snapshots of it are alive, checking neither side sees the other's changes.
+ * 
+ * Usage: WireworldDiff [--seed S] [--circuits N] [--generations G] [--size S] [--edits E]
+ */
+
+/**
+ * @brief One engine, with its own copy of the world.
+ * 
+ */
+struct Subject
+{
+	std::unique_ptr<SimulationEngine> engine;
+	CellStore cells;
+	std::unordered_map<WorldPos, std::size_t, Cell::PositionHash> index;
+
+	/**
+	 * @brief Edit the world the same way Wireworld::setCell/clearCell would.
+	 * 
+	 */
+	void set(WorldPos pos, Cell::Type type)
+	{
+		auto found = index.find(pos);
+		if (type == Cell::NONE)
+		{
+			if (found != index.end())
+			{
+				//The last cell is swapped into the hole.
+				std::size_t hole = found->second;
+				index.erase(found);
+				if (hole != cells.size() - 1)
+				{
+					index[cells[cells.size() - 1].getPosition()] = hole;
+				}
+				cells.erase(hole);
+			}
+		}
+		else if (found != index.end())
+		{
+			cells.set(found->second, Cell(type, pos));
+		}
+		else
+		{
+			index[pos] = cells.size();
+			cells.push_back(Cell(type, pos));
+		}
+		engine->invalidate();
+	}
+};
+
+/**
+ * @brief Every gate is placed in each of its 4 rotations, each also mirrored.
+ * 
+ */
+static const std::size_t GATE_ORIENTATIONS = 8;
+
+static const char* typeName(Cell::Type type)
+{
+	switch (type)
+	{
+	case Cell::WIRE:
+		return "WIRE";
+	case Cell::HEAD:
+		return "HEAD";
+	case Cell::TAIL:
+		return "TAIL";
+	default:
+		return "NONE";
+	}
+}
+
+/**
+ * @brief Generate a random circuit: wandering wires, clock loops & stray signals,
+ * and every kind of gate in every orientation, with signals heading into it.
+ * 
+ */
+static std::vector<std::pair<WorldPos, Cell::Type>> randomCircuit(std::mt19937& rng, int size)
+{
+	std::vector<std::pair<WorldPos, Cell::Type>> out;
+	std::uniform_int_distribution<int> coord(0, size - 1);
+	std::uniform_int_distribution<int> dir(-1, 1);
+	std::uniform_int_distribution<int> percent(0, 99);
+
+	//Wandering wires, with the odd signal on them.
+	int wires = size / 4 + 1;
+	for (int w = 0; w < wires; ++w)
+	{
+		WorldPos pos(coord(rng), coord(rng));
+		int length = size * 2;
+		for (int i = 0; i < length; ++i)
+		{
+			int roll		= percent(rng);
+			Cell::Type type = roll < 3 ? Cell::HEAD : roll < 5 ? Cell::TAIL : Cell::WIRE;
+			out.push_back({pos, type});
+			pos += WorldPos(dir(rng), dir(rng));
+		}
+	}
+
+	//Clock loops, each with one signal running around it.
+	int loops = size / 16 + 1;
+	for (int l = 0; l < loops; ++l)
+	{
+		WorldPos corner(coord(rng), coord(rng));
+		int w = 3 + percent(rng) % 8, h = 3 + percent(rng) % 8;
+		std::vector<WorldPos> ring;
+		for (int x = 0; x < w; ++x)
+		{
+			ring.push_back(corner + WorldPos(x, 0));
+		}
+		for (int y = 1; y < h; ++y)
+		{
+			ring.push_back(corner + WorldPos(w - 1, y));
+		}
+		for (int x = w - 2; x >= 0; --x)
+		{
+			ring.push_back(corner + WorldPos(x, h - 1));
+		}
+		for (int y = h - 2; y > 0; --y)
+		{
+			ring.push_back(corner + WorldPos(0, y));
+		}
+		for (std::size_t i = 0; i < ring.size(); ++i)
+		{
+			out.push_back({ring[i], i == 0 ? Cell::HEAD : i == 1 ? Cell::TAIL : Cell::WIRE});
+		}
+	}
+
+	//Every gate at every rotation & mirror image, below the rest so nothing wanders into them.
+	//Drawn here rather than taken from the recognizer, so a wrong shape there shows up as a missing gate.
+	struct Template
+	{
+		std::vector<std::string> drawing;
+
+		/**
+		 * @brief Where the wires attach, and which way they lead away from the gate.
+		 * Inputs carry signals towards the gate.
+		 */
+		std::vector<std::pair<WorldPos, WorldPos>> inputs, outputs;
+	};
+	static const std::vector<Template> templates = {
+		{{".##",
+		  "##.",
+		  ".##"},
+		 {{{-1, 1}, {-1, 0}}},
+		 {{{3, 1}, {1, 0}}}},
+		{{"#...",
+		  ".#..",
+		  "####",
+		  ".#..",
+		  "#..."},
+		 {{{-1, 0}, {-1, 0}}, {{-1, 4}, {-1, 0}}},
+		 {{{4, 2}, {1, 0}}}},
+		{{"##...",
+		  "..#..",
+		  ".####",
+		  ".#..#",
+		  ".####",
+		  "..#..",
+		  "##..."},
+		 {{{-1, 0}, {-1, 0}}, {{-1, 6}, {-1, 0}}},
+		 {{{5, 3}, {1, 0}}}},
+		{{"#...#",
+		  ".#.#.",
+		  "..#..",
+		  ".###."},
+		 {{{-1, 0}, {-1, 0}}, {{2, 4}, {0, 1}}},
+		 {{{5, 0}, {1, 0}}}},
+	};
+	const int wireLength = 16, spacing = 3 * wireLength;
+	for (std::size_t g = 0; g < templates.size(); ++g)
+	{
+		for (std::size_t t = 0; t < GATE_ORIENTATIONS; ++t)
+		{
+			auto transform = [t](WorldPos p) {
+				for (std::size_t r = 0; r < t % 4; ++r)
+				{
+					p = WorldPos(-p.y, p.x);
+				}
+				return t >= 4 ? WorldPos(-p.x, p.y) : p;
+			};
+			WorldPos origin((int)t * spacing, 4 * size + spacing * (int)(g + 1));
+
+			const Template& gate = templates[g];
+			for (int y = 0; y < (int)gate.drawing.size(); ++y)
+			{
+				for (int x = 0; x < (int)gate.drawing[y].size(); ++x)
+				{
+					if (gate.drawing[y][x] == '#')
+					{
+						out.push_back({origin + transform(WorldPos(x, y)), Cell::WIRE});
+					}
+				}
+			}
+
+			//Pulses on the inputs head into the gate: a head with its tail behind it, further out.
+			for (int side = 0; side < 2; ++side)
+			{
+				for (auto& wire : side == 0 ? gate.inputs : gate.outputs)
+				{
+					std::vector<Cell::Type> types(wireLength, Cell::WIRE);
+					for (int i = 0; side == 0 && i + 1 < wireLength; ++i)
+					{
+						if (percent(rng) < 25)
+						{
+							types[i]	 = Cell::HEAD;
+							types[i + 1] = Cell::TAIL;
+							i += 2;
+						}
+					}
+					for (int i = 0; i < wireLength; ++i)
+					{
+						out.push_back({origin + transform(wire.first + wire.second * (sf::Int64)i), types[i]});
+					}
+				}
+			}
+		}
+	}
+
+	return out;
+}
+
+/**
+ * @brief Edit a paged store at random while holding snapshots, the way saves & journal compaction do,
+ * and compare it & the snapshots to flat copies.
+ * 
+ * @return True If everything matched.
+ */
+static bool checkPagedSnapshots(std::mt19937& rng, int edits)
+{
+	std::string path = (std::filesystem::temp_directory_path() / "WireworldDiff.pages").string();
+	auto pager		 = ChunkPager::create(path, CellStore::CHUNK_SIZE);
+	if (!pager)
+	{
+		std::cout << "Couldn't open " << path << " to page to.\n";
+		return false;
+	}
+
+	//Mostly wires, so most chunks can be paged out, with only a few in memory.
+	std::uniform_int_distribution<int> percent(0, 99);
+	auto randomCell = [&](WorldPos pos) {
+		int roll = percent(rng);
+		return Cell(roll < 2 ? Cell::HEAD : roll < 4 ? Cell::TAIL : Cell::WIRE, pos);
+	};
+	CellStore store;
+	std::vector<Cell> flat;
+	for (std::size_t i = 0; i < CellStore::CHUNK_SIZE * 24; ++i)
+	{
+		flat.push_back(Cell(Cell::WIRE, WorldPos(i, 0)));
+		store.push_back(flat.back());
+	}
+	store.setPaging(pager, 4);
+
+	std::vector<std::pair<CellStore, std::vector<Cell>>> snapshots;
+	auto matches = [](const CellStore& cells, const std::vector<Cell>& expected, const char* what) {
+		std::vector<Cell> actual = cells.toVector();
+		bool same				 = actual.size() == expected.size();
+		for (std::size_t i = 0; same && i < actual.size(); ++i)
+		{
+			same = actual[i].getType() == expected[i].getType() && actual[i].getPosition() == expected[i].getPosition();
+		}
+		if (!same)
+		{
+			std::cout << "MISMATCH: paged " << what << " doesn't hold what was written to it.\n";
+		}
+		return same;
+	};
+
+	for (int edit = 0; edit < edits; ++edit)
+	{
+		//Take & drop snapshots along the way, keeping up to two alive.
+		int roll = percent(rng);
+		if (roll < 5)
+		{
+			if (snapshots.size() == 2)
+			{
+				if (!matches(snapshots.front().first, snapshots.front().second, "snapshot"))
+				{
+					return false;
+				}
+				snapshots.erase(snapshots.begin());
+			}
+			snapshots.push_back({store, flat});
+		}
+
+		//Mostly overwrites all over the store, so paged out chunks get written to.
+		std::size_t i = std::uniform_int_distribution<std::size_t>(0, flat.size() - 1)(rng);
+		if (roll < 80)
+		{
+			flat[i] = randomCell(flat[i].getPosition());
+			store.set(i, flat[i]);
+		}
+		else if (roll < 90)
+		{
+			flat.push_back(randomCell(WorldPos(flat.size(), 1)));
+			store.push_back(flat.back());
+		}
+		else
+		{
+			flat[i] = flat.back();
+			flat.pop_back();
+			store.erase(i);
+		}
+
+		//Spot check reads, which page chunks in & out too.
+		std::size_t j = std::uniform_int_distribution<std::size_t>(0, flat.size() - 1)(rng);
+		if (store[j].getType() != flat[j].getType())
+		{
+			std::cout << "MISMATCH: paged store, cell " << j << " after " << edit << " edits.\n";
+			return false;
+		}
+	}
+
+	bool same = matches(store, flat, "store");
+	for (auto& snapshot : snapshots)
+	{
+		same = same && matches(snapshot.first, snapshot.second, "snapshot");
+	}
+	return same;
+}
+
+/**
+ * @brief Check the changed list covers every cell whose type changed, with its new type last.
+ * 
+ */
+static bool checkChanged(const std::vector<Cell>& before, const CellStore& after, const std::vector<Cell>& changed)
+{
+	std::unordered_map<WorldPos, Cell::Type, Cell::PositionHash> listed;
+	for (auto& cell : changed)
+	{
+		listed[cell.getPosition()] = cell.getType();
+	}
+	for (std::size_t i = 0; i < before.size(); ++i)
+	{
+		Cell::Type now = after[i].getType();
+		auto found	   = listed.find(after[i].getPosition());
+		if (now != before[i].getType() && (found == listed.end() || found->second != now))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int seed		 = 1;
+	int circuits			 = 10;
+	int generations			 = 1000;
+	int size				 = 64;
+	int edits				 = 200;
+	std::vector<std::string> args(argv + 1, argv + argc);
+	for (std::size_t i = 0; i + 1 < args.size(); ++i)
+	{
+		if (args[i] == "--seed")
+		{
+			seed = std::stoul(args[++i]);
+		}
+		else if (args[i] == "--circuits")
+		{
+			circuits = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--generations")
+		{
+			generations = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--size")
+		{
+			size = std::stoi(args[++i]);
+		}
+		else if (args[i] == "--edits")
+		{
+			edits = std::stoi(args[++i]);
+		}
+	}
+
+	std::mt19937 rng(seed);
+	std::vector<std::string> names = SimulationEngine::getNames();
+	std::cout << "Checking " << names.size() - 1 << " engine(s) against " << names.front()
+			  << " on " << circuits << " circuits, " << generations << " generations each.\n";
+
+	for (int circuit = 0; circuit < circuits; ++circuit)
+	{
+		//Every engine gets the same world.
+		std::vector<Subject> subjects(names.size());
+		for (std::size_t e = 0; e < names.size(); ++e)
+		{
+			subjects[e].engine = SimulationEngine::create(names[e]);
+		}
+		for (auto& cell : randomCircuit(rng, size))
+		{
+			for (auto& subject : subjects)
+			{
+				subject.set(cell.first, cell.second);
+			}
+		}
+
+		//Spread the edits randomly over the run.
+		std::uniform_int_distribution<int> when(0, generations - 1);
+		std::uniform_int_distribution<int> coord(0, size - 1);
+		std::uniform_int_distribution<int> type(Cell::NONE, Cell::TAIL);
+		std::vector<int> editsAt(generations, 0);
+		for (int i = 0; i < edits; ++i)
+		{
+			editsAt[when(rng)]++;
+		}
+
+		//Generations are advanced a few at a time, up to the next edit.
+		std::uniform_int_distribution<int> batchOf(1, 8);
+		std::vector<Cell> changed;
+		for (int gen = 0; gen < generations;)
+		{
+			for (int i = 0; i < editsAt[gen]; ++i)
+			{
+				WorldPos pos(coord(rng), coord(rng));
+				Cell::Type t = (Cell::Type)type(rng);
+				for (auto& subject : subjects)
+				{
+					subject.set(pos, t);
+				}
+			}
+
+			int batch = std::min(batchOf(rng), generations - gen);
+			for (int k = 1; k < batch; ++k)
+			{
+				if (editsAt[gen + k] > 0)
+				{
+					batch = k;
+				}
+			}
+			gen += batch;
+
+			for (std::size_t e = 0; e < subjects.size(); ++e)
+			{
+				Subject& subject = subjects[e];
+				std::vector<Cell> before = subject.cells.toVector();
+				subject.engine->advance(subject.cells, batch, changed);
+				if (!checkChanged(before, subject.cells, changed))
+				{
+					std::cout << "MISSED CHANGE: engine '" << names[e] << "', circuit " << circuit
+							  << " (seed " << seed << "), generation " << gen << "\n";
+					return 1;
+				}
+			}
+
+			//Compare everyone to the reference, cell by cell.
+			Subject& reference = subjects.front();
+			for (std::size_t e = 1; e < subjects.size(); ++e)
+			{
+				for (auto& cell : subjects[e].cells.toVector())
+				{
+					Cell::Type expected = reference.cells[reference.index.at(cell.getPosition())].getType();
+					if (cell.getType() != expected)
+					{
+						std::cout << "MISMATCH: engine '" << names[e] << "', circuit " << circuit
+								  << " (seed " << seed << "), generation " << gen
+								  << ", cell (" << cell.getPosition().x << ", " << cell.getPosition().y
+								  << "): expected " << typeName(expected)
+								  << ", got " << typeName(cell.getType()) << "\n";
+						return 1;
+					}
+				}
+			}
+		}
+
+		//The gates only get checked if the circuit engine steps them as gates,
+		//so every one placed must be found, on top of any the random wires happen to form.
+		for (std::size_t e = 0; e < subjects.size(); ++e)
+		{
+			auto circuitEngine = dynamic_cast<CircuitEngine*>(subjects[e].engine.get());
+			for (int kind = CircuitRecognizer::DIODE; circuitEngine && kind <= CircuitRecognizer::AND_NOT; ++kind)
+			{
+				std::size_t found = circuitEngine->getRecognizer().getCount((CircuitRecognizer::Kind)kind);
+				if (found < GATE_ORIENTATIONS)
+				{
+					std::cout << "MISSED GATES: engine '" << names[e] << "', circuit " << circuit << " (seed " << seed
+							  << ") steps " << found << " " << CircuitRecognizer::getName((CircuitRecognizer::Kind)kind)
+							  << " gate(s) as gates, of the " << GATE_ORIENTATIONS << " placed\n";
+					return 1;
+				}
+			}
+		}
+	}
+
+	std::cout << "All engines match the reference.\n";
+
+	if (!checkPagedSnapshots(rng, edits * 100))
+	{
+		return 1;
+	}
+	std::cout << "Paged stores & their snapshots match.\n";
+	return 0;
+}
@@ -0,0 +1,152 @@
+#include <SFML/System.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CellLayout.hpp"
+#include "Simulation.hpp"
+#include "WorldFile.hpp"
+
+/**
+ * @brief Benchmarks every engine with the cells kept in each layout, and checks the layouts step the same.
+ * The pattern can be tiled into a bigger world, and its cells shuffled, as if placed by hand in no
+ * particular order, which is where the layouts differ most.
+ *
+ * Usage: WireworldLayout <pattern> [--generations G] [--tile N] [--shuffle] [--seed S]
+ */
+
+static std::vector<Cell> sorted(std::vector<Cell> cells)
+{
+	std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+		WorldPos pa = a.getPosition(), pb = b.getPosition();
+		return pa.y != pb.y ? pa.y < pb.y : pa.x < pb.x;
+	});
+	return cells;
+}
+
+static int bench(const std::string& engine, const std::vector<Cell>& cells, unsigned int generations)
+{
+	std::vector<Cell> expected;
+	for (auto curve : CellLayout::getCurves())
+	{
+		Simulation sim(engine);
+		sim.setLayout(curve);
+		sim.setCells(cells);
+
+		//The first step reorders the cells & compiles the engine, so it's timed apart.
+		sf::Clock clock;
+		sim.step();
+		sf::Time setupTime = clock.restart();
+		for (unsigned int gen = 1; gen < generations; ++gen)
+		{
+			sim.step();
+		}
+		sf::Time stepTime = clock.restart();
+
+		std::vector<Cell> result = sorted(sim.getCells().toVector());
+		if (expected.empty())
+		{
+			expected = result;
+		}
+		else
+		{
+			for (std::size_t i = 0; i < result.size(); ++i)
+			{
+				if (result[i].getType() != expected[i].getType())
+				{
+					std::cout << "MISMATCH: " << engine << ", " << CellLayout::getName(curve) << ", cell ("
+							  << result[i].getPosition().x << ", " << result[i].getPosition().y << ")\n";
+					return 1;
+				}
+			}
+		}
+
+		std::cout << std::left << std::setw(10) << engine << std::setw(10) << CellLayout::getName(curve)
+				  << "first step " << std::setw(6) << setupTime.asMilliseconds() << "ms, then "
+				  << std::fixed << std::setprecision(3)
+				  << stepTime.asSeconds() * 1000 / std::max(generations - 1, 1u) << "ms a generation\n";
+	}
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+	std::vector<Cell> pattern;
+	if (args.empty() || !WorldFile::load(args[0], pattern) || pattern.empty())
+	{
+		std::cerr << "Usage: WireworldLayout <pattern> [--generations G] [--tile N] [--shuffle] [--seed S]\n";
+		return 1;
+	}
+
+	unsigned int generations = 200;
+	unsigned int tile		 = 1;
+	bool shuffle			 = false;
+	unsigned int seed		 = 1;
+	for (std::size_t i = 1; i < args.size(); ++i)
+	{
+		if (args[i] == "--shuffle")
+		{
+			shuffle = true;
+		}
+		else if (i + 1 >= args.size())
+		{
+			break;
+		}
+		else if (args[i] == "--generations")
+		{
+			generations = std::max(std::stoul(args[++i]), 1ul);
+		}
+		else if (args[i] == "--tile")
+		{
+			tile = std::max(std::stoul(args[++i]), 1ul);
+		}
+		else if (args[i] == "--seed")
+		{
+			seed = std::stoul(args[++i]);
+		}
+	}
+
+	//Copies of the pattern side by side, with a gap so they don't touch.
+	WorldPos min = pattern[0].getPosition(), max = min;
+	for (auto& cell : pattern)
+	{
+		min.x = std::min(min.x, cell.getPosition().x);
+		min.y = std::min(min.y, cell.getPosition().y);
+		max.x = std::max(max.x, cell.getPosition().x);
+		max.y = std::max(max.y, cell.getPosition().y);
+	}
+	WorldPos stride(max.x - min.x + 3, max.y - min.y + 3);
+	std::vector<Cell> cells;
+	for (unsigned int ty = 0; ty < tile; ++ty)
+	{
+		for (unsigned int tx = 0; tx < tile; ++tx)
+		{
+			for (auto& cell : pattern)
+			{
+				cells.push_back(Cell(cell.getType(), cell.getPosition() + WorldPos(tx * stride.x, ty * stride.y)));
+			}
+		}
+	}
+	if (shuffle)
+	{
+		std::mt19937 rng(seed);
+		std::shuffle(cells.begin(), cells.end(), rng);
+	}
+
+	std::cout << cells.size() << " cells, " << generations << " generations"
+			  << (shuffle ? ", shuffled" : "") << ":\n";
+	for (auto& engine : SimulationEngine::getNames())
+	{
+		if (bench(engine, cells, generations))
+		{
+			return 1;
+		}
+	}
+	std::cout << "Every layout matches.\n";
+	return 0;
+}